@@ -7,10 +7,14 @@
 // Read LICENSE.md for more information.
 //
 // Provides:
-//   - file management - create file, create directory, list directory contents, rename, delete, copy, move
+//   - file info - everything the helpers check about a path read with a single stat call
+//   - file management - create file, create directory, list or visit directory contents, rename, delete, copy, move
+//   - mapped files - read-only memory mapped views of whole files, line counting and line windows without copies
+//   - line index - SIMD newline counting and a sparse line offset sidecar file for direct line window seeks
 //   - file metadata - file size, directory size, line count, set extension
 //   - text I/O - read/write data for text files with vector of string lines or string blob
 //   - binary I/O - read/write data for binary files with vector of bytes or buffer + size
+//   - binary search - single-pass multi-pattern search for bytes or strings in binary files
 //------------------------------------------------------------------------------
 
 #pragma once
@@ -20,9 +24,47 @@
 #include <sstream>
 #include <fstream>
 #include <algorithm>
+#include <array>
 #include <filesystem>
+#include <functional>
 #include <cerrno>
 #include <cstring>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <bit>
+#include <system_error>
+
+#if defined(__SSE2__) \
+	|| defined(_M_X64) \
+	|| (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define KALA_FILE_SSE2
+#endif
+#if defined(__AVX2__)
+	#include <immintrin.h>
+#elif defined(KALA_FILE_SSE2)
+	#include <emmintrin.h>
+#endif
+
+#ifdef _WIN32
+	#ifndef WIN32_LEAN_AND_MEAN
+		#define WIN32_LEAN_AND_MEAN
+	#endif
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	//keep the Win32 macros from renaming the functions of the same name below
+	#pragma push_macro("CreateFile")
+	#pragma push_macro("CreateDirectory")
+	#include <windows.h>
+	#pragma pop_macro("CreateDirectory")
+	#pragma pop_macro("CreateFile")
+#else
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif
 
 //reinterpret_cast
 #ifndef rcast
@@ -44,6 +86,13 @@ namespace KalaHeaders::KalaFile
 	using std::exception;
 	using std::string;
 	using std::vector;
+	using std::array;
+	using std::span;
+	using std::string_view;
+	using std::move;
+	using std::popcount;
+	using std::countr_zero;
+	using std::error_code;
 	using std::ostringstream;
 	using std::istreambuf_iterator;
 	using std::ifstream;
@@ -54,6 +103,9 @@ namespace KalaHeaders::KalaFile
 	using std::search;
 	using std::distance;
 	using std::strerror;
+	using std::memchr;
+	using std::memcpy;
+	using std::memset;
 	using std::min;
 	using std::filesystem::exists;
 	using std::filesystem::path;
@@ -69,15 +121,53 @@ namespace KalaHeaders::KalaFile
 	using std::filesystem::file_size;
 	using std::filesystem::recursive_directory_iterator;
 	using std::filesystem::directory_iterator;
+	using std::filesystem::directory_entry;
+	using std::filesystem::directory_options;
+	using std::function;
 	using std::filesystem::status;
 	using std::filesystem::perms;
+	using std::filesystem::last_write_time;
 	
 	using u8 = uint8_t;
 	using u16 = uint16_t;
 	using u32 = uint32_t;
+	using u64 = uint64_t;
 	using i8 = int8_t;
 	using i16 = int16_t;
 	using i32 = int32_t;
+	using i64 = int64_t;
+
+#ifndef _WIN32
+	//POSIX stand-in for the strerror_s of the Windows CRT, the GNU strerror_r
+	//may return a static message instead of filling buffer so it is copied over
+	inline int strerror_s(
+		char* buffer,
+		size_t size,
+		int err)
+	{
+	#if defined(__GLIBC__) && defined(_GNU_SOURCE)
+		const char* message = strerror_r(err, buffer, size);
+		if (message != buffer)
+		{
+			strncpy(buffer, message, size - 1);
+			buffer[size - 1] = '\0';
+		}
+		return 0;
+	#else
+		return strerror_r(err, buffer, size);
+	#endif
+	}
+#endif
+
+	//Lines between two offsets stored in a line index
+	constexpr size_t LINE_INDEX_STRIDE = 1024;
+	//Appended to the indexed file path to get the path of its line index sidecar
+	constexpr const char* LINE_INDEX_EXTENSION = ".lidx";
+	//'KLIX' in little-endian, first four bytes of every line index sidecar
+	constexpr u32 LINE_INDEX_MAGIC = 0x58494C4B;
+	constexpr u32 LINE_INDEX_VERSION = 2;
+	//magic, version, stride, file size, last write, line count and offset count
+	constexpr size_t LINE_INDEX_HEADER_SIZE = 4 + 4 + 4 + 8 + 8 + 8 + 8;
 
 	enum class FileType
 	{
@@ -85,6 +175,20 @@ namespace KalaHeaders::KalaFile
 		FILE_BINARY
 	};
 
+	//What GetFileInfo read about a path, passed along to the FileInfo overloads
+	//so that chained helpers don't stat the same path again
+	struct FileInfo
+	{
+		path target{};
+		bool exists{};
+		bool isRegularFile{};
+		bool isDirectory{};
+		bool canRead{};      //any read permission bit is set
+		bool canWrite{};     //any write permission bit is set, false for read-only files on Windows
+		uintmax_t size{};    //only set for regular files
+		i64 lastWrite{};     //platform ticks, nanoseconds since the Unix epoch or FILETIME 100ns units on Windows
+	};
+
 	//Data struct that is used for creating a new file.
 	//One of the four data blocks must also be filled (inBuffer + bufferSize are together)
 	struct FileData
@@ -99,6 +203,14 @@ namespace KalaHeaders::KalaFile
 		vector<string> inLines{};
 	};
 
+	//How VisitDirectoryContents continues after the visitor has seen an entry
+	enum class VisitResult
+	{
+		VISIT_CONTINUE,       //keep walking and descend into this entry if it is a directory
+		VISIT_SKIP_DIRECTORY, //keep walking without descending into this entry
+		VISIT_STOP            //end the walk
+	};
+
 	//Start and end of chosen string or bytes value in a binary file
 	struct BinaryRange
 	{
@@ -106,6 +218,143 @@ namespace KalaHeaders::KalaFile
 		size_t end{};
 	};
 
+	//Sparse line offsets of a text file, saved next to it as a sidecar file by GetLineIndex
+	struct LineIndex
+	{
+		u64 lineCount{};        //total lines the way getline would count them
+		vector<u64> offsets{};  //offsets[i] is where line i * LINE_INDEX_STRIDE starts
+	};
+
+	//Range of one of several searched patterns in a binary file
+	struct PatternRange
+	{
+		size_t patternIndex{}; //index of the matched pattern in the passed pattern list
+		BinaryRange range{};
+	};
+
+	//
+	// FILE INFO
+	//
+
+#ifndef _WIN32
+	//Last write time of a stat result in nanoseconds since the Unix epoch
+	inline i64 GetStatLastWrite(const struct stat& fileStat)
+	{
+#ifdef __APPLE__
+		return scast<i64>(fileStat.st_mtimespec.tv_sec) * 1000000000
+			+ scast<i64>(fileStat.st_mtimespec.tv_nsec);
+#else
+		return scast<i64>(fileStat.st_mtim.tv_sec) * 1000000000
+			+ scast<i64>(fileStat.st_mtim.tv_nsec);
+#endif
+	}
+#endif
+
+	//Read everything the other helpers check about target with a single stat call.
+	//A missing target is not an error, it is returned with exists set to false.
+	//The read and metadata helpers below also take a FileInfo instead of a path,
+	//their path overloads call this first and every check after it reuses the result
+	inline string GetFileInfo(
+		const path& target,
+		FileInfo& outInfo)
+	{
+		ostringstream oss{};
+
+		FileInfo info{};
+		info.target = target;
+
+#ifdef _WIN32
+		WIN32_FILE_ATTRIBUTE_DATA data{};
+		if (!GetFileAttributesExW(
+			target.wstring().c_str(),
+			GetFileExInfoStandard,
+			&data))
+		{
+			DWORD err = GetLastError();
+			if (err == ERROR_FILE_NOT_FOUND
+				|| err == ERROR_PATH_NOT_FOUND
+				|| err == ERROR_INVALID_NAME)
+			{
+				outInfo = move(info);
+				return{};
+			}
+
+			oss << "Failed to get target '" << target << "' info! Reason: (error " << err << ")";
+
+			return oss.str();
+		}
+
+		//attributes describe the link itself, let the standard library follow it instead
+		if (data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT)
+		{
+			error_code ec{};
+			auto fileStatus = status(target, ec);
+
+			info.exists = exists(fileStatus);
+			info.isRegularFile = is_regular_file(fileStatus);
+			info.isDirectory = is_directory(fileStatus);
+			info.canRead = (fileStatus.permissions() & (
+				perms::owner_read
+				| perms::group_read
+				| perms::others_read))
+				!= perms::none;
+			info.canWrite = (fileStatus.permissions() & (
+				perms::owner_write
+				| perms::group_write
+				| perms::others_write))
+				!= perms::none;
+			if (info.isRegularFile) info.size = file_size(target, ec);
+			info.lastWrite = scast<i64>(last_write_time(target, ec).time_since_epoch().count());
+
+			outInfo = move(info);
+			return{};
+		}
+
+		info.exists = true;
+		info.isDirectory = (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+		info.isRegularFile = !info.isDirectory
+			&& (data.dwFileAttributes & FILE_ATTRIBUTE_DEVICE) == 0;
+		info.canRead = true;
+		info.canWrite = (data.dwFileAttributes & FILE_ATTRIBUTE_READONLY) == 0;
+		if (info.isRegularFile)
+		{
+			info.size =
+				(scast<uintmax_t>(data.nFileSizeHigh) << 32)
+				| scast<uintmax_t>(data.nFileSizeLow);
+		}
+		info.lastWrite = scast<i64>(
+			(scast<u64>(data.ftLastWriteTime.dwHighDateTime) << 32)
+			| scast<u64>(data.ftLastWriteTime.dwLowDateTime));
+#else
+		struct stat fileStat{};
+		if (stat(target.c_str(), &fileStat) != 0)
+		{
+			if (errno == ENOENT
+				|| errno == ENOTDIR)
+			{
+				outInfo = move(info);
+				return{};
+			}
+
+			oss << "Failed to get target '" << target << "' info! Reason: (errno " << errno << "): " << strerror(errno);
+
+			return oss.str();
+		}
+
+		info.exists = true;
+		info.isRegularFile = S_ISREG(fileStat.st_mode);
+		info.isDirectory = S_ISDIR(fileStat.st_mode);
+		info.canRead = (fileStat.st_mode & (S_IRUSR | S_IRGRP | S_IROTH)) != 0;
+		info.canWrite = (fileStat.st_mode & (S_IWUSR | S_IWGRP | S_IWOTH)) != 0;
+		if (info.isRegularFile) info.size = scast<uintmax_t>(fileStat.st_size);
+		info.lastWrite = GetStatLastWrite(fileStat);
+#endif
+
+		outInfo = move(info);
+
+		return{};
+	}
+
 	//
 	// FILE MANAGEMENT
 	//
@@ -127,6 +376,15 @@ namespace KalaHeaders::KalaFile
 		const vector<uint8_t>& inData,
 		bool append = false);
 
+	class MappedFile;
+
+	//Load the line index of a mapped file from its sidecar, or build it and save the sidecar if it is
+	//missing or was made for an older version of the file. The sidecar is keyed by file size and last write time
+	inline string GetLineIndex(
+		const path& target,
+		const MappedFile& file,
+		LineIndex& outIndex);
+
 	//Create regular or binary file at target path. If you also want data written
 	//to the new file after its been created then pass a fileData struct
 	//with one of the fields filled in, only the first found field data is used
@@ -305,37 +563,31 @@ namespace KalaHeaders::KalaFile
 		return{};
 	}
 
-	//List all the contents of a folder, with optional recursive flag
-	inline string ListDirectoryContents(
-		const path& target,
-		vector<path>& outEntries,
+	//Call the visitor for every entry of a folder as it is read instead of collecting them first,
+	//with optional recursive flag. Entry types come from the cached directory_entry data so
+	//no extra stat is needed per entry, subfolders that can't be opened are skipped when recursive
+	inline string VisitDirectoryContents(
+		const FileInfo& info,
+		const function<VisitResult(const directory_entry&)>& visitor,
 		bool recursive = false)
 	{
+		const path& target = info.target;
 		ostringstream oss{};
 
-		if (!exists(target))
+		if (!info.exists)
 		{
 			oss << "Failed to list paths from target '" << target << "' because it does not exist!";
 
 			return oss.str();
 		}
-		if (!is_directory(target))
+		if (!info.isDirectory)
 		{
 			oss << "Failed to list paths from target '" << target << "' because it is not a directory!";
 
 			return oss.str();
 		}
 		
-		auto fileStatus = status(target);
-		auto filePerms = fileStatus.permissions();
-		
-		bool canRead = (filePerms & (
-			perms::owner_read
-			| perms::group_read
-			| perms::others_read))  
-			!= perms::none;
-		
-		if (!canRead)
+		if (!info.canRead)
 		{
 			oss << "Failed to list directory contents from target '" << target << "' because of insufficient read permissions!";
 
@@ -346,16 +598,20 @@ namespace KalaHeaders::KalaFile
 		{
 			if (recursive)
 			{
-				for (auto& entry : recursive_directory_iterator(target))
+				recursive_directory_iterator it(target, directory_options::skip_permission_denied);
+				for (const recursive_directory_iterator end{}; it != end; ++it)
 				{
-					outEntries.push_back(entry.path());
+					VisitResult result = visitor(*it);
+
+					if (result == VisitResult::VISIT_STOP) break;
+					if (result == VisitResult::VISIT_SKIP_DIRECTORY) it.disable_recursion_pending();
 				}
 			}
 			else
 			{
-				for (auto& entry : directory_iterator(target))
+				for (const auto& entry : directory_iterator(target))
 				{
-					outEntries.push_back(entry.path());
+					if (visitor(entry) == VisitResult::VISIT_STOP) break;
 				}
 			}
 		}
@@ -369,21 +625,53 @@ namespace KalaHeaders::KalaFile
 		return{};
 	}
 
+	inline string VisitDirectoryContents(
+		const path& target,
+		const function<VisitResult(const directory_entry&)>& visitor,
+		bool recursive = false)
+	{
+		FileInfo info{};
+		string result = GetFileInfo(target, info);
+		if (!result.empty()) return result;
+
+		return VisitDirectoryContents(
+			info,
+			visitor,
+			recursive);
+	}
+
+	//List all the contents of a folder, with optional recursive flag
+	inline string ListDirectoryContents(
+		const path& target,
+		vector<path>& outEntries,
+		bool recursive = false)
+	{
+		return VisitDirectoryContents(
+			target,
+			[&outEntries](const directory_entry& entry)
+			{
+				outEntries.push_back(entry.path());
+				return VisitResult::VISIT_CONTINUE;
+			},
+			recursive);
+	}
+
 	//Rename file or folder in its current directory
 	inline string RenamePath(
-		const path& target,
+		const FileInfo& info,
 		const string& newName)
 	{
+		const path& target = info.target;
 		ostringstream oss{};
 
-		if (!exists(target))
+		if (!info.exists)
 		{
 			oss << "Failed to rename target '" << target << "' to '"
 				<< newName << "' because it does not exist!";
 
 			return oss.str();
 		}
-		if (is_directory(target)
+		if (info.isDirectory
 			&& path(newName).has_extension())
 		{
 			oss << "Failed to rename target '" << target << "' to '"
@@ -391,7 +679,7 @@ namespace KalaHeaders::KalaFile
 
 			return oss.str();
 		}
-		if (is_regular_file(target)
+		if (info.isRegularFile
 			&& newName.empty())
 		{
 			oss << "Failed to rename target '" << target << "' to '"
@@ -433,12 +721,26 @@ namespace KalaHeaders::KalaFile
 		return{};
 	}
 
+	inline string RenamePath(
+		const path& target,
+		const string& newName)
+	{
+		FileInfo info{};
+		string result = GetFileInfo(target, info);
+		if (!result.empty()) return result;
+
+		return RenamePath(
+			info,
+			newName);
+	}
+
 	//Delete file or folder in target path (recursive for directories)
-	inline string DeletePath(const path& target)
+	inline string DeletePath(const FileInfo& info)
 	{
+		const path& target = info.target;
 		ostringstream oss{};
 
-		if (!exists(target))
+		if (!info.exists)
 		{
 			oss << "Failed to delete target '"
 				<< target << "' because it does not exist!";
@@ -464,8 +766,8 @@ namespace KalaHeaders::KalaFile
 
 		try
 		{
-			if (is_regular_file(target)) remove(target);
-			else if (is_directory(target)) remove_all(target);
+			if (info.isRegularFile) remove(target);
+			else if (info.isDirectory) remove_all(target);
 		}
 		catch (exception& e)
 		{
@@ -478,6 +780,15 @@ namespace KalaHeaders::KalaFile
 		return{};
 	}
 
+	inline string DeletePath(const path& target)
+	{
+		FileInfo info{};
+		string result = GetFileInfo(target, info);
+		if (!result.empty()) return result;
+
+		return DeletePath(info);
+	}
+
 	//Copy file or folder from origin to target, with optional overwrite flag
 	inline string CopyPath(
 		const path& origin,
@@ -486,17 +797,24 @@ namespace KalaHeaders::KalaFile
 	{
 		ostringstream oss{};
 
-		if (!exists(origin))
+		FileInfo originInfo{};
+		FileInfo targetInfo{};
+
+		string infoResult = GetFileInfo(origin, originInfo);
+		if (infoResult.empty()) infoResult = GetFileInfo(target, targetInfo);
+		if (!infoResult.empty()) return infoResult;
+
+		if (!originInfo.exists)
 		{
 			oss << "Failed to copy origin to target because origin '"
 				<< origin << "' does not exist!";
 
 			return oss.str();
 		}
-		if (exists(target)
+		if (targetInfo.exists
 			&& overwrite)
 		{
-			string result = DeletePath(target);
+			string result = DeletePath(targetInfo);
 			if (!result.empty())
 			{
 				oss << "Failed to copy origin '"
@@ -506,7 +824,7 @@ namespace KalaHeaders::KalaFile
 				return oss.str();
 			}
 		}
-		if (is_directory(origin)
+		if (originInfo.isDirectory
 			&& target.has_extension())
 		{
 			oss << "Failed to copy origin '" << origin << "' to '"
@@ -514,7 +832,7 @@ namespace KalaHeaders::KalaFile
 
 			return oss.str();
 		}
-		if (is_regular_file(origin)
+		if (originInfo.isRegularFile
 			&& target.empty())
 		{
 			oss << "Failed to copy origin '" << origin << "' to '"
@@ -557,7 +875,7 @@ namespace KalaHeaders::KalaFile
 
 		try
 		{
-			if (is_regular_file(origin))
+			if (originInfo.isRegularFile)
 			{
 				copy_file(
 					origin,
@@ -566,7 +884,7 @@ namespace KalaHeaders::KalaFile
 					? copy_options::overwrite_existing
 					: copy_options::skip_existing);
 			}
-			else if (is_directory(origin))
+			else if (originInfo.isDirectory)
 			{
 				copy(
 					origin,
@@ -597,16 +915,23 @@ namespace KalaHeaders::KalaFile
 	{
 		ostringstream oss{};
 
-		if (!exists(origin))
+		FileInfo originInfo{};
+		FileInfo targetInfo{};
+
+		string infoResult = GetFileInfo(origin, originInfo);
+		if (infoResult.empty()) infoResult = GetFileInfo(target, targetInfo);
+		if (!infoResult.empty()) return infoResult;
+
+		if (!originInfo.exists)
 		{
 			oss << "Failed to move origin to target because origin '"
 				<< origin << "' does not exist!";
 
 			return oss.str();
 		}
-		if (exists(target))
+		if (targetInfo.exists)
 		{
-			string result = DeletePath(target);
+			string result = DeletePath(targetInfo);
 			if (!result.empty())
 			{
 				oss << "Failed to move origin '"
@@ -616,7 +941,7 @@ namespace KalaHeaders::KalaFile
 				return oss.str();
 			}
 		}
-		if (is_directory(origin)
+		if (originInfo.isDirectory
 			&& target.has_extension())
 		{
 			oss << "Failed to move origin '" << origin << "' to '"
@@ -624,7 +949,7 @@ namespace KalaHeaders::KalaFile
 
 			return oss.str();
 		}
-		if (is_regular_file(origin)
+		if (originInfo.isRegularFile
 			&& target.empty())
 		{
 			oss << "Failed to move origin '" << origin << "' to '"
@@ -682,227 +1007,585 @@ namespace KalaHeaders::KalaFile
 	}
 
 	//
-	// FILE METADATA
+	// MAPPED FILES
 	//
 
-	//Get the size of the target file in bytes
-	inline string GetFileSize(
-		const path& target,
-		uintmax_t& outSize)
+	//Read-only view of a whole file mapped into memory, so it is read straight from
+	//the page cache without being copied into a buffer first. The views stay valid
+	//until the file is closed or destroyed. Empty files open with an empty view
+	class MappedFile
 	{
-		ostringstream oss{};
+	public:
+		MappedFile() = default;
+		~MappedFile() { Close(); }
 
-		if (!exists(target))
-		{
-			oss << "Failed to get target file '" << target << "' size because it does not exist!";
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
 
-			return oss.str();
-		}
-		if (!is_regular_file(target))
+		MappedFile(MappedFile&& other) noexcept { *this = move(other); }
+		MappedFile& operator=(MappedFile&& other) noexcept
 		{
-			oss << "Failed to get target file '" << target << "' size because it is not a regular file!";
+			if (this == &other) return *this;
 
-			return oss.str();
-		}
-		
-		auto fileStatus = status(target.parent_path());
-		auto filePerms = fileStatus.permissions();
-		
-		bool canRead = (filePerms & (
-			perms::owner_read
-			| perms::group_read
-			| perms::others_read))  
-			!= perms::none;
-		
-		if (!canRead)
-		{
-			oss << "Failed to get file size from target '" << target << "' because of insufficient read permissions!";
+			Close();
 
-			return oss.str();
-		}
+			data = other.data;
+			size = other.size;
+			lastWrite = other.lastWrite;
+			isOpen = other.isOpen;
+#ifdef _WIN32
+			fileHandle = other.fileHandle;
+			mappingHandle = other.mappingHandle;
 
-		try
-		{
-			outSize = file_size(target);
-		}
-		catch (exception& e)
-		{
-			oss << "Failed to get target file '" << target << "' size! Reason: " << e.what();
+			other.fileHandle = INVALID_HANDLE_VALUE;
+			other.mappingHandle = nullptr;
+#endif
+			other.data = nullptr;
+			other.size = 0;
+			other.lastWrite = 0;
+			other.isOpen = false;
 
-			return oss.str();
+			return *this;
 		}
 
-		return{};
-	}
-
-	//Get the size of the target directory in bytes
-	inline string GetDirectorySize(
-		const path& target,
-		uintmax_t& outSize)
-	{
-		ostringstream oss{};
-		uintmax_t totalSize{};
-
-		if (!exists(target))
-		{
-			oss << "Failed to get target directory '" << target << "' size because it does not exist!";
-
-			return oss.str();
-		}
-		if (!is_directory(target))
+		//Map the target file for reading, closes the previously mapped file first
+		inline string Open(const path& target)
 		{
-			oss << "Failed to get target directory '" << target << "' size because it is not a directory!";
+			Close();
 
-			return oss.str();
-		}
-		
-		auto fileStatus = status(target);
-		auto filePerms = fileStatus.permissions();
-		
-		bool canRead = (filePerms & (
-			perms::owner_read
-			| perms::group_read
-			| perms::others_read))  
-			!= perms::none;
-		
-		if (!canRead)
-		{
-			oss << "Failed to get directory size from target '" << target << "' because of insufficient read permissions!";
+			ostringstream oss{};
 
-			return oss.str();
-		}
+#ifdef _WIN32
+			fileHandle = CreateFileW(
+				target.wstring().c_str(),
+				GENERIC_READ,
+				FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+				nullptr,
+				OPEN_EXISTING,
+				FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+				nullptr);
 
-		try
-		{
-			for (const auto& file : recursive_directory_iterator(target))
+			if (fileHandle == INVALID_HANDLE_VALUE)
 			{
-				//skip directories
-				if (is_directory(file)) continue;
+				oss << "Failed to map target '" << target << "' because it couldn't be opened! Reason: (error " << GetLastError() << ")";
 
-				uintmax_t fileSize{};
-				string result = GetFileSize(file, fileSize);
+				return oss.str();
+			}
 
-				if (!result.empty())
-				{
-					oss << "Failed to get target directory '"
-						<< target << "' size because one of its file sizes couldn't be read! Reason: '" << result;
+			LARGE_INTEGER fileSize{};
+			if (!GetFileSizeEx(fileHandle, &fileSize))
+			{
+				oss << "Failed to map target '" << target << "' because its size couldn't be read! Reason: (error " << GetLastError() << ")";
+				Close();
 
-					return oss.str();
-				}
+				return oss.str();
+			}
+
+			if (scast<unsigned long long>(fileSize.QuadPart) > SIZE_MAX)
+			{
+				oss << "Failed to map target '" << target << "' because it is too large for this address space!";
+				Close();
 
-				totalSize += fileSize;
+				return oss.str();
 			}
-			outSize = totalSize;
-		}
-		catch (exception& e)
-		{
-			oss << "Failed to get target directory '" << target << "' size! Reason: " << e.what();
 
-			return oss.str();
-		}
+			FILETIME writeTime{};
+			if (GetFileTime(fileHandle, nullptr, nullptr, &writeTime))
+			{
+				lastWrite = scast<i64>(
+					(scast<u64>(writeTime.dwHighDateTime) << 32)
+					| scast<u64>(writeTime.dwLowDateTime));
+			}
 
-		return{};
-	}
+			size = scast<size_t>(fileSize.QuadPart);
+			isOpen = true;
 
-	//Get the count of lines in a text file
-	inline string GetTextFileLineCount(
-		const path& target,
-		size_t& outCount)
-	{
-		ostringstream oss{};
-		size_t totalCount{};
+			//zero sized files can't be mapped
+			if (size == 0) return{};
 
-		if (!exists(target))
-		{
-			oss << "Failed to get target '" << target << "' line count because it does not exist!";
+			mappingHandle = CreateFileMappingW(
+				fileHandle,
+				nullptr,
+				PAGE_READONLY,
+				0,
+				0,
+				nullptr);
 
-			return oss.str();
-		}
-		if (!is_regular_file(target))
-		{
-			oss << "Failed to get target '" << target << "' line count because it is not a regular file!";
+			if (mappingHandle == nullptr)
+			{
+				oss << "Failed to map target '" << target << "'! Reason: (error " << GetLastError() << ")";
+				Close();
 
-			return oss.str();
-		}
-		
-		auto fileStatus = status(target);
-		auto filePerms = fileStatus.permissions();
-		
-		bool canRead = (filePerms & (
-			perms::owner_read
-			| perms::group_read
-			| perms::others_read))  
-			!= perms::none;
-		
-		if (!canRead)
-		{
-			oss << "Failed to get text file line count from target '" << target << "' because of insufficient read permissions!";
+				return oss.str();
+			}
 
-			return oss.str();
-		}
+			data = scast<const uint8_t*>(MapViewOfFile(
+				mappingHandle,
+				FILE_MAP_READ,
+				0,
+				0,
+				0));
 
-		try
-		{
-			ifstream in(
-				target, 
-				ios::in);
+			if (data == nullptr)
+			{
+				oss << "Failed to map a view of target '" << target << "'! Reason: (error " << GetLastError() << ")";
+				Close();
 
-			if (in.fail()
-				&& errno != 0)
+				return oss.str();
+			}
+#else
+			int fd = open(target.c_str(), O_RDONLY | O_CLOEXEC);
+			if (fd == -1)
 			{
-				int err = errno;
-				char buf[256]{};
+				oss << "Failed to map target '" << target << "' because it couldn't be opened! Reason: (errno " << errno << "): " << strerror(errno);
 
-				oss << "Failed to get target '" << target
-					<< "' line count because it couldn't be opened! "
-					<< "Reason: (errno " << err << "): ";
+				return oss.str();
+			}
 
-				if (strerror_s(buf, sizeof(buf), err) == 0) oss << buf;
-				else oss << " Unknown error";
+			struct stat fileStat{};
+			if (fstat(fd, &fileStat) != 0)
+			{
+				oss << "Failed to map target '" << target << "' because its size couldn't be read! Reason: (errno " << errno << "): " << strerror(errno);
+				close(fd);
 
 				return oss.str();
 			}
 
-			string tmp{};
-			while (getline(in, tmp)) ++totalCount;
+			size = scast<size_t>(fileStat.st_size);
+			lastWrite = GetStatLastWrite(fileStat);
+			isOpen = true;
 
-			if (totalCount == 0)
+			//zero sized files can't be mapped
+			if (size == 0)
 			{
-				oss << "Failed to get target '" << target << "' line count because it had no lines!";
+				close(fd);
+				return{};
+			}
+
+			void* mapped = mmap(
+				nullptr,
+				size,
+				PROT_READ,
+				MAP_PRIVATE,
+				fd,
+				0);
+
+			//the mapping keeps its own reference to the file
+			close(fd);
+
+			if (mapped == MAP_FAILED)
+			{
+				oss << "Failed to map target '" << target << "'! Reason: (errno " << errno << "): " << strerror(errno);
+				size = 0;
+				isOpen = false;
 
 				return oss.str();
 			}
 
-			outCount = totalCount;
+			madvise(mapped, size, MADV_SEQUENTIAL);
 
-			in.close();
+			data = scast<const uint8_t*>(mapped);
+#endif
+			return{};
 		}
-		catch (exception& e)
+
+		//Unmap the file, all views returned by this file become invalid
+		inline void Close()
 		{
-			oss << "Failed to get target '" << target << "' line count! Reason: " << e.what();
+#ifdef _WIN32
+			if (data != nullptr) UnmapViewOfFile(data);
+			if (mappingHandle != nullptr) CloseHandle(mappingHandle);
+			if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
 
-			return oss.str();
-		}
+			mappingHandle = nullptr;
+			fileHandle = INVALID_HANDLE_VALUE;
+#else
+			if (data != nullptr) munmap(const_cast<uint8_t*>(data), size);
+#endif
+			data = nullptr;
+			size = 0;
+			lastWrite = 0;
+			isOpen = false;
+		}
+
+		inline bool IsOpen() const { return isOpen; }
+		inline size_t GetSize() const { return size; }
+		//Last write time when the file was opened, in the same ticks as FileInfo::lastWrite
+		inline i64 GetLastWrite() const { return lastWrite; }
+
+		inline span<const uint8_t> GetBytes() const { return { data, size }; }
+		inline string_view GetText() const { return { rcast<const char*>(data), size }; }
+	private:
+		const uint8_t* data{};
+		size_t size{};
+		i64 lastWrite{};
+		bool isOpen{};
+#ifdef _WIN32
+		HANDLE fileHandle = INVALID_HANDLE_VALUE;
+		HANDLE mappingHandle{};
+#endif
+	};
 
-		return{};
+	//Bitmask of the '\n' bytes in the NEWLINE_BLOCK_SIZE bytes at p, bit i is set for p[i]
+#if defined(__AVX2__)
+	constexpr size_t NEWLINE_BLOCK_SIZE = 32;
+
+	inline u32 GetNewlineMask(const char* p)
+	{
+		const __m256i block = _mm256_loadu_si256(rcast<const __m256i*>(p));
+		return scast<u32>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, _mm256_set1_epi8('\n'))));
 	}
+#elif defined(KALA_FILE_SSE2)
+	constexpr size_t NEWLINE_BLOCK_SIZE = 16;
 
-	//Set the extension of the target
-	inline string SetPathExtension(
-		const path& target,
-		const string& newExtension,
-		string& outResult)
+	inline u32 GetNewlineMask(const char* p)
 	{
+		const __m128i block = _mm_loadu_si128(rcast<const __m128i*>(p));
+		return scast<u32>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8('\n'))));
+	}
+#else
+	constexpr size_t NEWLINE_BLOCK_SIZE = 8;
+
+	inline u32 GetNewlineMask(const char* p)
+	{
+		u32 mask{};
+		for (size_t i = 0; i < NEWLINE_BLOCK_SIZE; ++i)
+		{
+			if (p[i] == '\n') mask |= 1u << i;
+		}
+		return mask;
+	}
+#endif
+
+	//Count of '\n' bytes in data, checked a whole vector register at a time where AVX2 or SSE2 is available
+	inline size_t CountNewlines(
+		const char* data,
+		size_t size)
+	{
+		size_t count{};
+		size_t i{};
+
+		for (; i + NEWLINE_BLOCK_SIZE <= size; i += NEWLINE_BLOCK_SIZE)
+		{
+			count += scast<size_t>(popcount(GetNewlineMask(data + i)));
+		}
+		for (; i < size; ++i)
+		{
+			if (data[i] == '\n') ++count;
+		}
+
+		return count;
+	}
+
+	//Offset just past the count-th '\n' byte in data, or size if data has fewer of them
+	inline size_t SkipNewlines(
+		const char* data,
+		size_t size,
+		size_t count)
+	{
+		if (count == 0) return 0;
+
+		size_t i{};
+		for (; i + NEWLINE_BLOCK_SIZE <= size; i += NEWLINE_BLOCK_SIZE)
+		{
+			u32 mask = GetNewlineMask(data + i);
+			size_t found = scast<size_t>(popcount(mask));
+
+			if (found < count)
+			{
+				count -= found;
+				continue;
+			}
+
+			//drop the lower newlines of this block until the wanted one is the lowest set bit
+			for (size_t j = 1; j < count; ++j) mask &= mask - 1;
+
+			return i + scast<size_t>(countr_zero(mask)) + 1;
+		}
+		for (; i < size; ++i)
+		{
+			if (data[i] == '\n'
+				&& --count == 0)
+			{
+				return i + 1;
+			}
+		}
+
+		return size;
+	}
+
+	//Count of lines in text the same way getline would count them,
+	//a trailing newline does not start one more empty line
+	inline size_t CountTextLines(string_view text)
+	{
+		if (text.empty()) return 0;
+
+		size_t count = CountNewlines(text.data(), text.size());
+
+		//last line without a trailing newline
+		if (text.back() != '\n') ++count;
+
+		return count;
+	}
+
+	//Byte offset where the line at lineIndex starts, or text.size() if text has fewer lines
+	inline size_t FindLineStart(
+		string_view text,
+		size_t lineIndex)
+	{
+		return SkipNewlines(
+			text.data(),
+			text.size(),
+			lineIndex);
+	}
+
+	//Views of the lines lineStart up to lineEnd of text without copying them, newlines are not included.
+	//On Windows a '\r' before the newline is dropped too, like text mode streams do.
+	//Stops early if text runs out of lines
+	inline void GetTextLineViews(
+		string_view text,
+		vector<string_view>& outLines,
+		size_t lineStart,
+		size_t lineEnd)
+	{
+		size_t offset = FindLineStart(text, lineStart);
+
+		for (size_t i = lineStart; i < lineEnd && offset < text.size(); ++i)
+		{
+			size_t newLine = text.find('\n', offset);
+			size_t lineEndOffset = newLine == string_view::npos ? text.size() : newLine;
+
+			string_view line = text.substr(offset, lineEndOffset - offset);
+#ifdef _WIN32
+			if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+#endif
+			outLines.push_back(line);
+
+			offset = lineEndOffset + 1;
+		}
+	}
+
+	//
+	// FILE METADATA
+	//
+
+	//Get the size of the target file in bytes
+	inline string GetFileSize(
+		const FileInfo& info,
+		uintmax_t& outSize)
+	{
+		const path& target = info.target;
+		ostringstream oss{};
+
+		if (!info.exists)
+		{
+			oss << "Failed to get target file '" << target << "' size because it does not exist!";
+
+			return oss.str();
+		}
+		if (!info.isRegularFile)
+		{
+			oss << "Failed to get target file '" << target << "' size because it is not a regular file!";
+
+			return oss.str();
+		}
+
+		//the size came with the same stat that found the file
+		outSize = info.size;
+
+		return{};
+	}
+
+	inline string GetFileSize(
+		const path& target,
+		uintmax_t& outSize)
+	{
+		FileInfo info{};
+		string result = GetFileInfo(target, info);
+		if (!result.empty()) return result;
+
+		return GetFileSize(
+			info,
+			outSize);
+	}
+
+	//Get the size of the target directory in bytes
+	inline string GetDirectorySize(
+		const FileInfo& info,
+		uintmax_t& outSize)
+	{
+		const path& target = info.target;
+		ostringstream oss{};
+		uintmax_t totalSize{};
+
+		if (!info.exists)
+		{
+			oss << "Failed to get target directory '" << target << "' size because it does not exist!";
+
+			return oss.str();
+		}
+		if (!info.isDirectory)
+		{
+			oss << "Failed to get target directory '" << target << "' size because it is not a directory!";
+
+			return oss.str();
+		}
+		
+		if (!info.canRead)
+		{
+			oss << "Failed to get directory size from target '" << target << "' because of insufficient read permissions!";
+
+			return oss.str();
+		}
+
+		try
+		{
+			for (const auto& file : recursive_directory_iterator(target))
+			{
+				//only regular files have a size, the type comes from the cached entry data
+				if (!file.is_regular_file()) continue;
+
+				//already known to exist and be readable, so skip the checks GetFileSize would repeat
+				totalSize += file.file_size();
+			}
+			outSize = totalSize;
+		}
+		catch (exception& e)
+		{
+			oss << "Failed to get target directory '" << target << "' size! Reason: " << e.what();
+
+			return oss.str();
+		}
+
+		return{};
+	}
+
+	inline string GetDirectorySize(
+		const path& target,
+		uintmax_t& outSize)
+	{
+		FileInfo info{};
+		string result = GetFileInfo(target, info);
+		if (!result.empty()) return result;
+
+		return GetDirectorySize(
+			info,
+			outSize);
+	}
+
+	//Get the count of lines in a text file. With useLineIndex the count is read from
+	//the line index sidecar of the file, which is created or refreshed first if needed
+	inline string GetTextFileLineCount(
+		const FileInfo& info,
+		size_t& outCount,
+		bool useLineIndex = false)
+	{
+		const path& target = info.target;
 		ostringstream oss{};
+		size_t totalCount{};
 
-		if (!exists(target))
+		if (!info.exists)
+		{
+			oss << "Failed to get target '" << target << "' line count because it does not exist!";
+
+			return oss.str();
+		}
+		if (!info.isRegularFile)
+		{
+			oss << "Failed to get target '" << target << "' line count because it is not a regular file!";
+
+			return oss.str();
+		}
+		
+		if (!info.canRead)
+		{
+			oss << "Failed to get text file line count from target '" << target << "' because of insufficient read permissions!";
+
+			return oss.str();
+		}
+
+		try
+		{
+			MappedFile file{};
+			string result = file.Open(target);
+
+			if (!result.empty())
+			{
+				oss << "Failed to get target '" << target << "' line count! Reason: " << result;
+
+				return oss.str();
+			}
+
+			if (useLineIndex)
+			{
+				LineIndex index{};
+				result = GetLineIndex(target, file, index);
+
+				if (!result.empty())
+				{
+					oss << "Failed to get target '" << target << "' line count! Reason: " << result;
+
+					return oss.str();
+				}
+
+				totalCount = scast<size_t>(index.lineCount);
+			}
+			else totalCount = CountTextLines(file.GetText());
+
+			if (totalCount == 0)
+			{
+				oss << "Failed to get target '" << target << "' line count because it had no lines!";
+
+				return oss.str();
+			}
+
+			outCount = totalCount;
+		}
+		catch (exception& e)
+		{
+			oss << "Failed to get target '" << target << "' line count! Reason: " << e.what();
+
+			return oss.str();
+		}
+
+		return{};
+	}
+
+	inline string GetTextFileLineCount(
+		const path& target,
+		size_t& outCount,
+		bool useLineIndex = false)
+	{
+		FileInfo info{};
+		string result = GetFileInfo(target, info);
+		if (!result.empty()) return result;
+
+		return GetTextFileLineCount(
+			info,
+			outCount,
+			useLineIndex);
+	}
+
+	//Set the extension of the target
+	inline string SetPathExtension(
+		const path& target,
+		const string& newExtension,
+		string& outResult)
+	{
+		ostringstream oss{};
+
+		FileInfo info{};
+		string infoResult = GetFileInfo(target, info);
+		if (!infoResult.empty()) return infoResult;
+
+		if (!info.exists)
 		{
 			oss << "Failed to set target '"
 				<< target << "' extension because it does not exist!";
 
 			return oss.str();
 		}
-		if (!is_regular_file(target))
+		if (!info.isRegularFile)
 		{
 			oss << "Failed to set extension for target '"
 				<< target << "' because it is not a regular file!";
@@ -910,16 +1593,7 @@ namespace KalaHeaders::KalaFile
 			return oss.str();
 		}
 		
-		auto fileStatus = status(target);
-		auto filePerms = fileStatus.permissions();
-		
-		bool canWrite = (filePerms & (
-			perms::owner_write
-			| perms::group_write
-			| perms::others_write))  
-			!= perms::none;
-		
-		if (!canWrite)
+		if (!info.canWrite)
 		{
 			oss << "Failed to set path extension for target '" << target << "' because of insufficient write permissions!";
 
@@ -931,8 +1605,9 @@ namespace KalaHeaders::KalaFile
 			path newTarget = target;
 			newTarget.replace_extension(newExtension);
 
+			//target was already checked above, the rename doesn't need to stat it again
 			string result = RenamePath(
-				target,
+				info,
 				newTarget.filename().string());
 
 			if (!result.empty())
@@ -969,8 +1644,12 @@ namespace KalaHeaders::KalaFile
 	{
 		ostringstream oss{};
 
-		if (exists(target)
-			&& !is_regular_file(target))
+		FileInfo info{};
+		string infoResult = GetFileInfo(target, info);
+		if (!infoResult.empty()) return infoResult;
+
+		if (info.exists
+			&& !info.isRegularFile)
 		{
 			oss << "Failed to write text to target '" << target << "' because it is not a regular file!";
 
@@ -983,16 +1662,8 @@ namespace KalaHeaders::KalaFile
 			return oss.str();
 		}
 		
-		auto fileStatus = status(target);
-		auto filePerms = fileStatus.permissions();
-		
-		bool canWrite = (filePerms & (
-			perms::owner_write
-			| perms::group_write
-			| perms::others_write))  
-			!= perms::none;
-		
-		if (!canWrite)
+		if (info.exists
+			&& !info.canWrite)
 		{
 			oss << "Failed to write text to target '" << target << "' because of insufficient write permissions!";
 
@@ -1049,35 +1720,27 @@ namespace KalaHeaders::KalaFile
 	}
 	//Read all text from a file into a string
 	inline string ReadTextFromFile(
-		const path& target, 
+		const FileInfo& info,
 		string& outText)
 	{
+		const path& target = info.target;
 		ostringstream oss{};
 		string allText{};
 
-		if (!exists(target))
+		if (!info.exists)
 		{
 			oss << "Failed to read text from target '" << target << "' because it does not exist!";
 
 			return oss.str();
 		}
-		if (!is_regular_file(target))
+		if (!info.isRegularFile)
 		{
 			oss << "Failed to read text from target '" << target << "' because it is not a regular file!";
 
 			return oss.str();
 		}
 		
-		auto fileStatus = status(target);
-		auto filePerms = fileStatus.permissions();
-		
-		bool canRead = (filePerms & (
-			perms::owner_read
-			| perms::group_read
-			| perms::others_read))  
-			!= perms::none;
-		
-		if (!canRead)
+		if (!info.canRead)
 		{
 			oss << "Failed to get text from target '" << target << "' because of insufficient read permissions!";
 
@@ -1086,33 +1749,38 @@ namespace KalaHeaders::KalaFile
 
 		try
 		{
-			ifstream in(
-				target,
-				ios::in);
+			MappedFile file{};
+			string result = file.Open(target);
 
-			if (in.fail()
-				&& errno != 0)
+			if (!result.empty())
 			{
-				int err = errno;
-				char buf[256]{};
-
-				oss << "Failed to read text from target '" << target
-					<< "' because it couldn't be opened! "
-					<< "Reason: (errno " << err << "): ";
-
-				if (strerror_s(buf, sizeof(buf), err) == 0) oss << buf;
-				else oss << " Unknown error";
+				oss << "Failed to read text from target '" << target << "'! Reason: " << result;
 
 				return oss.str();
 			}
 
-			ostringstream buffer{};
+			string_view text = file.GetText();
+#ifdef _WIN32
+			//text mode streams turn every '\r\n' into '\n'
+			allText.reserve(text.size());
 
-			buffer << in.rdbuf();
-			allText = buffer.str();
-
-			in.close();
+			size_t offset{};
+			while (offset < text.size())
+			{
+				size_t lineBreak = text.find("\r\n", offset);
+				if (lineBreak == string_view::npos)
+				{
+					allText.append(text.substr(offset));
+					break;
+				}
 
+				allText.append(text.substr(offset, lineBreak - offset));
+				allText += '\n';
+				offset = lineBreak + 2;
+			}
+#else
+			allText.assign(text);
+#endif
 			if (allText.empty())
 			{
 				oss << "Failed to read text from target '" << target << "' because it was empty!";
@@ -1121,7 +1789,7 @@ namespace KalaHeaders::KalaFile
 			}
 
 			//successfully got data
-			outText = allText;
+			outText = move(allText);
 		}
 		catch (exception& e)
 		{
@@ -1133,6 +1801,19 @@ namespace KalaHeaders::KalaFile
 		return{};
 	}
 
+	inline string ReadTextFromFile(
+		const path& target,
+		string& outText)
+	{
+		FileInfo info{};
+		string result = GetFileInfo(target, info);
+		if (!result.empty()) return result;
+
+		return ReadTextFromFile(
+			info,
+			outText);
+	}
+
 	//Write all lines from a vector to a text file, with optional append flag.
 	//A new file is created at target path if it doesn't already exist
 	inline string WriteLinesToFile(
@@ -1142,8 +1823,12 @@ namespace KalaHeaders::KalaFile
 	{
 		ostringstream oss{};
 
-		if (exists(target)
-			&& !is_regular_file(target))
+		FileInfo info{};
+		string infoResult = GetFileInfo(target, info);
+		if (!infoResult.empty()) return infoResult;
+
+		if (info.exists
+			&& !info.isRegularFile)
 		{
 			oss << "Failed to write lines to target '" << target << "' because it is not a regular file!";
 
@@ -1156,16 +1841,8 @@ namespace KalaHeaders::KalaFile
 			return oss.str();
 		}
 		
-		auto fileStatus = status(target);
-		auto filePerms = fileStatus.permissions();
-		
-		bool canWrite = (filePerms & (
-			perms::owner_write
-			| perms::group_write
-			| perms::others_write))  
-			!= perms::none;
-		
-		if (!canWrite)
+		if (info.exists
+			&& !info.canWrite)
 		{
 			oss << "Failed to write lines to target '" << target << "' because of insufficient write permissions!";
 
@@ -1223,140 +1900,182 @@ namespace KalaHeaders::KalaFile
 
 		return{};
 	}
-	//Read all lines from a file into a vector of strings with optional 
-	//lineStart and lineEnd values to avoid placing all lines to memory.
-	//If lineEnd is 0 and lineStart isnt, then this function defaults end to EOF
+	//Views of the lines lineStart up to lineEnd of an already mapped file, nothing is copied
+	//and lines before lineStart are only skipped over. The views stay valid while the file stays open.
+	//If lineEnd is 0 and lineStart isnt, then this function defaults end to EOF.
+	//With an index from GetLineIndex the line count and the start of the window come from it
+	//instead of scanning everything before lineStart
 	inline string ReadLinesFromFile(
-		const path& target,
-		vector<string>& outLines,
+		const MappedFile& file,
+		vector<string_view>& outLines,
 		size_t lineStart = 0,
-		size_t lineEnd = 0)
+		size_t lineEnd = 0,
+		const LineIndex* index = nullptr)
 	{
 		ostringstream oss{};
-		vector<string> allLines{};
 
-		if (!exists(target))
+		if (!file.IsOpen())
 		{
-			oss << "Failed to read lines from target '" << target << "' because it does not exist!";
+			oss << "Failed to read lines because the mapped file is not open!";
 
 			return oss.str();
 		}
-		if (!is_regular_file(target))
+
+		string_view text = file.GetText();
+
+		size_t totalLines = index
+			? scast<size_t>(index->lineCount)
+			: CountTextLines(text);
+		if (totalLines == 0)
 		{
-			oss << "Failed to read lines from target '" << target << "' because it is not a regular file!";
+			oss << "Failed to read lines because the mapped file had no lines!";
 
 			return oss.str();
 		}
-		
-		auto fileStatus = status(target);
-		auto filePerms = fileStatus.permissions();
-		
-		bool canRead = (filePerms & (
-			perms::owner_read
-			| perms::group_read
-			| perms::others_read))  
-			!= perms::none;
-		
-		if (!canRead)
+
+		if (lineEnd == 0) lineEnd = totalLines;
+
+		if (lineEnd <= lineStart)
 		{
-			oss << "Failed to read lines from target '" << target << "' because of insufficient read permissions!";
+			oss << "Failed to read lines because lineEnd '"
+				<< lineEnd << "' is lower or equal to lineStart '" << lineStart << "'!";
 
 			return oss.str();
 		}
+		if (lineStart >= totalLines)
+		{
+			oss << "Failed to read lines because lineStart '"
+				<< lineStart << "' is higher or equal to totalLines '" << totalLines << "'!";
 
-		try
+			return oss.str();
+		}
+		if (lineEnd > totalLines)
 		{
-			ifstream in(
-				target,
-				ios::in);
+			oss << "Failed to read lines because lineEnd '"
+				<< lineEnd << "' is higher than totalLines '" << totalLines << "'!";
 
-			if (in.fail()
-				&& errno != 0)
-			{
-				int err = errno;
-				char buf[256]{};
+			return oss.str();
+		}
 
-				oss << "Failed to read lines from target '" << target
-					<< "' because it couldn't be opened! "
-					<< "Reason: (errno " << err << "): ";
+		vector<string_view> lines{};
+		lines.reserve(lineEnd - lineStart);
 
-				if (strerror_s(buf, sizeof(buf), err) == 0) oss << buf;
-				else oss << " Unknown error";
+		//jump to the closest indexed line at or before lineStart
+		size_t firstLine{};
+		if (index
+			&& !index->offsets.empty())
+		{
+			size_t slot = min(lineStart / LINE_INDEX_STRIDE, index->offsets.size() - 1);
+			size_t offset = scast<size_t>(index->offsets[slot]);
 
-				return oss.str();
+			if (offset <= text.size())
+			{
+				firstLine = slot * LINE_INDEX_STRIDE;
+				text.remove_prefix(offset);
 			}
+		}
 
-			size_t totalLines{};
-			string result = GetTextFileLineCount(target, totalLines);
+		GetTextLineViews(
+			text,
+			lines,
+			lineStart - firstLine,
+			lineEnd - firstLine);
 
-			if (!result.empty())
-			{
-				oss << "Failed to read lines from target '"
-					<< target << "'! Reason: '" << result;
+		size_t expected = lineEnd - lineStart;
+		if (lines.size() != expected)
+		{
+			oss << "Failed to read lines!"
+				<< " Expected size was '" << expected << "' lines but result was '" << lines.size() << "' lines.";
 
-				return oss.str();
-			}
+			return oss.str();
+		}
 
-			if (lineEnd == 0) lineEnd = totalLines;
+		//successfully got data
+		outLines = move(lines);
 
-			if (lineEnd <= lineStart)
-			{
-				oss << "Failed to read lines from target '"
-					<< target << "' because lineEnd '"
-					<< lineEnd << "' is lower or equal to lineStart '" << lineStart << "'!";
+		return{};
+	}
 
-				return oss.str();
-			}
-			if (lineStart >= lineEnd)
-			{
-				oss << "Failed to read lines from target '"
-					<< target << "' because lineStart '"
-					<< lineStart << "' is higher or equal to lineEnd '" << lineEnd << "'!";
+	//Read all lines from a file into a vector of strings with optional 
+	//lineStart and lineEnd values to avoid placing all lines to memory.
+	//Only the requested lines are copied, the rest are skipped over in the mapped file.
+	//If lineEnd is 0 and lineStart isnt, then this function defaults end to EOF.
+	//With useLineIndex the window is found through the line index sidecar of the file,
+	//which pays off when the same large file is paged through many times
+	inline string ReadLinesFromFile(
+		const FileInfo& info,
+		vector<string>& outLines,
+		size_t lineStart = 0,
+		size_t lineEnd = 0,
+		bool useLineIndex = false)
+	{
+		const path& target = info.target;
+		ostringstream oss{};
+		vector<string> allLines{};
 
-				return oss.str();
-			}
-			if (lineStart >= totalLines)
-			{
-				oss << "Failed to read lines from target '"
-					<< target << "' because lineStart '"
-					<< lineStart << "' is higher or equal to totalLines '" << totalLines << "'!";
+		if (!info.exists)
+		{
+			oss << "Failed to read lines from target '" << target << "' because it does not exist!";
 
-				return oss.str();
-			}
-			if (lineEnd > totalLines)
+			return oss.str();
+		}
+		if (!info.isRegularFile)
+		{
+			oss << "Failed to read lines from target '" << target << "' because it is not a regular file!";
+
+			return oss.str();
+		}
+		
+		if (!info.canRead)
+		{
+			oss << "Failed to read lines from target '" << target << "' because of insufficient read permissions!";
+
+			return oss.str();
+		}
+
+		try
+		{
+			MappedFile file{};
+			string result = file.Open(target);
+
+			if (!result.empty())
 			{
-				oss << "Failed to read lines from target '"
-					<< target << "' because lineEnd '"
-					<< lineEnd << "' is higher than totalLines '" << totalLines << "'!";
+				oss << "Failed to read lines from target '" << target << "'! Reason: " << result;
 
 				return oss.str();
 			}
 
-			string line{};
-			size_t currentLine{};
-			while (getline(in, line))
+			LineIndex index{};
+			if (useLineIndex)
 			{
-				if (currentLine >= lineStart
-					&& currentLine < lineEnd)
+				result = GetLineIndex(target, file, index);
+
+				if (!result.empty())
 				{
-					allLines.push_back(line);
-				}
-				++currentLine;
+					oss << "Failed to read lines from target '" << target << "'! Reason: " << result;
 
-				if (currentLine >= lineEnd) break;
+					return oss.str();
+				}
 			}
 
-			in.close();
+			vector<string_view> lines{};
+			result = ReadLinesFromFile(
+				file,
+				lines,
+				lineStart,
+				lineEnd,
+				useLineIndex ? &index : nullptr);
 
-			size_t expected = lineEnd - lineStart;
-			if (allLines.size() != expected)
+			if (!result.empty())
 			{
-				oss << "Failed to read lines from target '" << target << "'!"
-					<< " Expected size was '" << expected << "' lines but result was '" << allLines.size() << "' lines.";
+				oss << "Failed to read lines from target '" << target << "'! Reason: " << result;
 
 				return oss.str();
 			}
 
+			allLines.reserve(lines.size());
+			for (string_view line : lines) allLines.emplace_back(line);
+
 			//successfully got data
 			outLines = move(allLines);
 		}
@@ -1370,6 +2089,25 @@ namespace KalaHeaders::KalaFile
 		return{};
 	}
 
+	inline string ReadLinesFromFile(
+		const path& target,
+		vector<string>& outLines,
+		size_t lineStart = 0,
+		size_t lineEnd = 0,
+		bool useLineIndex = false)
+	{
+		FileInfo info{};
+		string result = GetFileInfo(target, info);
+		if (!result.empty()) return result;
+
+		return ReadLinesFromFile(
+			info,
+			outLines,
+			lineStart,
+			lineEnd,
+			useLineIndex);
+	}
+
 	//
 	// BINARY I/O
 	//
@@ -1399,8 +2137,12 @@ namespace KalaHeaders::KalaFile
 	{
 		ostringstream oss{};
 
-		if (exists(target)
-			&& !is_regular_file(target))
+		FileInfo info{};
+		string infoResult = GetFileInfo(target, info);
+		if (!infoResult.empty()) return infoResult;
+
+		if (info.exists
+			&& !info.isRegularFile)
 		{
 			oss << "Failed to write binary to target '" << target << "' because it is not a regular file!";
 
@@ -1413,16 +2155,8 @@ namespace KalaHeaders::KalaFile
 			return oss.str();
 		}
 		
-		auto fileStatus = status(target);
-		auto filePerms = fileStatus.permissions();
-		
-		bool canWrite = (filePerms & (
-			perms::owner_write
-			| perms::group_write
-			| perms::others_write))  
-			!= perms::none;
-		
-		if (!canWrite)
+		if (info.exists
+			&& !info.canWrite)
 		{
 			oss << "Failed to write binary lines to target '" << target << "' because of insufficient write permissions!";
 
@@ -1501,37 +2235,29 @@ namespace KalaHeaders::KalaFile
 	//rangeStart and rangeEnd values to avoid placing whole binary file to memory.
 	//If rangeEnd is 0 and rangeStart isnt, then this function defaults end to EOF
 	inline string ReadBinaryLinesFromFile(
-		const path& target,
+		const FileInfo& info,
 		vector<uint8_t>& outData,
 		size_t rangeStart = 0,
 		size_t rangeEnd = 0)
 	{
+		const path& target = info.target;
 		ostringstream oss{};
 		vector<uint8_t> allData{};
 
-		if (!exists(target))
+		if (!info.exists)
 		{
 			oss << "Failed to read binary from target '" << target << "' because it does not exist!";
 
 			return oss.str();
 		}
-		if (!is_regular_file(target))
+		if (!info.isRegularFile)
 		{
 			oss << "Failed to read binary from target '" << target << "' because it is not a regular file!";
 
 			return oss.str();
 		}
 		
-		auto fileStatus = status(target);
-		auto filePerms = fileStatus.permissions();
-		
-		bool canRead = (filePerms & (
-			perms::owner_read
-			| perms::group_read
-			| perms::others_read))  
-			!= perms::none;
-		
-		if (!canRead)
+		if (!info.canRead)
 		{
 			oss << "Failed to read binary lines from target '" << target << "' because of insufficient read permissions!";
 
@@ -1540,114 +2266,53 @@ namespace KalaHeaders::KalaFile
 
 		try
 		{
-			ifstream in(
-				target,
-				ios::in
-				| ios::binary);
+			MappedFile file{};
+			string result = file.Open(target);
 
-			if (in.fail()
-				&& errno != 0)
+			if (!result.empty())
 			{
-				int err = errno;
-				char buf[256]{};
-
-				oss << "Failed to read binary lines from target '" << target
-					<< "' because it couldn't be opened! "
-					<< "Reason: (errno " << err << "): ";
-
-				if (strerror_s(buf, sizeof(buf), err) == 0) oss << buf;
-				else oss << " Unknown error";
+				oss << "Failed to read binary lines from target '" << target << "'! Reason: " << result;
 
 				return oss.str();
 			}
 
-			in.seekg(0, ios::end);
-			size_t fileSize = scast<size_t>(in.tellg());
+			size_t fileSize = file.GetSize();
 
 			if (fileSize == 0)
 			{
-				in.close();
-
 				oss << "Failed to read binary lines from target '" << target << "' because it had no data!";
 
 				return oss.str();
 			}
 
-			if (rangeEnd == 0) rangeEnd = fileSize;
-
-			if (rangeEnd <= rangeStart)
-			{
-				in.close();
-
-				oss << "Failed to read binary lines from target '" << target << "' because rangeEnd '"
-					<< rangeEnd << "' is lower or equal to rangeStart '" << rangeStart << "'!";
-
-				return oss.str();
-			}
-			if (rangeStart >= rangeEnd)
-			{
-				in.close();
-
-				oss << "Failed to read binary lines from target '" << target << "' because rangeStart '"
-					<< rangeStart << "' is higher or equal to rangeEnd '" << rangeEnd << "'!";
-
-				return oss.str();
-			}
-			if (rangeStart >= fileSize)
-			{
-				in.close();
-
-				oss << "Failed to read binary lines from target '" << target << "' because rangeStart '"
-					<< rangeStart << "' is higher or equal to file size '" << fileSize << "'!";
-
-				return oss.str();
-			}
-			if (rangeEnd > fileSize)
-			{
-				in.close();
-
-				oss << "Failed to read binary lines from target '" << target << "' because rangeEnd '"
-					<< rangeEnd << "' is higher than file size '" << fileSize << "'!";
-
-				return oss.str();
-			}
-
-			size_t readSize = rangeEnd - rangeStart;
-			allData.resize(readSize);
-
-			in.seekg(scast<streamoff>(rangeStart), ios::beg);
-			in.read(
-				rcast<char*>(allData.data()),
-				scast<streamsize>(readSize));
-
-			if (in.fail()
-				&& errno != 0)
-			{
-				int err = errno;
-				char buf[256]{};
-
-				oss << "Failed to read binary lines from target '" << target
-					<< "' because it couldn't be opened! "
-					<< "Reason: (errno " << err << "): ";
-
-				if (strerror_s(buf, sizeof(buf), err) == 0) oss << buf;
-				else oss << " Unknown error";
-
-				return oss.str();
-			}
-
-			size_t bytesRead = scast<size_t>(in.gcount());
+			if (rangeEnd == 0) rangeEnd = fileSize;
+
+			if (rangeEnd <= rangeStart)
+			{
+				oss << "Failed to read binary lines from target '" << target << "' because rangeEnd '"
+					<< rangeEnd << "' is lower or equal to rangeStart '" << rangeStart << "'!";
 
-			in.close();
+				return oss.str();
+			}
+			if (rangeStart >= fileSize)
+			{
+				oss << "Failed to read binary lines from target '" << target << "' because rangeStart '"
+					<< rangeStart << "' is higher or equal to file size '" << fileSize << "'!";
 
-			if (bytesRead != readSize)
+				return oss.str();
+			}
+			if (rangeEnd > fileSize)
 			{
-				oss << "Failed to read binary lines from target '" << target << "'!"
-					<< " Expected size was '" << readSize << "' bytes but result was '" << bytesRead << "' bytes.";
+				oss << "Failed to read binary lines from target '" << target << "' because rangeEnd '"
+					<< rangeEnd << "' is higher than file size '" << fileSize << "'!";
 
 				return oss.str();
 			}
 
+			//only the requested range is copied out of the mapping
+			span<const uint8_t> range = file.GetBytes().subspan(rangeStart, rangeEnd - rangeStart);
+			allData.assign(range.begin(), range.end());
+
 			//successfully got data
 			outData = move(allData);
 		}
@@ -1660,6 +2325,23 @@ namespace KalaHeaders::KalaFile
 
 		return{};
 	}
+
+	inline string ReadBinaryLinesFromFile(
+		const path& target,
+		vector<uint8_t>& outData,
+		size_t rangeStart = 0,
+		size_t rangeEnd = 0)
+	{
+		FileInfo info{};
+		string result = GetFileInfo(target, info);
+		if (!result.empty()) return result;
+
+		return ReadBinaryLinesFromFile(
+			info,
+			outData,
+			rangeStart,
+			rangeEnd);
+	}
 	
 	inline void WriteFixedString(
 		vector<u8>& data,
@@ -1699,6 +2381,32 @@ namespace KalaHeaders::KalaFile
 			else data[offset + i] = 0; //null-pad remaining bytes
 		}
 	}
+	//Same as above for text that isn't null-terminated, like a view into a larger string
+	inline void WriteFixedString(
+		vector<u8>& data,
+		size_t offset,
+		string_view str,
+		size_t length)
+	{
+		const size_t safeLen = min(str.size(), length);
+
+		//append data to the end of the file
+		if (offset == scast<size_t>(-1))
+		{
+			data.insert(data.end(), str.begin(), str.begin() + safeLen);
+			data.resize(data.size() + (length - safeLen)); //null-pad remaining bytes
+			return;
+		}
+
+		//write at target offset, rewrite if needed
+		if (offset + length > data.size())
+		{
+			data.resize(offset + length);
+		}
+
+		memcpy(data.data() + offset, str.data(), safeLen);
+		memset(data.data() + offset + safeLen, 0, length - safeLen); //null-pad remaining bytes
+	}
 	inline string ReadFixedString(
 		const vector<u8>& data,
 		size_t offset,
@@ -1808,6 +2516,35 @@ namespace KalaHeaders::KalaFile
 			| scast<u32>(data[offset + 2]) << 16
 			| scast<u32>(data[offset + 3]) << 24;
 	}
+
+	inline void WriteU64(
+		vector<u8>& data,
+		size_t offset,
+		u64 value)
+	{
+		//append data to the end of the file
+		if (offset == scast<size_t>(-1))
+		{
+			for (size_t i = 0; i < 8; ++i) data.push_back(scast<u8>((value >> (i * 8)) & 0xFF));
+			return;
+		}
+		
+		//write at target offset, auto-resize if needed
+		if (offset + 7 >= data.size()) data.resize(offset + 8);
+		
+		for (size_t i = 0; i < 8; ++i) data[offset + i] = scast<u8>((value >> (i * 8)) & 0xFF);
+	}
+	inline u64 ReadU64(
+		const vector<u8>& data,
+		size_t offset)
+	{
+		if (offset + 7 >= data.size()) return 0;
+
+		u64 value{};
+		for (size_t i = 0; i < 8; ++i) value |= scast<u64>(data[offset + i]) << (i * 8);
+
+		return value;
+	}
 	
 	inline void WriteI8(
 		vector<u8>& data,
@@ -1904,220 +2641,284 @@ namespace KalaHeaders::KalaFile
 		return scast<i32>(value);
 	}
 	
-	//Return all start and end of defined string in a binary
-	inline string GetRangeByValue(
-		const path& target,
-		const string& inData,
-		vector<BinaryRange>& outData)
+	//
+	// LINE INDEX
+	//
+
+	//Sidecar path of the line index of target, the same path with LINE_INDEX_EXTENSION appended
+	inline path GetLineIndexPath(const path& target)
 	{
-		ostringstream oss{};
+		path indexPath = target;
+		indexPath += LINE_INDEX_EXTENSION;
 
-		if (!exists(target))
-		{
-			oss << "Failed to get binary data range from target '" << target << "' because it does not exist!";
+		return indexPath;
+	}
 
-			return oss.str();
-		}
-		if (!is_regular_file(target))
-		{
-			oss << "Failed to get binary data range from target '" << target << "' because it is not a regular file!";
+	//Build the line index of already mapped text, one offset every LINE_INDEX_STRIDE lines
+	inline void BuildLineIndex(
+		string_view text,
+		LineIndex& outIndex)
+	{
+		outIndex.offsets.clear();
+		outIndex.offsets.push_back(0);
 
-			return oss.str();
-		}
-		
-		if (inData.empty())
+		size_t offset{};
+		while (true)
 		{
-			oss << "Failed to get binary data range from target '" << target << "' because input string was empty!";
+			size_t next = offset + FindLineStart(text.substr(offset), LINE_INDEX_STRIDE);
+			if (next >= text.size()) break;
 
-			return oss.str();
+			outIndex.offsets.push_back(scast<u64>(next));
+			offset = next;
 		}
-		
-		auto fileStatus = status(target);
-		auto filePerms = fileStatus.permissions();
-		
-		bool canRead = (filePerms & (
-			perms::owner_read
-			| perms::group_read
-			| perms::others_read))  
-			!= perms::none;
-		
-		if (!canRead)
+
+		//every stride before the last offset is full, only the remainder has to be counted
+		outIndex.lineCount =
+			scast<u64>(outIndex.offsets.size() - 1) * LINE_INDEX_STRIDE
+			+ CountTextLines(text.substr(offset));
+	}
+
+	inline string GetLineIndex(
+		const path& target,
+		const MappedFile& file,
+		LineIndex& outIndex)
+	{
+		ostringstream oss{};
+
+		if (!file.IsOpen())
 		{
-			oss << "Failed to get range by value from target '" << target << "' because of insufficient read permissions!";
+			oss << "Failed to get line index of target '" << target << "' because it is not mapped!";
 
 			return oss.str();
 		}
 
-		try
-		{
-			ifstream in(
-				target,
-				ios::binary);
+		//both come from the handle the file was mapped with, target isn't looked up again
+		const u64 fileSize = scast<u64>(file.GetSize());
+		const u64 writeTime = scast<u64>(file.GetLastWrite());
 
-			if (in.fail()
-				&& errno != 0)
+		const path indexPath = GetLineIndexPath(target);
+
+		//reuse the sidecar if it still describes this exact file,
+		//a missing sidecar just fails the read and falls through to the rebuild
+		{
+			vector<u8> data{};
+			if (ReadBinaryLinesFromFile(indexPath, data).empty()
+				&& ReadU32(data, 0) == LINE_INDEX_MAGIC
+				&& ReadU32(data, 4) == LINE_INDEX_VERSION
+				&& ReadU32(data, 8) == LINE_INDEX_STRIDE
+				&& ReadU64(data, 12) == fileSize
+				&& ReadU64(data, 20) == writeTime)
 			{
-				int err = errno;
-				char buf[256]{};
+				const u64 lineCount = ReadU64(data, 28);
+				const u64 offsetCount = ReadU64(data, 36);
 
-				oss << "Failed to get ragge by value from target '" << target
-					<< "' because it couldn't be opened! "
-					<< "Reason: (errno " << err << "): ";
+				if (offsetCount > 0
+					&& data.size() == LINE_INDEX_HEADER_SIZE + offsetCount * 8)
+				{
+					outIndex.lineCount = lineCount;
+					outIndex.offsets.resize(scast<size_t>(offsetCount));
 
-				if (strerror_s(buf, sizeof(buf), err) == 0) oss << buf;
-				else oss << " Unknown error";
+					for (size_t i = 0; i < outIndex.offsets.size(); ++i)
+					{
+						outIndex.offsets[i] = ReadU64(data, LINE_INDEX_HEADER_SIZE + i * 8);
+					}
 
-				return oss.str();
+					return{};
+				}
 			}
+		}
 
-			size_t fileSize{};
-			string result = GetFileSize(
-				target,
-				fileSize);
-
-			if (!result.empty())
-			{
-				ostringstream oss{};
-				oss << "Failed to get range by value for target '" << target
-					<< "'! Reason: " << result;
+		BuildLineIndex(file.GetText(), outIndex);
 
-				return oss.str();
-			}
+		vector<u8> data{};
+		data.reserve(LINE_INDEX_HEADER_SIZE + outIndex.offsets.size() * 8);
 
-			if (fileSize == 0)
-			{
-				ostringstream oss{};
-				oss << "Failed to get range by value for target '" << target
-					<< "' because target file is empty!";
+		WriteU32(data, scast<size_t>(-1), LINE_INDEX_MAGIC);
+		WriteU32(data, scast<size_t>(-1), LINE_INDEX_VERSION);
+		WriteU32(data, scast<size_t>(-1), LINE_INDEX_STRIDE);
+		WriteU64(data, scast<size_t>(-1), fileSize);
+		WriteU64(data, scast<size_t>(-1), writeTime);
+		WriteU64(data, scast<size_t>(-1), outIndex.lineCount);
+		WriteU64(data, scast<size_t>(-1), scast<u64>(outIndex.offsets.size()));
+		for (u64 offset : outIndex.offsets) WriteU64(data, scast<size_t>(-1), offset);
 
-				return oss.str();
-			}
+		//the index is still usable for this call if the folder is read-only, it is just rebuilt next time
+		WriteBinaryLinesToFile(indexPath, data);
 
-			size_t patternSize = inData.size();
-			if (patternSize == 0)
-			{
-				ostringstream oss{};
-				oss << "Failed to get range by value for target '" << target
-					<< "' because input pattern is empty!";
+		return{};
+	}
 
-				return oss.str();
-			}
+	//
+	// BINARY SEARCH
+	//
 
-			size_t chunkSize = GetBinaryChunkStreamSize(fileSize);
+	//Every match of every pattern in one pass over the data, based on Aho-Corasick.
+	//Data can be fed in any amount of pieces because the match state carries over between them
+	class BytePatternMatcher
+	{
+	public:
+		//Empty patterns are ignored
+		explicit BytePatternMatcher(const vector<vector<uint8_t>>& inPatterns)
+		{
+			patternSizes.reserve(inPatterns.size());
+			for (const auto& p : inPatterns) patternSizes.push_back(p.size());
 
-			vector<uint8_t> buffer(chunkSize + patternSize - 1);
-			size_t offset{};
-			bool firstRead = true;
+			//root state
+			transitions.emplace_back();
+			transitions[0].fill(NO_STATE);
+			outputs.emplace_back();
 
-			while (in)
+			//trie of all patterns
+			for (size_t i = 0; i < inPatterns.size(); ++i)
 			{
-				size_t preserve{};
-
-				if (!firstRead)
+				u32 state{};
+				for (uint8_t b : inPatterns[i])
 				{
-					preserve = patternSize > 1 ? patternSize - 1 : 0;
-					memmove(
-						buffer.data(),
-						buffer.data() + chunkSize,
-						preserve);
-					offset -= preserve;
+					if (transitions[state][b] == NO_STATE)
+					{
+						transitions[state][b] = scast<u32>(transitions.size());
+						transitions.emplace_back();
+						transitions.back().fill(NO_STATE);
+						outputs.emplace_back();
+					}
+					state = transitions[state][b];
 				}
+				if (!inPatterns[i].empty()) outputs[state].push_back(scast<u32>(i));
+			}
 
-				in.read(rcast<char*>(buffer.data() + preserve), chunkSize);
+			//breadth-first pass turns the trie into a full transition table, so feeding
+			//never has to follow failure links, and merges the outputs of every failure state
+			vector<u32> failure(transitions.size(), 0);
+			vector<u32> queue{};
+			queue.reserve(transitions.size());
 
-				if (in.fail()
-					&& errno != 0)
-				{
-					int err = errno;
-					char buf[256]{};
+			for (size_t b = 0; b < 256; ++b)
+			{
+				u32& next = transitions[0][b];
+				if (next == NO_STATE) next = 0;
+				else queue.push_back(next);
+			}
 
-					oss << "Failed to get range by value from target '" << target
-						<< "' because it couldn't be opened! "
-						<< "Reason: (errno " << err << "): ";
+			for (size_t q = 0; q < queue.size(); ++q)
+			{
+				const u32 state = queue[q];
 
-					if (strerror_s(buf, sizeof(buf), err) == 0) oss << buf;
-					else oss << " Unknown error";
+				const auto& inherited = outputs[failure[state]];
+				outputs[state].insert(outputs[state].end(), inherited.begin(), inherited.end());
 
-					return oss.str();
+				for (size_t b = 0; b < 256; ++b)
+				{
+					u32& next = transitions[state][b];
+					const u32 fallback = transitions[failure[state]][b];
+
+					if (next == NO_STATE) next = fallback;
+					else
+					{
+						failure[next] = fallback;
+						queue.push_back(next);
+					}
 				}
+			}
 
-				size_t bytesRead = scast<size_t>(in.gcount());
+			//a single distinct first byte lets the root state skip ahead with memchr
+			for (size_t b = 0; b < 256; ++b)
+			{
+				if (transitions[0][b] == 0) continue;
 
-				if (bytesRead == 0) break;
+				if (firstByteCount++ == 0) firstByte = scast<uint8_t>(b);
+			}
+		}
 
-				size_t totalBytes = bytesRead + preserve;
+		//Feeds the next piece of data, onMatch(patternIndex, start, end) is called for every match
+		//with start and end as offsets from the first byte fed since construction or Reset
+		template <typename F>
+		void Feed(
+			const uint8_t* data,
+			size_t size,
+			F&& onMatch)
+		{
+			const uint8_t* p = data;
+			const uint8_t* endPtr = data + size;
 
-				auto first = buffer.begin();
-				while (true)
+			while (p < endPtr)
+			{
+				if (state == 0
+					&& firstByteCount == 1)
 				{
-					auto it = search(
-						first,
-						buffer.begin() + totalBytes,
-						inData.begin(),
-						inData.end());
+					const void* found = memchr(p, firstByte, scast<size_t>(endPtr - p));
+					if (!found) break;
 
-					if (it == buffer.begin() + totalBytes) break;
+					p = scast<const uint8_t*>(found);
+				}
 
-					size_t start = offset + scast<size_t>(distance(buffer.begin(), it));
-					size_t end = start + inData.size();
+				state = transitions[state][*p++];
 
-					outData.push_back({ start, end });
+				if (outputs[state].empty()) continue;
 
-					first = it + inData.size();
+				const size_t end = consumed + scast<size_t>(p - data);
+				for (u32 index : outputs[state])
+				{
+					onMatch(scast<size_t>(index), end - patternSizes[index], end);
 				}
-
-				offset += bytesRead;
-				firstRead = false;
 			}
+
+			consumed += size;
 		}
-		catch (exception& e)
-		{
-			oss << "Failed to get binary data range from target '" << target << "'! Reason: " << e.what();
 
-			return oss.str();
+		//Starts over as if no data was fed yet
+		void Reset()
+		{
+			state = 0;
+			consumed = 0;
 		}
+	private:
+		static constexpr u32 NO_STATE = UINT32_MAX;
 
-		return{};
-	}
+		vector<array<u32, 256>> transitions{};
+		vector<vector<u32>> outputs{}; //pattern indexes that end at each state
+		vector<size_t> patternSizes{};
 
-	//Return all start and end of defined bytes in a binary
-	inline string GetRangeByValue(
-		const path& target,
-		const vector<uint8_t>& inData,
-		vector<BinaryRange>& outData)
+		size_t firstByteCount{};
+		uint8_t firstByte{};
+
+		u32 state{};
+		size_t consumed{};
+	};
+
+	//Return every start and end of every pattern in a binary, mapped and searched in a single pass
+	//no matter how many patterns are passed. Overlapping matches are all returned in order of their end offset
+	inline string GetRangesByValues(
+		const FileInfo& info,
+		const vector<vector<uint8_t>>& inPatterns,
+		vector<PatternRange>& outData)
 	{
+		const path& target = info.target;
 		ostringstream oss{};
 
-		if (!exists(target))
+		if (!info.exists)
 		{
 			oss << "Failed to get binary data range from target '" << target << "' because it does not exist!";
 
 			return oss.str();
 		}
-		if (!is_regular_file(target))
+		if (!info.isRegularFile)
 		{
 			oss << "Failed to get binary data range from target '" << target << "' because it is not a regular file!";
 
 			return oss.str();
 		}
-		
-		if (inData.empty())
+
+		bool hasPattern{};
+		for (const auto& p : inPatterns) if (!p.empty()) hasPattern = true;
+
+		if (!hasPattern)
 		{
-			oss << "Failed to get binary data range from target '" << target << "' because input vector was empty!";
+			oss << "Failed to get binary data range from target '" << target << "' because no non-empty pattern was passed!";
 
 			return oss.str();
 		}
 		
-		auto fileStatus = status(target);
-		auto filePerms = fileStatus.permissions();
-		
-		bool canRead = (filePerms & (
-			perms::owner_read
-			| perms::group_read
-			| perms::others_read))  
-			!= perms::none;
-		
-		if (!canRead)
+		if (!info.canRead)
 		{
 			oss << "Failed to get range by value from target '" << target << "' because of insufficient read permissions!";
 
@@ -2126,133 +2927,118 @@ namespace KalaHeaders::KalaFile
 
 		try
 		{
-			ifstream in(
-				target,
-				ios::binary);
-
-			if (in.fail()
-				&& errno != 0)
-			{
-				int err = errno;
-				char buf[256]{};
-
-				oss << "Failed to get range by value from target '" << target
-					<< "' because it couldn't be opened! "
-					<< "Reason: (errno " << err << "): ";
-
-				if (strerror_s(buf, sizeof(buf), err) == 0) oss << buf;
-				else oss << " Unknown error";
-
-				return oss.str();
-			}
-
-			size_t fileSize{};
-			string result = GetFileSize(
-				target, 
-				fileSize);
+			MappedFile file{};
+			string result = file.Open(target);
 
 			if (!result.empty())
 			{
-				ostringstream oss{};
 				oss << "Failed to get range by value for target '" << target
 					<< "'! Reason: " << result;
 
 				return oss.str();
 			}
 
-			if (fileSize == 0)
+			if (file.GetSize() == 0)
 			{
-				ostringstream oss{};
 				oss << "Failed to get range by value for target '" << target
 					<< "' because target file is empty!";
 
 				return oss.str();
 			}
 
-			size_t patternSize = inData.size();
-			if (patternSize == 0)
-			{
-				ostringstream oss{};
-				oss << "Failed to get range by value for target '" << target
-					<< "' because input pattern is empty!";
-
-				return oss.str();
-			}
-
-			size_t chunkSize = GetBinaryChunkStreamSize(fileSize);
-
-			vector<uint8_t> buffer(chunkSize + patternSize - 1);
-			size_t offset{};
-			bool firstRead = true;
-
-			while (in)
-			{
-				size_t preserve{};
-
-				if (!firstRead)
-				{
-					preserve = patternSize > 1 ? patternSize - 1 : 0;
-					memmove(
-						buffer.data(),
-						buffer.data() + chunkSize,
-						preserve);
-					offset -= preserve;
-				}
-
-				in.read(rcast<char*>(buffer.data() + preserve), chunkSize);
+			//the whole mapping is searched in one pass without a read buffer
+			BytePatternMatcher matcher(inPatterns);
+			span<const uint8_t> bytes = file.GetBytes();
 
-				if (in.fail()
-					&& errno != 0)
+			matcher.Feed(
+				bytes.data(),
+				bytes.size(),
+				[&outData](size_t patternIndex, size_t start, size_t end)
 				{
-					int err = errno;
-					char buf[256]{};
-
-					oss << "Failed to get range by value from target '" << target
-						<< "' because it couldn't be opened! "
-						<< "Reason: (errno " << err << "): ";
+					outData.push_back({ patternIndex, { start, end } });
+				});
+		}
+		catch (exception& e)
+		{
+			oss << "Failed to get binary data range from target '" << target << "'! Reason: " << e.what();
 
-					if (strerror_s(buf, sizeof(buf), err) == 0) oss << buf;
-					else oss << " Unknown error";
+			return oss.str();
+		}
 
-					return oss.str();
-				}
+		return{};
+	}
 
-				size_t bytesRead = scast<size_t>(in.gcount());
+	inline string GetRangesByValues(
+		const path& target,
+		const vector<vector<uint8_t>>& inPatterns,
+		vector<PatternRange>& outData)
+	{
+		FileInfo info{};
+		string result = GetFileInfo(target, info);
+		if (!result.empty()) return result;
+
+		return GetRangesByValues(
+			info,
+			inPatterns,
+			outData);
+	}
 
-				if (bytesRead == 0) break;
+	//Return all start and end of defined bytes in a binary, matches never overlap
+	inline string GetRangeByValue(
+		const path& target,
+		const vector<uint8_t>& inData,
+		vector<BinaryRange>& outData)
+	{
+		if (inData.empty())
+		{
+			ostringstream oss{};
+			oss << "Failed to get binary data range from target '" << target << "' because input vector was empty!";
 
-				size_t totalBytes = bytesRead + preserve;
+			return oss.str();
+		}
 
-				auto first = buffer.begin();
-				while (true)
-				{
-					auto it = search(
-						first,
-						buffer.begin() + totalBytes,
-						inData.begin(),
-						inData.end());
+		vector<PatternRange> matches{};
+		string result = GetRangesByValues(
+			target,
+			{ inData },
+			matches);
 
-					if (it == buffer.begin() + totalBytes) break;
+		if (!result.empty()) return result;
 
-					size_t start = offset + scast<size_t>(distance(buffer.begin(), it));
-					size_t end = start + inData.size();
+		//the search reports overlapping matches, keep the first of every overlapping run
+		size_t lastEnd{};
+		for (const auto& m : matches)
+		{
+			if (!outData.empty()
+				&& m.range.start < lastEnd)
+			{
+				continue;
+			}
 
-					outData.push_back({ start, end });
+			outData.push_back(m.range);
+			lastEnd = m.range.end;
+		}
 
-					first = it + inData.size();
-				}
+		return{};
+	}
 
-				offset += bytesRead;
-				firstRead = false;
-			}
-		}
-		catch (exception& e)
+	//Return all start and end of defined string in a binary, matches never overlap
+	inline string GetRangeByValue(
+		const path& target,
+		const string& inData,
+		vector<BinaryRange>& outData)
+	{
+		if (inData.empty())
 		{
-			oss << "Failed to get binary data range from target '" << target << "'! Reason: " << e.what();
+			ostringstream oss{};
+			oss << "Failed to get binary data range from target '" << target << "' because input string was empty!";
 
 			return oss.str();
 		}
 
-		return{};
+		return GetRangeByValue(
+			target,
+			vector<uint8_t>(inData.begin(), inData.end()),
+			outData);
 	}
-}
\ No newline at end of file
+}
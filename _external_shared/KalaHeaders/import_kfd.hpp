@@ -8,6 +8,7 @@
 //
 // Provides:
 //   - Helpers for streaming individual font glyphs or loading the full kalafontdata binary into memory
+//   - Arena import that reads the file once and points every glyph into it, with optional lazy glyph decoding
 //------------------------------------------------------------------------------
 
 /*------------------------------------------------------------------------------
@@ -73,6 +74,10 @@ Offset | Size | Field
 #include <string>
 #include <fstream>
 #include <filesystem>
+#include <span>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
 
 //reinterpret_cast
 #ifndef rcast
@@ -101,6 +106,9 @@ namespace KalaHeaders::KalaFontData
 	using std::streamsize;
 	using std::ios;
 	using std::move;
+	using std::span;
+	using std::sort;
+	using std::lower_bound;
 	
 	using u8 = uint8_t;
 	using u16 = uint16_t;
@@ -191,6 +199,31 @@ namespace KalaHeaders::KalaFontData
 		vector<u8> rawPixels{};             //8-bit raw pixels of this glyph (0 - 255, 0 is transparent, 255 is white)
 	};
 	
+	//A glyph block whose pixels point into the file data of a GlyphArena instead of its own vector
+	struct GlyphView
+	{
+		u32 charCode{};
+		u16 width{};
+		u16 height{};
+		i16 bearingX{};
+		i16 bearingY{};
+		u16 advance{};
+		array<array<i16, 2>, 4> vertices{};
+		span<const u8> rawPixels{};         //8-bit raw pixels of this glyph inside GlyphArena::fileData
+	};
+	
+	//A whole kfd file read with ImportKFDArena. Every GlyphView points into fileData,
+	//so the views stay valid for as long as the arena is alive, also after it is moved
+	struct GlyphArena
+	{
+		GlyphHeader header{};
+		vector<GlyphTable> tables{};
+		vector<u8> fileData{};       //the whole file as it was read
+		vector<GlyphView> glyphs{};  //one per table in table order, only valid where isDecoded is set
+		vector<u8> isDecoded{};      //1 for every glyph that has been decoded
+		vector<u32> sortedTables{};  //table indices sorted by char code for GetGlyph lookups
+	};
+	
 	enum class ImportResult : u8
 	{
 		RESULT_SUCCESS                     = 0, //No errors, succeeded with import
@@ -219,7 +252,8 @@ namespace KalaHeaders::KalaFontData
 		RESULT_INVALID_GLYPH_TABLE_SIZE    = 12, //found a glyph table that wasnt the correct size
 		RESULT_INVALID_GLYPH_BLOCK_SIZE    = 13, //found a glyph block that was less or more than the allowed size
 		RESULT_INVALID_GLYPH_COUNT         = 14, //total glyph count was above allowed max glyph count
-		RESULT_UNEXPECTED_EOF              = 15  //file reached end sooner than expected
+		RESULT_UNEXPECTED_EOF              = 15, //file reached end sooner than expected
+		RESULT_GLYPH_NOT_FOUND             = 16  //no table in the file has the requested char code
 	};
 	
 	inline string ResultToString(ImportResult result)
@@ -261,6 +295,8 @@ namespace KalaHeaders::KalaFontData
 			return "RESULT_INVALID_GLYPH_COUNT";
 		case ImportResult::RESULT_UNEXPECTED_EOF:
 			return "RESULT_UNEXPECTED_EOF";
+		case ImportResult::RESULT_GLYPH_NOT_FOUND:
+			return "RESULT_GLYPH_NOT_FOUND";
 		}
 		
 		return "RESULT_UNKNOWN";
@@ -329,6 +365,113 @@ namespace KalaHeaders::KalaFontData
 		}
 	}
 	
+	//Validates and copies the top header out of CORRECT_GLYPH_HEADER_SIZE bytes of kfd data
+	inline ImportResult ParseHeaderData(
+		const u8* headerData,
+		GlyphHeader& outHeader)
+	{
+		GlyphHeader header{};
+		
+		//glyph header
+			
+		memcpy(&header.magic, headerData + 0, sizeof(u32));
+		if (header.magic != KFD_MAGIC) return ImportResult::RESULT_INVALID_MAGIC;
+			
+		memcpy(&header.version, headerData + 4, sizeof(u8));
+		if (header.version != KFD_VERSION) return ImportResult::RESULT_INVALID_VERSION;
+			
+		memcpy(&header.type, headerData + 5,  sizeof(u8));
+		if (header.type != 1
+			&& header.type != 2)
+		{
+			return ImportResult::RESULT_INVALID_TYPE;
+		}
+			
+		memcpy(&header.glyphHeight, headerData + 6,  sizeof(u16));
+		if (header.glyphHeight < MIN_GLYPH_HEIGHT
+			|| header.glyphHeight > MAX_GLYPH_HEIGHT)
+		{
+			return ImportResult::RESULT_INVALID_GLYPH_HEIGHT;
+		}
+			
+		memcpy(&header.glyphCount, headerData + 8,  sizeof(u32));
+		if (header.glyphCount < 1
+			|| header.glyphCount > MAX_GLYPH_COUNT)
+		{
+			return ImportResult::RESULT_INVALID_GLYPH_COUNT;
+		}
+			
+		memcpy(&header.indices[0], headerData + 12, sizeof(u8) * 6);
+		memcpy(&header.uvs[0][0],  headerData + 18, sizeof(u8) * 8);
+
+		memcpy(&header.glyphTableSize, headerData + 26, sizeof(u32));
+		if (header.glyphTableSize < CORRECT_GLYPH_TABLE_SIZE
+			|| header.glyphTableSize > MAX_GLYPH_TABLE_SIZE)
+		{
+			return ImportResult::RESULT_INVALID_GLYPH_TABLE_SIZE;
+		}
+			
+		memcpy(&header.glyphBlockSize, headerData + 30, sizeof(u32));
+		if (header.glyphBlockSize < RAW_PIXEL_DATA_OFFSET
+			|| header.glyphBlockSize > MAX_GLYPH_BLOCK_SIZE)
+		{
+			return ImportResult::RESULT_INVALID_GLYPH_BLOCK_SIZE;
+		}
+		
+		outHeader = header;
+		
+		return ImportResult::RESULT_SUCCESS;
+	}
+	
+	//Reads every full table out of tableSize bytes of kfd table data
+	inline void ParseTableData(
+		const u8* tablesData,
+		size_t tableSize,
+		vector<GlyphTable>& outTables)
+	{
+		vector<GlyphTable> tables{};
+		tables.reserve(tableSize / CORRECT_GLYPH_TABLE_SIZE);
+		
+		for (size_t i = 0; 
+			i + CORRECT_GLYPH_TABLE_SIZE <= tableSize; 
+			i += CORRECT_GLYPH_TABLE_SIZE)
+		{
+			GlyphTable t{};
+			
+			memcpy(&t.charCode,    tablesData + i + 0, sizeof(u32));
+			memcpy(&t.blockOffset, tablesData + i + 4, sizeof(u32));
+			memcpy(&t.blockSize,   tablesData + i + 8, sizeof(u32));
+			
+			tables.push_back(t);
+		}
+		
+		outTables = move(tables);
+	}
+	
+	//Copies the fixed size info at the start of a glyph block into a GlyphBlock or GlyphView,
+	//returns the raw pixel size that is stored right before the pixels
+	template<typename T>
+	inline u32 ReadGlyphInfo(
+		const u8* block,
+		T& outGlyph)
+	{
+		memcpy(&outGlyph.charCode, block + 0,  sizeof(u32));
+		memcpy(&outGlyph.width,    block + 4,  sizeof(u16));
+		memcpy(&outGlyph.height,   block + 6,  sizeof(u16));
+		memcpy(&outGlyph.bearingX, block + 8,  sizeof(i16));
+		memcpy(&outGlyph.bearingY, block + 10, sizeof(i16));
+		memcpy(&outGlyph.advance,  block + 12, sizeof(u16));
+		
+		//vertices
+		memcpy(&outGlyph.vertices, block + 14, sizeof(outGlyph.vertices));
+		
+		//raw pixel size
+		u32 rawPixelSize{};
+		memcpy(&rawPixelSize, block + 30, sizeof(u32));
+		
+		return rawPixelSize;
+	}
+	
 	//Returns header data of the file,
 	//set skipChecks to true if the file has already been checked
 	inline ImportResult GetHeaderData(
@@ -357,57 +500,7 @@ namespace KalaHeaders::KalaFontData
 				
 			in.close();	
 			
-			GlyphHeader header{};
-			
-			//glyph header
-				
-			memcpy(&header.magic, headerData.data() + 0, sizeof(u32));
-			if (header.magic != KFD_MAGIC) return ImportResult::RESULT_INVALID_MAGIC;
-				
-			memcpy(&header.version, headerData.data() + 4, sizeof(u8));
-			if (header.version != KFD_VERSION) return ImportResult::RESULT_INVALID_VERSION;
-				
-			memcpy(&header.type, headerData.data() + 5,  sizeof(u8));
-			if (header.type != 1
-				&& header.type != 2)
-			{
-				return ImportResult::RESULT_INVALID_TYPE;
-			}
-				
-			memcpy(&header.glyphHeight, headerData.data() + 6,  sizeof(u16));
-			if (header.glyphHeight < MIN_GLYPH_HEIGHT
-				|| header.glyphHeight > MAX_GLYPH_HEIGHT)
-			{
-				return ImportResult::RESULT_INVALID_GLYPH_HEIGHT;
-			}
-				
-			memcpy(&header.glyphCount, headerData.data() + 8,  sizeof(u32));
-			if (header.glyphCount < 1
-				|| header.glyphCount > MAX_GLYPH_COUNT)
-			{
-				return ImportResult::RESULT_INVALID_GLYPH_COUNT;
-			}
-				
-			memcpy(&header.indices[0], headerData.data() + 12, sizeof(u8) * 6);
-			memcpy(&header.uvs[0][0],  headerData.data() + 18, sizeof(u8) * 8);
-
-			memcpy(&header.glyphTableSize, headerData.data() + 26, sizeof(u32));
-			if (header.glyphTableSize < CORRECT_GLYPH_TABLE_SIZE
-				|| header.glyphTableSize > MAX_GLYPH_TABLE_SIZE)
-			{
-				return ImportResult::RESULT_INVALID_GLYPH_TABLE_SIZE;
-			}
-				
-			memcpy(&header.glyphBlockSize, headerData.data() + 30, sizeof(u32));
-			if (header.glyphBlockSize < RAW_PIXEL_DATA_OFFSET
-				|| header.glyphBlockSize > MAX_GLYPH_BLOCK_SIZE)
-			{
-				return ImportResult::RESULT_INVALID_GLYPH_BLOCK_SIZE;
-			}
-			
-			outHeader = header;
-			
-			return ImportResult::RESULT_SUCCESS;
+			return ParseHeaderData(headerData.data(), outHeader);
 		}
 		catch (...)
 		{
@@ -456,23 +549,10 @@ namespace KalaHeaders::KalaFontData
 				
 			in.close();	
 			
-			vector<GlyphTable> tables{};
-			tables.reserve(header.glyphCount);
-			
-			for (size_t i = 0; 
-				i < header.glyphTableSize; 
-				i += CORRECT_GLYPH_TABLE_SIZE)
-			{
-				GlyphTable t{};
-				
-				memcpy(&t.charCode,    tablesData.data() + i + 0, sizeof(u32));
-				memcpy(&t.blockOffset, tablesData.data() + i + 4, sizeof(u32));
-				memcpy(&t.blockSize,   tablesData.data() + i + 8, sizeof(u32));
-				
-				tables.push_back(t);
-			}
-			
-			outTables = move(tables);
+			ParseTableData(
+				tablesData.data(),
+				tablesData.size(),
+				outTables);
 			
 			return ImportResult::RESULT_SUCCESS;
 		}
@@ -524,18 +604,13 @@ namespace KalaHeaders::KalaFontData
 				
 				in.seekg(offset);
 				
-				in.read(rcast<char*>(&b.charCode), sizeof(u32));
-				in.read(rcast<char*>(&b.width),    sizeof(u16));
-				in.read(rcast<char*>(&b.height),   sizeof(u16));
-				in.read(rcast<char*>(&b.bearingX), sizeof(i16));
-				in.read(rcast<char*>(&b.bearingY), sizeof(i16));
-				in.read(rcast<char*>(&b.advance),  sizeof(u16));
-				
-				//vertices
-				in.read(rcast<char*>(&b.vertices), sizeof(b.vertices));
+				//all glyph info in one read instead of one per field
+				array<u8, RAW_PIXEL_DATA_OFFSET> info{};
+				in.read(
+					rcast<char*>(info.data()),
+					scast<streamsize>(info.size()));
 				
-				//raw pixel size
-				in.read(rcast<char*>(&b.rawPixelSize), sizeof(u32));
+				b.rawPixelSize = ReadGlyphInfo(info.data(), b);
 				
 				//verify that pixel data is not OOB
 				if (offset + RAW_PIXEL_DATA_OFFSET + b.rawPixelSize > fileSize)
@@ -632,18 +707,7 @@ namespace KalaHeaders::KalaFontData
 					return ImportResult::RESULT_UNEXPECTED_EOF;
 				}
 				
-				memcpy(&b.charCode, blockData.data() + relativeOffset + 0, sizeof(u32));
-				memcpy(&b.width,    blockData.data() + relativeOffset + 4, sizeof(u16));
-				memcpy(&b.height,   blockData.data() + relativeOffset + 6, sizeof(u16));
-				memcpy(&b.bearingX, blockData.data() + relativeOffset + 8, sizeof(i16));
-				memcpy(&b.bearingY, blockData.data() + relativeOffset + 10, sizeof(i16));
-				memcpy(&b.advance,  blockData.data() + relativeOffset + 12, sizeof(u16));
-				
-				//vertices
-				memcpy(&b.vertices, blockData.data() + relativeOffset + 14, sizeof(b.vertices));
-				
-				//raw pixel size
-				memcpy(&b.rawPixelSize, blockData.data() + relativeOffset + 30, sizeof(u32));
+				b.rawPixelSize = ReadGlyphInfo(blockData.data() + relativeOffset, b);
 				
 				//verify that pixel data is not OOB
 				if (relativeOffset + scast<u32>(RAW_PIXEL_DATA_OFFSET) + b.rawPixelSize > blockData.size())
@@ -669,4 +733,198 @@ namespace KalaHeaders::KalaFontData
 			return ImportResult::RESULT_UNKNOWN_READ_ERROR;
 		}
 	}
-}
\ No newline at end of file
+	
+	//Reads the whole kfd file with a single read call, with the same checks as TryOpenCheck
+	inline ImportResult LoadFileData(
+		const path& inFile,
+		vector<u8>& outData)
+	{
+		try
+		{
+			errno = 0;
+			ifstream in(inFile, ios::in | ios::binary);
+			if (in.fail())
+			{
+				if (errno == EBUSY
+					|| errno == ETXTBSY)
+				{
+					return ImportResult::RESULT_FILE_LOCKED;
+				}
+				else return ImportResult::RESULT_UNKNOWN_READ_ERROR;
+			}
+			
+			in.seekg(0, ios::end);
+			size_t fileSize = scast<size_t>(in.tellg());
+			
+			if (fileSize == 0) return ImportResult::RESULT_FILE_EMPTY;
+			if (fileSize < MIN_TOTAL_SIZE
+				|| fileSize > MAX_TOTAL_SIZE)
+			{
+				return ImportResult::RESULT_UNSUPPORTED_FILE_SIZE;
+			}
+			
+			vector<u8> data(fileSize);
+			
+			in.seekg(0);
+			in.read(
+				rcast<char*>(data.data()),
+				scast<streamsize>(fileSize));
+				
+			if (scast<size_t>(in.gcount()) != fileSize) return ImportResult::RESULT_UNEXPECTED_EOF;
+			
+			in.close();
+			
+			outData = move(data);
+			
+			return ImportResult::RESULT_SUCCESS;
+		}
+		catch (...)
+		{
+			return ImportResult::RESULT_UNKNOWN_READ_ERROR;
+		}
+	}
+	
+	//Decodes the glyph block at offset in already loaded kfd data,
+	//the pixels of outGlyph point into fileData instead of being copied
+	inline ImportResult DecodeGlyph(
+		const vector<u8>& fileData,
+		const GlyphTable& inTable,
+		GlyphView& outGlyph)
+	{
+		size_t offset = inTable.blockOffset;
+		
+		//verify that block size is not OOB
+		if (offset + inTable.blockSize > fileData.size()
+			|| offset + RAW_PIXEL_DATA_OFFSET > fileData.size())
+		{
+			return ImportResult::RESULT_UNEXPECTED_EOF;
+		}
+		
+		GlyphView g{};
+		
+		u32 rawPixelSize = ReadGlyphInfo(fileData.data() + offset, g);
+		
+		//verify that pixel data is not OOB
+		if (offset + RAW_PIXEL_DATA_OFFSET + rawPixelSize > fileData.size())
+		{
+			return ImportResult::RESULT_UNEXPECTED_EOF;
+		}
+		
+		g.rawPixels = span<const u8>(
+			fileData.data() + offset + RAW_PIXEL_DATA_OFFSET,
+			rawPixelSize);
+			
+		outGlyph = g;
+		
+		return ImportResult::RESULT_SUCCESS;
+	}
+	
+	//Loads the whole kfd file with one read into outArena, whose glyph pixels all point
+	//into the single loaded file buffer instead of one vector per glyph.
+	//With lazy set to true only the header and tables are read up front
+	//and each glyph is decoded the first time GetGlyph asks for its char code
+	inline ImportResult ImportKFDArena(
+		const path& inFile,
+		GlyphArena& outArena,
+		bool lazy = false)
+	{
+		ImportResult preReadResult = PreReadCheck(inFile);
+		if (preReadResult != ImportResult::RESULT_SUCCESS) return preReadResult;
+		
+		GlyphArena arena{};
+		
+		ImportResult loadResult = LoadFileData(inFile, arena.fileData);
+		if (loadResult != ImportResult::RESULT_SUCCESS) return loadResult;
+		
+		ImportResult headerResult = ParseHeaderData(arena.fileData.data(), arena.header);
+		if (headerResult != ImportResult::RESULT_SUCCESS) return headerResult;
+		
+		if (CORRECT_GLYPH_HEADER_SIZE + arena.header.glyphTableSize > arena.fileData.size())
+		{
+			return ImportResult::RESULT_UNEXPECTED_EOF;
+		}
+		
+		ParseTableData(
+			arena.fileData.data() + CORRECT_GLYPH_HEADER_SIZE,
+			arena.header.glyphTableSize,
+			arena.tables);
+			
+		const size_t count = arena.tables.size();
+		
+		arena.glyphs.resize(count);
+		arena.isDecoded.assign(count, 0);
+		
+		arena.sortedTables.resize(count);
+		for (u32 i = 0; i < count; ++i) arena.sortedTables[i] = i;
+		
+		sort(
+			arena.sortedTables.begin(),
+			arena.sortedTables.end(),
+			[&arena](u32 a, u32 b)
+			{
+				return arena.tables[a].charCode < arena.tables[b].charCode;
+			});
+		
+		if (!lazy)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				ImportResult glyphResult = DecodeGlyph(
+					arena.fileData,
+					arena.tables[i],
+					arena.glyphs[i]);
+					
+				if (glyphResult != ImportResult::RESULT_SUCCESS) return glyphResult;
+				
+				arena.isDecoded[i] = 1;
+			}
+		}
+		
+		//moving the vectors keeps their buffers, so every pixel span stays valid
+		outArena = move(arena);
+		
+		return ImportResult::RESULT_SUCCESS;
+	}
+	
+	//Returns the glyph of charCode from an arena made with ImportKFDArena,
+	//decoding it first if the arena was loaded lazily and it hasn't been asked for yet.
+	//Not safe to call from several threads at once on a lazily loaded arena
+	inline ImportResult GetGlyph(
+		GlyphArena& arena,
+		u32 charCode,
+		const GlyphView*& outGlyph)
+	{
+		auto it = lower_bound(
+			arena.sortedTables.begin(),
+			arena.sortedTables.end(),
+			charCode,
+			[&arena](u32 index, u32 code)
+			{
+				return arena.tables[index].charCode < code;
+			});
+			
+		if (it == arena.sortedTables.end()
+			|| arena.tables[*it].charCode != charCode)
+		{
+			return ImportResult::RESULT_GLYPH_NOT_FOUND;
+		}
+		
+		const u32 index = *it;
+		
+		if (!arena.isDecoded[index])
+		{
+			ImportResult glyphResult = DecodeGlyph(
+				arena.fileData,
+				arena.tables[index],
+				arena.glyphs[index]);
+				
+			if (glyphResult != ImportResult::RESULT_SUCCESS) return glyphResult;
+			
+			arena.isDecoded[index] = 1;
+		}
+		
+		outGlyph = &arena.glyphs[index];
+		
+		return ImportResult::RESULT_SUCCESS;
+	}
+}
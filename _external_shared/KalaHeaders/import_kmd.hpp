@@ -85,6 +85,9 @@ Render type:
 #include <string>
 #include <fstream>
 #include <filesystem>
+#include <functional>
+#include <cstring>
+#include <cerrno>
 
 //reinterpret_cast
 #ifndef rcast
@@ -113,6 +116,7 @@ namespace KalaHeaders::KalaModelData
 	using std::streamsize;
 	using std::ios;
 	using std::move;
+	using std::function;
 	
 	using u8 = uint8_t;
 	using u16 = uint16_t;
@@ -219,6 +223,57 @@ namespace KalaHeaders::KalaModelData
 		vector<u32> indices{};
 	};
 	
+	//Every vertex attribute of a ModelArena in its own tightly packed stream,
+	//ready to be uploaded as separate vertex buffers
+	struct VertexStreams
+	{
+		vector<f32> positions{}; //x, y, z per vertex
+		vector<f32> normals{};   //nx, ny, nz per vertex
+		vector<f32> texCoords{}; //u, v per vertex
+		vector<f32> tangents{};  //tx, ty, tz, tw per vertex
+		vector<u32> indices{};   //indices of each model, relative to the first vertex of that model
+	};
+	
+	//A model block whose vertices and indices are ranges of the VertexStreams of a ModelArena
+	//instead of vectors of its own
+	struct ModelView
+	{
+		char nodeName[20]{};
+		char meshName[20]{};
+		char nodePath[50]{};
+		u8 dataTypeFlags{};
+		u8 renderType{};
+		
+		f32 position[3]{};
+		f32 rotation[4]{};
+		f32 size[3]{};
+		
+		u32 verticesOffset{};
+		u32 verticesSize{};
+		u32 indicesOffset{};
+		u32 indicesSize{};
+		
+		u32 blockOffset{};    //absolute offset of this model block from start of file
+		size_t firstVertex{}; //first vertex of this model in every vertex stream
+		size_t vertexCount{};
+		size_t firstIndex{};  //first index of this model in VertexStreams::indices
+		size_t indexCount{};
+	};
+	
+	//A whole kmd file read with ImportKMDArena, the vertices and indices
+	//of every model are stored back to back in the same streams
+	struct ModelArena
+	{
+		ModelHeader header{};
+		vector<ModelTable> tables{};
+		vector<ModelView> models{};  //one per table in table order
+		VertexStreams streams{};
+	};
+	
+	//Runs job for every index from 0 to count - 1 and returns once all of them are done,
+	//lets ImportKMDArena decode models on threads owned by the caller
+	using ParallelFor = function<void(size_t count, const function<void(size_t index)>& job)>;
+	
 	enum class ImportResult : u8
 	{
 		RESULT_SUCCESS                     = 0, //No errors, succeeded with import
@@ -368,6 +423,141 @@ namespace KalaHeaders::KalaModelData
 		}
 	}
 	
+	//Validates and copies the top header out of CORRECT_MODEL_HEADER_SIZE bytes of kmd data
+	inline ImportResult ParseHeaderData(
+		const u8* headerData,
+		ModelHeader& outHeader)
+	{
+		ModelHeader header{};
+		
+		//model header
+		
+		memcpy(&header.magic, headerData + 0, sizeof(u32));
+		if (header.magic != KMD_MAGIC) return ImportResult::RESULT_INVALID_MAGIC;
+		
+		memcpy(&header.version, headerData + 4, sizeof(u8));
+		if (header.version != KMD_VERSION) return ImportResult::RESULT_INVALID_VERSION;
+		
+		memcpy(&header.scaleFactor, headerData + 5,  sizeof(u8));
+		//clamp to 0 for out of range values
+		if (header.scaleFactor > 8) header.scaleFactor = 0;
+		
+		memcpy(&header.modelCount, headerData + 6,  sizeof(u32));
+		if (header.modelCount > MAX_MODEL_COUNT) return ImportResult::RESULT_INVALID_MODEL_COUNT;
+		
+		memcpy(&header.modelTablesSize, headerData + 10, sizeof(u32));
+		if (header.modelTablesSize < CORRECT_MODEL_TABLE_SIZE
+			|| header.modelTablesSize > MAX_MODEL_TABLE_SIZE)
+		{
+			return ImportResult::RESULT_INVALID_MODEL_TABLE_SIZE;
+		}
+		
+		memcpy(&header.modelBlocksSize, headerData + 14, sizeof(u32));
+		if (header.modelBlocksSize < VERTICE_DATA_OFFSET
+			|| header.modelBlocksSize > MAX_MODEL_BLOCK_SIZE)
+		{
+			return ImportResult::RESULT_INVALID_MODEL_BLOCK_SIZE;
+		}
+		
+		outHeader = header;
+		
+		return ImportResult::RESULT_SUCCESS;
+	}
+	
+	//Reads every full table out of tableSize bytes of kmd table data
+	inline void ParseTableData(
+		const u8* tablesData,
+		size_t tableSize,
+		vector<ModelTable>& outTables)
+	{
+		vector<ModelTable> tables{};
+		tables.reserve(tableSize / CORRECT_MODEL_TABLE_SIZE);
+		
+		for (size_t i = 0;
+			i + CORRECT_MODEL_TABLE_SIZE <= tableSize;
+			i += CORRECT_MODEL_TABLE_SIZE)
+		{
+			ModelTable t{};
+			
+			memcpy(t.nodeName,     tablesData + i + 0,  sizeof(t.nodeName));
+			memcpy(&t.blockOffset, tablesData + i + 20, sizeof(u32));
+			memcpy(&t.blockSize,   tablesData + i + 24, sizeof(u32));
+			
+			tables.push_back(t);
+		}
+		
+		outTables = move(tables);
+	}
+	
+	//Validates and copies the first VERTICE_DATA_OFFSET bytes of a model block
+	//into a ModelBlock or ModelView, leaving its vertices and indices untouched
+	template<typename T>
+	inline ImportResult ParseBlockInfo(
+		const u8* block,
+		T& outModel)
+	{
+		memcpy(outModel.nodeName, block + 0,  sizeof(outModel.nodeName));
+		memcpy(outModel.meshName, block + 20, sizeof(outModel.meshName));
+		memcpy(outModel.nodePath, block + 40, sizeof(outModel.nodePath));
+		
+		//data flags go from 0 to 4
+		memcpy(&outModel.dataTypeFlags, block + 90, sizeof(u8));
+		if (outModel.dataTypeFlags & ~0b00011111) return ImportResult::RESULT_INVALID_DATA_FLAGS;
+		
+		//render type goes from 0 to 2
+		memcpy(&outModel.renderType, block + 91, sizeof(u8));
+		if (outModel.renderType > 2) return ImportResult::RESULT_INVALID_RENDER_TYPE;
+		
+		f32 newPos[3]{};
+		memcpy(newPos, block + 92, sizeof(newPos));
+		
+		for (f32 p : newPos)
+		{
+			if (p < MIN_POS
+				|| p > MAX_POS)
+			{
+				return ImportResult::RESULT_INVALID_MODEL_POSITION;
+			}
+		}
+		
+		memcpy(outModel.position, newPos, sizeof(outModel.position));
+		
+		f32 newRot[4]{};
+		memcpy(newRot, block + 104, sizeof(newRot));
+		
+		for (f32 r : newRot)
+		{
+			if (r < MIN_ROT
+				|| r > MAX_ROT)
+			{
+				return ImportResult::RESULT_INVALID_MODEL_ROTATION;
+			}
+		}
+		
+		memcpy(outModel.rotation, newRot, sizeof(outModel.rotation));
+		
+		f32 newSize[3]{};
+		memcpy(newSize, block + 120, sizeof(newSize));
+		
+		for (f32 s : newSize)
+		{
+			if (s < MIN_SIZE
+				|| s > MAX_SIZE)
+			{
+				return ImportResult::RESULT_INVALID_MODEL_SIZE;
+			}
+		}
+		
+		memcpy(outModel.size, newSize, sizeof(outModel.size));
+		
+		memcpy(&outModel.verticesOffset, block + 132, sizeof(u32));
+		memcpy(&outModel.verticesSize,   block + 136, sizeof(u32));
+		memcpy(&outModel.indicesOffset,  block + 140, sizeof(u32));
+		memcpy(&outModel.indicesSize,    block + 144, sizeof(u32));
+		
+		return ImportResult::RESULT_SUCCESS;
+	}
+	
 	//Returns header data of the file,
 	//set skipChecks to true if the file has already been checked
 	inline ImportResult GetHeaderData(
@@ -379,7 +569,7 @@ namespace KalaHeaders::KalaModelData
 		{
 			ImportResult preReadResult = PreReadCheck(inFile);
 			if (preReadResult != ImportResult::RESULT_SUCCESS) return preReadResult;
-		
+			
 			ImportResult tryOpenResult = TryOpenCheck(inFile);
 			if (tryOpenResult != ImportResult::RESULT_SUCCESS) return tryOpenResult;
 		}
@@ -393,43 +583,10 @@ namespace KalaHeaders::KalaModelData
 			in.read(
 				rcast<char*>(headerData.data()),
 				scast<streamsize>(CORRECT_MODEL_HEADER_SIZE));
-				
-			in.close();	
-			
-			ModelHeader header{};
-			
-			//model header
-			
-			memcpy(&header.magic, headerData.data() + 0, sizeof(u32));
-			if (header.magic != KMD_MAGIC) return ImportResult::RESULT_INVALID_MAGIC;
 			
-			memcpy(&header.version, headerData.data() + 4, sizeof(u8));
-			if (header.version != KMD_VERSION) return ImportResult::RESULT_INVALID_VERSION;
-			
-			memcpy(&header.scaleFactor, headerData.data() + 5,  sizeof(u8));
-			//clamp to 0 for out of range values
-			if (header.scaleFactor > 8) header.scaleFactor = 0;
-			
-			memcpy(&header.modelCount, headerData.data() + 6,  sizeof(u32));
-			if (header.modelCount > MAX_MODEL_COUNT) return ImportResult::RESULT_INVALID_MODEL_COUNT;
-
-			memcpy(&header.modelTablesSize, headerData.data() + 10, sizeof(u32));
-			if (header.modelTablesSize < CORRECT_MODEL_TABLE_SIZE
-				|| header.modelTablesSize > MAX_MODEL_TABLE_SIZE)
-			{
-				return ImportResult::RESULT_INVALID_MODEL_TABLE_SIZE;
-			}
-			
-			memcpy(&header.modelBlocksSize, headerData.data() + 14, sizeof(u32));
-			if (header.modelBlocksSize < VERTICE_DATA_OFFSET
-				|| header.modelBlocksSize > MAX_MODEL_BLOCK_SIZE)
-			{
-				return ImportResult::RESULT_INVALID_MODEL_BLOCK_SIZE;
-			}
-			
-			outHeader = header;
+			in.close();
 			
-			return ImportResult::RESULT_SUCCESS;
+			return ParseHeaderData(headerData.data(), outHeader);
 		}
 		catch (...)
 		{
@@ -454,12 +611,12 @@ namespace KalaHeaders::KalaModelData
 		}
 		
 		ModelHeader header{};
-			
+		
 		ImportResult headerResult = GetHeaderData(
 			inFile,
 			header,
 			true);
-				
+		
 		if (headerResult != ImportResult::RESULT_SUCCESS) return headerResult;
 		
 		ifstream in(inFile, ios::in | ios::binary);
@@ -475,26 +632,13 @@ namespace KalaHeaders::KalaModelData
 			in.read(
 				rcast<char*>(tablesData.data()),
 				scast<streamsize>(header.modelTablesSize));
-				
-			in.close();	
-		
-			vector<ModelTable> tables{};
-			tables.reserve(header.modelCount);
 			
-			for (size_t i = 0; 
-				i < header.modelTablesSize; 
-				i += CORRECT_MODEL_TABLE_SIZE)
-			{
-				ModelTable t{};
-				
-				memcpy(t.nodeName,     tablesData.data() + i + 0, sizeof(t.nodeName));
-				memcpy(&t.blockOffset, tablesData.data() + i + 20, sizeof(u32));
-				memcpy(&t.blockSize,   tablesData.data() + i + 24, sizeof(u32));
-				
-				tables.push_back(t);
-			}
+			in.close();
 			
-			outTables = move(tables);
+			ParseTableData(
+				tablesData.data(),
+				tablesData.size(),
+				outTables);
 			
 			return ImportResult::RESULT_SUCCESS;
 		}
@@ -527,7 +671,7 @@ namespace KalaHeaders::KalaModelData
 			in.seekg(0, ios::end);
 			size_t fileSize = scast<size_t>(in.tellg());
 			
-			//glyph block data
+			//model block data
 			
 			vector<ModelBlock> blocks{};
 			blocks.reserve(inTables.size());
@@ -539,83 +683,22 @@ namespace KalaHeaders::KalaModelData
 				size_t offset = t.blockOffset;
 				
 				//verify that block size is not OOB
-				if (offset + t.blockSize > fileSize)
+				if (offset + t.blockSize > fileSize
+					|| offset + VERTICE_DATA_OFFSET > fileSize)
 				{
 					return ImportResult::RESULT_UNEXPECTED_EOF;
 				}
 				
 				in.seekg(offset);
 				
-				in.read(rcast<char*>(b.nodeName),       20);
-				in.read(rcast<char*>(b.meshName),       20);
-				in.read(rcast<char*>(b.nodePath),       50);
-				
-				//data flags go from 0 to 4
-				in.read(rcast<char*>(&b.dataTypeFlags), sizeof(u8));
-				if (b.dataTypeFlags & ~0b00011111) return ImportResult::RESULT_INVALID_DATA_FLAGS;
-				
-				//render type goes from 0 to 2
-				in.read(rcast<char*>(&b.renderType),    sizeof(u8));
-				if (b.renderType > 2) return ImportResult::RESULT_INVALID_RENDER_TYPE;
-				
-				f32 newPos[3]{};
-				in.read(rcast<char*>(&newPos[0]), sizeof(f32));
-				in.read(rcast<char*>(&newPos[1]), sizeof(f32));
-				in.read(rcast<char*>(&newPos[2]), sizeof(f32));
-				
-				if (newPos[0] < MIN_POS
-					|| newPos[0] > MAX_POS
-					|| newPos[1] < MIN_POS
-					|| newPos[1] > MAX_POS
-					|| newPos[2] < MIN_POS
-					|| newPos[2] > MAX_POS)
-				{
-					return ImportResult::RESULT_INVALID_MODEL_POSITION;
-				}
-				
-				memcpy(b.position, newPos, sizeof(b.position));
+				//all model info in one read instead of one per field
+				array<u8, VERTICE_DATA_OFFSET> info{};
+				in.read(
+					rcast<char*>(info.data()),
+					scast<streamsize>(info.size()));
 				
-				f32 newRot[4]{};
-				in.read(rcast<char*>(&newRot[0]), sizeof(f32));
-				in.read(rcast<char*>(&newRot[1]), sizeof(f32));
-				in.read(rcast<char*>(&newRot[2]), sizeof(f32));
-				in.read(rcast<char*>(&newRot[3]), sizeof(f32));
-				
-				if (newRot[0] < MIN_ROT
-					|| newRot[0] > MAX_ROT
-					|| newRot[1] < MIN_ROT
-					|| newRot[1] > MAX_ROT
-					|| newRot[2] < MIN_ROT
-					|| newRot[2] > MAX_ROT
-					|| newRot[3] < MIN_ROT
-					|| newRot[3] > MAX_ROT)
-				{
-					return ImportResult::RESULT_INVALID_MODEL_ROTATION;
-				}
-				
-				memcpy(b.rotation, newRot, sizeof(b.rotation));
-				
-				f32 newSize[3]{};
-				in.read(rcast<char*>(&newSize[0]), sizeof(f32));
-				in.read(rcast<char*>(&newSize[1]), sizeof(f32));
-				in.read(rcast<char*>(&newSize[2]), sizeof(f32));
-				
-				if (newSize[0] < MIN_SIZE
-					|| newSize[0] > MAX_SIZE
-					|| newSize[1] < MIN_SIZE
-					|| newSize[1] > MAX_SIZE
-					|| newSize[2] < MIN_SIZE
-					|| newSize[2] > MAX_SIZE)
-				{
-					return ImportResult::RESULT_INVALID_MODEL_SIZE;
-				}
-				
-				memcpy(b.size, newSize, sizeof(b.size));
-				
-				in.read(rcast<char*>(&b.verticesOffset), sizeof(u32));
-				in.read(rcast<char*>(&b.verticesSize),   sizeof(u32));
-				in.read(rcast<char*>(&b.indicesOffset),  sizeof(u32));
-				in.read(rcast<char*>(&b.indicesSize),    sizeof(u32));
+				ImportResult infoResult = ParseBlockInfo(info.data(), b);
+				if (infoResult != ImportResult::RESULT_SUCCESS) return infoResult;
 				
 				//verify that vertices are not OOB
 				if (offset + VERTICE_DATA_OFFSET + b.verticesSize > fileSize)
@@ -672,26 +755,26 @@ namespace KalaHeaders::KalaModelData
 		if (tryOpenResult != ImportResult::RESULT_SUCCESS) return tryOpenResult;
 		
 		//header data
-			
+		
 		ModelHeader header{};
-			
+		
 		ImportResult headerResult = GetHeaderData(
 			inFile,
 			header,
 			false);
-			
+		
 		if (headerResult != ImportResult::RESULT_SUCCESS) return headerResult;
-			
+		
 		//model table data
-			
+		
 		vector<ModelTable> tables{};
 		tables.reserve(header.modelCount);
-			
+		
 		ImportResult tableResult = GetTableData(
 			inFile,
 			tables,
 			true);
-			
+		
 		if (tableResult != ImportResult::RESULT_SUCCESS) return tableResult;
 		
 		try
@@ -709,7 +792,7 @@ namespace KalaHeaders::KalaModelData
 			in.read(
 				rcast<char*>(blockData.data()),
 				scast<streamsize>(header.modelBlocksSize));
-				
+			
 			in.close();
 			
 			//model block data
@@ -720,84 +803,23 @@ namespace KalaHeaders::KalaModelData
 			for (const auto& t : tables)
 			{
 				ModelBlock b{};
-				size_t relativeOffset = t.blockOffset - blockRegionStart;
 				
 				//verify that block size is not OOB
-				if (relativeOffset + t.blockSize > blockData.size())
+				if (t.blockOffset < blockRegionStart)
 				{
 					return ImportResult::RESULT_UNEXPECTED_EOF;
 				}
 				
-				memcpy(b.nodeName, blockData.data() + relativeOffset + 0, 20);
-				memcpy(b.meshName, blockData.data() + relativeOffset + 20, 20);
-				memcpy(b.nodePath, blockData.data() + relativeOffset + 40, 50);
-				
-				//data flags go from 0 to 4
-				memcpy(&b.dataTypeFlags, blockData.data() + relativeOffset + 90, sizeof(u8));
-				if (b.dataTypeFlags & ~0b00011111) return ImportResult::RESULT_INVALID_DATA_FLAGS;
-				
-				//render type goes from 0 to 2
-				memcpy(&b.renderType, blockData.data() + relativeOffset + 91, sizeof(u8));
-				if (b.renderType > 2) return ImportResult::RESULT_INVALID_RENDER_TYPE;
-				
-				f32 newPos[3]{};
-				memcpy(&newPos[0], blockData.data() + relativeOffset + 92, sizeof(f32));
-				memcpy(&newPos[1], blockData.data() + relativeOffset + 96, sizeof(f32));
-				memcpy(&newPos[2], blockData.data() + relativeOffset + 100, sizeof(f32));
-				
-				if (newPos[0] < MIN_POS
-					|| newPos[0] > MAX_POS
-					|| newPos[1] < MIN_POS
-					|| newPos[1] > MAX_POS
-					|| newPos[2] < MIN_POS
-					|| newPos[2] > MAX_POS)
-				{
-					return ImportResult::RESULT_INVALID_MODEL_POSITION;
-				}
-				
-				memcpy(b.position, newPos, sizeof(b.position));
-				
-				f32 newRot[4]{};
-				memcpy(&newRot[0], blockData.data() + relativeOffset + 104, sizeof(f32));
-				memcpy(&newRot[1], blockData.data() + relativeOffset + 108, sizeof(f32));
-				memcpy(&newRot[2], blockData.data() + relativeOffset + 112, sizeof(f32));
-				memcpy(&newRot[3], blockData.data() + relativeOffset + 116, sizeof(f32));
-				
-				if (newRot[0] < MIN_ROT
-					|| newRot[0] > MAX_ROT
-					|| newRot[1] < MIN_ROT
-					|| newRot[1] > MAX_ROT
-					|| newRot[2] < MIN_ROT
-					|| newRot[2] > MAX_ROT
-					|| newRot[3] < MIN_ROT
-					|| newRot[3] > MAX_ROT)
-				{
-					return ImportResult::RESULT_INVALID_MODEL_ROTATION;
-				}
-				
-				memcpy(b.rotation, newRot, sizeof(b.rotation));
-				
-				f32 newSize[3]{};
-				memcpy(&newSize[0], blockData.data() + relativeOffset + 120, sizeof(f32));
-				memcpy(&newSize[1], blockData.data() + relativeOffset + 124, sizeof(f32));
-				memcpy(&newSize[2], blockData.data() + relativeOffset + 128, sizeof(f32));
+				size_t relativeOffset = t.blockOffset - blockRegionStart;
 				
-				if (newSize[0] < MIN_SIZE
-					|| newSize[0] > MAX_SIZE
-					|| newSize[1] < MIN_SIZE
-					|| newSize[1] > MAX_SIZE
-					|| newSize[2] < MIN_SIZE
-					|| newSize[2] > MAX_SIZE)
+				if (relativeOffset + t.blockSize > blockData.size()
+					|| relativeOffset + VERTICE_DATA_OFFSET > blockData.size())
 				{
-					return ImportResult::RESULT_INVALID_MODEL_SIZE;
+					return ImportResult::RESULT_UNEXPECTED_EOF;
 				}
 				
-				memcpy(b.size, newSize, sizeof(b.size));
-				
-				memcpy(&b.verticesOffset, blockData.data() + relativeOffset + 132, sizeof(u32));
-				memcpy(&b.verticesSize,   blockData.data() + relativeOffset + 136, sizeof(u32));
-				memcpy(&b.indicesOffset,  blockData.data() + relativeOffset + 140, sizeof(u32));
-				memcpy(&b.indicesSize,    blockData.data() + relativeOffset + 144, sizeof(u32));
+				ImportResult infoResult = ParseBlockInfo(blockData.data() + relativeOffset, b);
+				if (infoResult != ImportResult::RESULT_SUCCESS) return infoResult;
 				
 				//verify that vertices are not OOB
 				if (relativeOffset + scast<u32>(VERTICE_DATA_OFFSET) + b.verticesSize > blockData.size())
@@ -839,4 +861,223 @@ namespace KalaHeaders::KalaModelData
 			return ImportResult::RESULT_UNKNOWN_READ_ERROR;
 		}
 	}
-}
\ No newline at end of file
+	
+	//
+	// STRUCT OF ARRAYS IMPORT
+	//
+	
+	//Reads the whole kmd file with a single read call, with the same checks as TryOpenCheck
+	inline ImportResult LoadFileData(
+		const path& inFile,
+		vector<u8>& outData)
+	{
+		try
+		{
+			errno = 0;
+			ifstream in(inFile, ios::in | ios::binary);
+			if (in.fail())
+			{
+				if (errno == EBUSY
+					|| errno == ETXTBSY)
+				{
+					return ImportResult::RESULT_FILE_LOCKED;
+				}
+				else return ImportResult::RESULT_UNKNOWN_READ_ERROR;
+			}
+			
+			in.seekg(0, ios::end);
+			size_t fileSize = scast<size_t>(in.tellg());
+			
+			if (fileSize == 0) return ImportResult::RESULT_FILE_EMPTY;
+			if (fileSize < MIN_TOTAL_SIZE
+				|| fileSize > MAX_TOTAL_SIZE)
+			{
+				return ImportResult::RESULT_UNSUPPORTED_FILE_SIZE;
+			}
+			
+			vector<u8> data(fileSize);
+			
+			in.seekg(0);
+			in.read(
+				rcast<char*>(data.data()),
+				scast<streamsize>(fileSize));
+			
+			if (scast<size_t>(in.gcount()) != fileSize) return ImportResult::RESULT_UNEXPECTED_EOF;
+			
+			in.close();
+			
+			outData = move(data);
+			
+			return ImportResult::RESULT_SUCCESS;
+		}
+		catch (...)
+		{
+			return ImportResult::RESULT_UNKNOWN_READ_ERROR;
+		}
+	}
+	
+	//Validates every model block of already loaded kmd data without touching its vertices,
+	//gives each model its range in the shared streams and returns the totals in outStreams
+	//with every stream resized for them, so DecodeModel can write each model in place
+	inline ImportResult ScanModels(
+		const vector<u8>& fileData,
+		const vector<ModelTable>& inTables,
+		vector<ModelView>& outModels,
+		VertexStreams& outStreams)
+	{
+		vector<ModelView> models{};
+		models.reserve(inTables.size());
+		
+		size_t vertexCount{};
+		size_t indexCount{};
+		
+		for (const auto& t : inTables)
+		{
+			ModelView m{};
+			
+			size_t offset = t.blockOffset;
+			
+			//verify that block size is not OOB
+			if (offset + t.blockSize > fileData.size()
+				|| offset + VERTICE_DATA_OFFSET > fileData.size())
+			{
+				return ImportResult::RESULT_UNEXPECTED_EOF;
+			}
+			
+			ImportResult infoResult = ParseBlockInfo(fileData.data() + offset, m);
+			if (infoResult != ImportResult::RESULT_SUCCESS) return infoResult;
+			
+			//verify that vertices and indices are not OOB
+			if (offset + VERTICE_DATA_OFFSET + m.verticesSize + m.indicesSize > fileData.size())
+			{
+				return ImportResult::RESULT_UNEXPECTED_EOF;
+			}
+			
+			m.blockOffset = t.blockOffset;
+			
+			m.firstVertex = vertexCount;
+			m.vertexCount = m.verticesSize / sizeof(Vertex);
+			m.firstIndex  = indexCount;
+			m.indexCount  = m.indicesSize / sizeof(u32);
+			
+			vertexCount += m.vertexCount;
+			indexCount  += m.indexCount;
+			
+			models.push_back(m);
+		}
+		
+		VertexStreams streams{};
+		
+		streams.positions.resize(vertexCount * 3);
+		streams.normals.resize(vertexCount * 3);
+		streams.texCoords.resize(vertexCount * 2);
+		streams.tangents.resize(vertexCount * 4);
+		streams.indices.resize(indexCount);
+		
+		outModels = move(models);
+		outStreams = move(streams);
+		
+		return ImportResult::RESULT_SUCCESS;
+	}
+	
+	//Splits the interleaved vertices of a model scanned with ScanModels straight into its range
+	//of every stream and copies its indices. Models only write their own range, so different
+	//models of the same streams can be decoded from several threads at once
+	inline void DecodeModel(
+		const vector<u8>& fileData,
+		const ModelView& inModel,
+		VertexStreams& streams)
+	{
+		const u8* vertexData = fileData.data() + inModel.blockOffset + VERTICE_DATA_OFFSET;
+		
+		f32* positions = streams.positions.data() + inModel.firstVertex * 3;
+		f32* normals   = streams.normals.data()   + inModel.firstVertex * 3;
+		f32* texCoords = streams.texCoords.data() + inModel.firstVertex * 2;
+		f32* tangents  = streams.tangents.data()  + inModel.firstVertex * 4;
+		
+		for (size_t i = 0; i < inModel.vertexCount; ++i)
+		{
+			//the file is not guaranteed to keep vertices aligned, so copy each one out first
+			Vertex v{};
+			memcpy(&v, vertexData + i * sizeof(Vertex), sizeof(Vertex));
+			
+			memcpy(positions + i * 3, v.position, sizeof(v.position));
+			memcpy(normals   + i * 3, v.normal,   sizeof(v.normal));
+			memcpy(texCoords + i * 2, v.texCoord, sizeof(v.texCoord));
+			memcpy(tangents  + i * 4, v.tangent,  sizeof(v.tangent));
+		}
+		
+		if (inModel.indexCount > 0)
+		{
+			memcpy(
+				streams.indices.data() + inModel.firstIndex,
+				vertexData + inModel.verticesSize,
+				inModel.indexCount * sizeof(u32));
+		}
+	}
+	
+	//Loads the whole kmd file with one read and splits every model into the
+	//struct of arrays streams of outArena, with no per-model vertex or index vectors.
+	//The file data is released once every model is decoded. Pass parallelFor to decode
+	//the models on your own threads, it is called once with the model count and must
+	//run job for every index from 0 to count - 1 before returning, for example
+	//by submitting batches of indices to a thread pool and waiting for all of them
+	inline ImportResult ImportKMDArena(
+		const path& inFile,
+		ModelArena& outArena,
+		const ParallelFor& parallelFor = {})
+	{
+		ImportResult preReadResult = PreReadCheck(inFile);
+		if (preReadResult != ImportResult::RESULT_SUCCESS) return preReadResult;
+		
+		vector<u8> fileData{};
+		
+		ImportResult loadResult = LoadFileData(inFile, fileData);
+		if (loadResult != ImportResult::RESULT_SUCCESS) return loadResult;
+		
+		ModelArena arena{};
+		
+		ImportResult headerResult = ParseHeaderData(fileData.data(), arena.header);
+		if (headerResult != ImportResult::RESULT_SUCCESS) return headerResult;
+		
+		if (CORRECT_MODEL_HEADER_SIZE + arena.header.modelTablesSize > fileData.size())
+		{
+			return ImportResult::RESULT_UNEXPECTED_EOF;
+		}
+		
+		ParseTableData(
+			fileData.data() + CORRECT_MODEL_HEADER_SIZE,
+			arena.header.modelTablesSize,
+			arena.tables);
+		
+		ImportResult scanResult = ScanModels(
+			fileData,
+			arena.tables,
+			arena.models,
+			arena.streams);
+		
+		if (scanResult != ImportResult::RESULT_SUCCESS) return scanResult;
+		
+		auto job = [&fileData, &arena](size_t index)
+		{
+			DecodeModel(
+				fileData,
+				arena.models[index],
+				arena.streams);
+		};
+		
+		if (parallelFor
+			&& arena.models.size() > 1)
+		{
+			parallelFor(arena.models.size(), job);
+		}
+		else
+		{
+			for (size_t i = 0; i < arena.models.size(); ++i) job(i);
+		}
+		
+		outArena = move(arena);
+		
+		return ImportResult::RESULT_SUCCESS;
+	}
+}
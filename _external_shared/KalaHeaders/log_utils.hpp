@@ -11,17 +11,27 @@
 //   - Simple logger - just a fwrite to the console with a single string parameter
 //   - Log types - info (no log type stamp), debug (skipped in release), success, warning, error
 //   - Time stamp, date stamp accurate to system clock
+//   - Per-thread output capture for printing the output of parallel work in one piece, or streaming it elsewhere
+//   - Optional async sink - lock-free queue of formatted records written in batches by a background thread
 //------------------------------------------------------------------------------
 
 #pragma once
 
 #include <cstring>
 #include <ctime>
+#include <cerrno>
+#include <climits>
 #include <cstdio>
+#include <cstdlib>
 #include <string>
+#include <vector>
+#include <memory_resource>
 #include <chrono>
 #include <array>
 #include <algorithm>
+#include <atomic>
+#include <thread>
+#include <bit>
 
 //static_cast
 #ifndef scast
@@ -33,10 +43,14 @@ namespace KalaHeaders::KalaLog
 	using std::string;
 	using std::string_view;
 	using std::chrono::system_clock;
+	using std::chrono::steady_clock;
+	using std::chrono::seconds;
 	using std::chrono::duration_cast;
 	using std::chrono::microseconds;
 	using std::chrono::milliseconds;
 	using std::array;
+	using std::vector;
+	using std::pmr::memory_resource;
 	using std::fwrite;
 	using std::fflush;
 	using std::clamp;
@@ -44,6 +58,32 @@ namespace KalaHeaders::KalaLog
 	using std::memcpy;
 	using std::strftime;
 	using std::snprintf;
+	using std::atomic;
+	using std::thread;
+	using std::bit_ceil;
+	using std::at_quick_exit;
+	using std::atexit;
+	using std::memory_order_relaxed;
+	using std::memory_order_acquire;
+	using std::memory_order_release;
+	using std::memory_order_acq_rel;
+
+#ifndef _WIN32
+	//POSIX stand-ins for the localtime_s and gmtime_s of the Windows CRT,
+	//same argument order and zero on success
+	inline int localtime_s(
+		tm* outTime,
+		const time_t* time)
+	{
+		return localtime_r(time, outTime) ? 0 : errno;
+	}
+	inline int gmtime_s(
+		tm* outTime,
+		const time_t* time)
+	{
+		return gmtime_r(time, outTime) ? 0 : errno;
+	}
+#endif
 	
 	using u8 = uint8_t;
 	using u16 = uint16_t;
@@ -57,6 +97,10 @@ namespace KalaHeaders::KalaLog
 	constexpr u8 MAX_INDENT_LENGTH = 20;
 	//How many type + tag combinations are cached
 	constexpr u8 CACHED_TAGS_LENGTH = 50;
+	//Default amount of records the async sink can hold before printing threads have to wait
+	constexpr size_t ASYNC_SINK_CAPACITY = 4096;
+	//Bytes collected by the async sink writer before they are written out in a single fwrite
+	constexpr size_t ASYNC_SINK_BATCH_SIZE = 64 * 1024;
 
 	enum class LogType
 	{
@@ -69,13 +113,14 @@ namespace KalaHeaders::KalaLog
 	enum class TimeFormat
 	{
 		TIME_NONE,
-		TIME_DEFAULT,    //Globally defined default time format
-		TIME_HMS,        //23:59:59
-		TIME_HMS_MS,     //23:59:59:123
-		TIME_12H,        //11:59:59 PM
-		TIME_ISO_8601,   //23:59:59Z
-		TIME_FILENAME,   //23-59-59
-		TIME_FILENAME_MS //23-59-59-123
+		TIME_DEFAULT,     //Globally defined default time format
+		TIME_HMS,         //23:59:59
+		TIME_HMS_MS,      //23:59:59:123
+		TIME_12H,         //11:59:59 PM
+		TIME_ISO_8601,    //23:59:59Z
+		TIME_FILENAME,    //23-59-59
+		TIME_FILENAME_MS, //23-59-59-123
+		TIME_ELAPSED      //00012.345678, steady clock seconds since the program started
 	};
 	enum class DateFormat
 	{
@@ -90,6 +135,14 @@ namespace KalaHeaders::KalaLog
 		DATE_FILENAME_MDY  //12-31-2025
 	};
 
+	//Receiver of every tagged Print before it is formatted, set with Log::SetRecordSink.
+	//Called on the printing thread, so it must be safe to call from every thread that prints
+	using LogRecordSink = void(*)(
+		void* context,
+		LogType type,
+		string_view target,
+		string_view message);
+
 	struct CachedPrefix
 	{
 		LogType type{};
@@ -97,9 +150,287 @@ namespace KalaHeaders::KalaLog
 		string prefix{};
 	};
 
+	//Output of one thread collected between Log::BeginCapture and Log::EndCapture,
+	//consecutive writes to the same stream are merged into a single segment
+	struct LogCapture
+	{
+		struct Segment
+		{
+			bool isError{}; //true if this text would have been sent to stderr
+			std::pmr::string text{};
+		};
+
+		LogCapture() = default;
+
+		//Segments and their text are allocated from resource, which must outlive the capture
+		explicit LogCapture(memory_resource* resource) : segments(resource) {}
+
+		std::pmr::vector<Segment> segments{};
+
+		//Optional receiver of every write as it happens, segments stay empty while it is set
+		void (*onWrite)(void* context, bool isError, const char* data, size_t length){};
+		void* context{};
+	};
+
+	//Bounded multi-producer single-consumer ring of formatted records that a background
+	//thread writes to the console in batches. Printing threads only claim a slot with an
+	//atomic ticket and copy their record into it, never taking a lock, and only wait
+	//when the ring is full. Enabled with Log::EnableAsyncSink
+	class AsyncLogSink
+	{
+	public:
+		//Capacity must be a power of two
+		explicit AsyncLogSink(size_t capacity)
+			: slots(capacity),
+			mask(capacity - 1)
+		{
+			for (size_t i = 0; i < capacity; ++i) slots[i].sequence.store(i, memory_order_relaxed);
+
+			writer = thread([this]() { WriterLoop(); });
+		}
+
+		//Writes every queued record and stops the writer
+		~AsyncLogSink()
+		{
+			Flush();
+
+			isStopping.store(true, memory_order_release);
+			published.fetch_add(1, memory_order_release);
+			published.notify_one();
+
+			writer.join();
+		}
+
+		AsyncLogSink(const AsyncLogSink&) = delete;
+		AsyncLogSink& operator=(const AsyncLogSink&) = delete;
+
+		//Queues a copy of this record, blocks only while the ring is full
+		void Push(
+			bool isError,
+			const char* data,
+			size_t length)
+		{
+			const size_t ticket = enqueuePos.fetch_add(1, memory_order_relaxed);
+			Slot& slot = slots[ticket & mask];
+
+			//the slot is free for this ticket once the writer has consumed the previous lap
+			size_t sequence{};
+			while ((sequence = slot.sequence.load(memory_order_acquire)) != ticket)
+			{
+				slot.sequence.wait(sequence, memory_order_acquire);
+			}
+
+			slot.isError = isError;
+			slot.text.assign(data, length); //reuses the capacity of earlier records in this slot
+
+			slot.sequence.store(ticket + 1, memory_order_release);
+
+			published.fetch_add(1, memory_order_release);
+			published.notify_one();
+		}
+
+		//Blocks until every record queued before this call has been written and flushed
+		void Flush()
+		{
+			const size_t target = enqueuePos.load(memory_order_acquire);
+
+			size_t current{};
+			while ((current = written.load(memory_order_acquire)) < target)
+			{
+				written.wait(current, memory_order_acquire);
+			}
+		}
+	private:
+		struct Slot
+		{
+			//equals the ticket that may write this slot while free,
+			//and that ticket + 1 once its record is ready to be written
+			atomic<size_t> sequence{};
+			bool isError{};
+			string text{};
+		};
+
+		vector<Slot> slots;
+		const size_t mask;
+
+		atomic<size_t> enqueuePos{}; //next ticket handed to a printing thread
+		atomic<size_t> published{};  //bumped after every record, the writer sleeps on it
+		atomic<size_t> written{};    //tickets below this are written and flushed
+		atomic<bool> isStopping{};
+
+		thread writer{};
+
+		void WriterLoop()
+		{
+			size_t readPos{};
+
+			string batch{};
+			batch.reserve(ASYNC_SINK_BATCH_SIZE * 2);
+			FILE* batchOut = stdout;
+
+			auto WriteBatch = [&]()
+				{
+					if (batch.empty()) return;
+
+					fwrite(batch.data(), 1, batch.size(), batchOut);
+					batch.clear();
+				};
+
+			while (true)
+			{
+				//loaded before draining so a record published after the drain still wakes the wait below
+				const size_t seen = published.load(memory_order_acquire);
+
+				const size_t startPos = readPos;
+				while (true)
+				{
+					Slot& slot = slots[readPos & mask];
+					if (slot.sequence.load(memory_order_acquire) != readPos + 1) break;
+
+					//records are written in queue order, so a stream switch ends the batch
+					FILE* out = slot.isError ? stderr : stdout;
+					if (out != batchOut)
+					{
+						WriteBatch();
+						fflush(batchOut);
+						batchOut = out;
+					}
+
+					batch.append(slot.text);
+
+					slot.sequence.store(readPos + slots.size(), memory_order_release);
+					slot.sequence.notify_all();
+					++readPos;
+
+					if (batch.size() >= ASYNC_SINK_BATCH_SIZE) WriteBatch();
+				}
+
+				if (readPos != startPos)
+				{
+					WriteBatch();
+					fflush(stdout);
+					fflush(stderr);
+
+					written.store(readPos, memory_order_release);
+					written.notify_all();
+
+					continue;
+				}
+
+				if (isStopping.load(memory_order_acquire)) return;
+
+				published.wait(seen, memory_order_acquire);
+			}
+		}
+	};
+
 	class Log
 	{
 	public:
+		//Moves console writes to a background thread that batches them into large writes.
+		//Prints return as soon as their record is queued and errors are no longer flushed
+		//one by one, use Flush before reading input or handing the console to another process.
+		//Queued records are written on exit and quick_exit. Call before other threads start printing
+		static inline void EnableAsyncSink(size_t capacity = ASYNC_SINK_CAPACITY)
+		{
+			if (asyncSink.load(memory_order_acquire) != nullptr) return;
+
+			asyncSink.store(
+				new AsyncLogSink(bit_ceil(capacity < 2 ? size_t{ 2 } : capacity)),
+				memory_order_release);
+
+			static bool isExitDrainRegistered{};
+			if (!isExitDrainRegistered)
+			{
+				at_quick_exit(DrainOnExit);
+				atexit(DrainOnExit);
+				isExitDrainRegistered = true;
+			}
+		}
+
+		//Writes every queued record and goes back to writing on the printing thread.
+		//Must not be called while other threads may still print
+		static inline void DisableAsyncSink()
+		{
+			delete asyncSink.exchange(nullptr, memory_order_acq_rel);
+		}
+
+		static inline bool IsAsyncSinkEnabled()
+		{
+			return asyncSink.load(memory_order_acquire) != nullptr;
+		}
+
+		//Sends every tagged Print to sink instead of formatting it for the console, errors are still
+		//printed too so that failures stay visible. Pass null to go back to text. Call before other threads start printing
+		static inline void SetRecordSink(
+			LogRecordSink sink,
+			void* context)
+		{
+			recordSink = sink;
+			recordContext = context;
+		}
+
+		static inline bool HasRecordSink()
+		{
+			return recordSink != nullptr;
+		}
+
+		//Blocks until everything printed so far has reached the console,
+		//including records still queued in the async sink
+		static inline void Flush()
+		{
+			if (AsyncLogSink* sink = asyncSink.load(memory_order_acquire)) sink->Flush();
+
+			fflush(stdout);
+			fflush(stderr);
+		}
+
+		//Redirects every print from the calling thread into this capture
+		//instead of the console until EndCapture is called on the same thread
+		static inline void BeginCapture(LogCapture& capture)
+		{
+			activeCapture = &capture;
+		}
+
+		//Stops capturing prints on the calling thread
+		static inline void EndCapture()
+		{
+			activeCapture = nullptr;
+		}
+
+		//Returns true if prints on the calling thread are currently captured
+		static inline bool IsCapturing()
+		{
+			return activeCapture != nullptr;
+		}
+
+		//Returns how many tagged LOG_ERROR prints the calling thread has made so far,
+		//compare two readings to find out if the code between them reported an error
+		static inline size_t GetErrorCount()
+		{
+			return errorCount;
+		}
+
+		//Writes all captured segments to the console in their original order
+		static inline void WriteCapture(const LogCapture& capture)
+		{
+			for (const auto& s : capture.segments)
+			{
+				Write(
+					s.isError ? stderr : stdout,
+					s.text.data(),
+					s.text.size(),
+					false);
+			}
+
+			if (!IsAsyncSinkEnabled())
+			{
+				fflush(stdout);
+				fflush(stderr);
+			}
+		}
+
+
 		static inline void SetDefaultTimeFormat(TimeFormat format)
 		{
 			if (format == TimeFormat::TIME_DEFAULT)
@@ -154,13 +485,16 @@ namespace KalaHeaders::KalaLog
 			return defaultDateFormat;
 		}
 
-		//Returns current time in chosen or default format
+		//Returns current time in chosen or default format. Every format is kept per thread and only
+		//its changed fields are rewritten, the milliseconds within a second and the seconds within
+		//a minute, the local or UTC time is only looked up again once a minute
 		static inline const string& GetTime(TimeFormat timeFormat = TimeFormat::TIME_DEFAULT)
 		{
-			static thread_local string cached[scast<int>(TimeFormat::TIME_FILENAME_MS) + 1];
-			static thread_local long long last_ms = -1;
-			static thread_local tm cachedLocal{};
-			static thread_local tm cachedUTC{};
+			constexpr size_t formatCount = scast<size_t>(TimeFormat::TIME_ELAPSED) + 1;
+			static thread_local array<string, formatCount> cached{};
+			static thread_local array<long long, formatCount> cachedMS{};
+			static thread_local array<long long, formatCount> secondStartMS{};
+			static thread_local array<long long, formatCount> minuteStartMS{};
 
 			static thread_local const string empty{};
 
@@ -175,96 +509,106 @@ namespace KalaHeaders::KalaLog
 				return GetTime(defaultTimeFormat);
 			}
 
-			const int idx = scast<int>(timeFormat);
-			const auto now = system_clock::now();
-			if (!cached[idx].empty())
+			const size_t idx = scast<size_t>(timeFormat);
+			string& text = cached[idx];
+
+			if (timeFormat == TimeFormat::TIME_ELAPSED)
 			{
-				auto now_ms = duration_cast<milliseconds>(now.time_since_epoch()).count();
-				if (now_ms == last_ms) return cached[idx];
+				FormatElapsed(text);
+				return text;
 			}
 
-			const auto us_since_epoch = duration_cast<microseconds>(now.time_since_epoch()).count();
-			const auto ms_since_epoch = duration_cast<milliseconds>(now.time_since_epoch()).count();
+			const long long nowMS = duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+			if (!text.empty()
+				&& nowMS == cachedMS[idx])
+			{
+				return text;
+			}
+			cachedMS[idx] = nowMS;
 
-			last_ms = ms_since_epoch;
+			const bool hasMS = timeFormat == TimeFormat::TIME_HMS_MS
+				|| timeFormat == TimeFormat::TIME_FILENAME_MS;
 
-			const auto in_time_t = system_clock::to_time_t(now);
-			const int ms = (us_since_epoch / 1000) % 1000; //sub-millisecond precision
+			//every format keeps its seconds at offset 6 and its milliseconds at offset 9,
+			//time zones and daylight saving only ever shift whole minutes
+			if (!text.empty())
+			{
+				const long long sinceSecond = nowMS - secondStartMS[idx];
+				if (sinceSecond >= 0
+					&& sinceSecond < 1000)
+				{
+					if (hasMS) WriteDigits(&text[9], scast<int>(sinceSecond), 3);
+					return text;
+				}
 
-			localtime_s(&cachedLocal, &in_time_t);
-			gmtime_s(&cachedUTC, &in_time_t);
+				const long long sinceMinute = nowMS - minuteStartMS[idx];
+				if (sinceMinute >= 0
+					&& sinceMinute < 60000)
+				{
+					const int ms = scast<int>(sinceMinute % 1000);
+					secondStartMS[idx] = nowMS - ms;
 
-			char buffer[32]{};
-			switch (timeFormat)
-			{
-			case TimeFormat::TIME_HMS:
-			{
-				strftime(buffer, sizeof(buffer), "%H:%M:%S", &cachedLocal);
+					WriteDigits(&text[6], scast<int>(sinceMinute / 1000), 2);
+					if (hasMS) WriteDigits(&text[9], ms, 3);
 
-				break;
+					return text;
+				}
 			}
-			case TimeFormat::TIME_HMS_MS:
-			{
-				char tmp[16]{};
-				size_t length = strftime(tmp, sizeof(tmp), "%H:%M:%S", &cachedLocal);
 
-				memcpy(buffer, tmp, length);
-				buffer[length++] = ':';
-				buffer[length++] = '0' + (ms / 100) % 10;
-				buffer[length++] = '0' + (ms / 10) % 10;
-				buffer[length++] = '0' + (ms % 10);
-				buffer[length] = '\0';
+			const long long ms = nowMS % 1000;
+			secondStartMS[idx] = nowMS - ms;
+			minuteStartMS[idx] = nowMS - nowMS % 60000;
 
-				break;
-			}
-			case TimeFormat::TIME_12H:
-			{
-				strftime(buffer, sizeof(buffer), "%I:%M:%S %p", &cachedLocal);
+			const tm& parts = GetCachedTM(
+				nowMS / 1000,
+				timeFormat == TimeFormat::TIME_ISO_8601);
 
-				break;
-			}
-			case TimeFormat::TIME_ISO_8601:
-			{
-				strftime(buffer, sizeof(buffer), "%H:%M:%SZ", &cachedUTC);
+			const char separator = (timeFormat == TimeFormat::TIME_FILENAME
+				|| timeFormat == TimeFormat::TIME_FILENAME_MS)
+				? '-'
+				: ':';
 
-				break;
-			}
-			case TimeFormat::TIME_FILENAME:
+			int hour = parts.tm_hour;
+			if (timeFormat == TimeFormat::TIME_12H)
 			{
-				strftime(buffer, sizeof(buffer), "%H-%M-%S", &cachedLocal);
-
-				break;
+				hour %= 12;
+				if (hour == 0) hour = 12;
 			}
-			case TimeFormat::TIME_FILENAME_MS:
-			{
-				char tmp[16]{};
-				size_t length = strftime(tmp, sizeof(tmp), "%H-%M-%S", &cachedLocal);
 
-				memcpy(buffer, tmp, length);
-				buffer[length++] = '-';
-				buffer[length++] = '0' + (ms / 100) % 10;
-				buffer[length++] = '0' + (ms / 10) % 10;
-				buffer[length++] = '0' + (ms % 10);
-				buffer[length] = '\0';
+			char buffer[16]{};
+			WriteDigits(buffer, hour, 2);
+			buffer[2] = separator;
+			WriteDigits(buffer + 3, parts.tm_min, 2);
+			buffer[5] = separator;
+			WriteDigits(buffer + 6, parts.tm_sec, 2);
 
-				break;
+			size_t length = 8;
+			if (hasMS)
+			{
+				buffer[length++] = separator;
+				WriteDigits(buffer + length, scast<int>(ms), 3);
+				length += 3;
 			}
-			default:
+			else if (timeFormat == TimeFormat::TIME_12H)
 			{
-				buffer[0] = '\0';
-				break;
+				memcpy(buffer + length, parts.tm_hour < 12 ? " AM" : " PM", 3);
+				length += 3;
 			}
+			else if (timeFormat == TimeFormat::TIME_ISO_8601)
+			{
+				buffer[length++] = 'Z';
 			}
 
-			cached[scast<int>(timeFormat)] = buffer;
-			return cached[scast<int>(timeFormat)];
+			text.assign(buffer, length);
+			return text;
 		}
-		//Returns current date in chosen or default format
+		//Returns current date in chosen or default format, the local date is only looked up again once a minute
 		static inline const string& GetDate(DateFormat dateFormat = DateFormat::DATE_DEFAULT)
 		{
-			static thread_local string cached[scast<int>(DateFormat::DATE_FILENAME_MDY) + 1];
-			static thread_local int last_yday = -1;
-			static thread_local tm cachedLocal{};
+			constexpr size_t formatCount = scast<size_t>(DateFormat::DATE_FILENAME_MDY) + 1;
+			static thread_local array<string, formatCount> cached{};
+			static thread_local array<long long, formatCount> cachedMinute{};
+			static thread_local array<int, formatCount> cachedDay{};
 
 			static thread_local string empty{};
 
@@ -279,34 +623,43 @@ namespace KalaHeaders::KalaLog
 				return GetDate(defaultDateFormat);
 			}
 
-			const int idx = scast<int>(dateFormat);
-			const auto now = system_clock::now();
+			const size_t idx = scast<size_t>(dateFormat);
+			string& text = cached[idx];
 
-			const auto in_time_t = system_clock::to_time_t(now);
-			localtime_s(&cachedLocal, &in_time_t);
-			if (!cached[idx].empty()
-				&& cachedLocal.tm_yday == last_yday)
+			//local midnight is always on a minute boundary
+			const long long nowSecond = duration_cast<seconds>(system_clock::now().time_since_epoch()).count();
+			if (!text.empty()
+				&& cachedMinute[idx] == nowSecond / 60)
 			{
-				return cached[idx];
+				return text;
 			}
+			cachedMinute[idx] = nowSecond / 60;
+
+			const tm& parts = GetCachedTM(nowSecond, false);
 
-			last_yday = cachedLocal.tm_yday;
+			const int day = parts.tm_year * 400 + parts.tm_yday;
+			if (!text.empty()
+				&& cachedDay[idx] == day)
+			{
+				return text;
+			}
+			cachedDay[idx] = day;
 
 			char buffer[64]{};
 			switch (dateFormat)
 			{
-			case DateFormat::DATE_DMY:          strftime(buffer, sizeof(buffer), "%d/%m/%Y", &cachedLocal); break;
-			case DateFormat::DATE_MDY:          strftime(buffer, sizeof(buffer), "%m/%d/%Y", &cachedLocal); break;
-			case DateFormat::DATE_ISO_8601:     strftime(buffer, sizeof(buffer), "%Y-%m-%d", &cachedLocal); break;
-			case DateFormat::DATE_TEXT_DMY:     strftime(buffer, sizeof(buffer), "%d %B, %Y", &cachedLocal); break;
-			case DateFormat::DATE_TEXT_MDY:     strftime(buffer, sizeof(buffer), "%B %d, %Y", &cachedLocal); break;
-			case DateFormat::DATE_FILENAME_DMY: strftime(buffer, sizeof(buffer), "%d-%m-%Y", &cachedLocal); break;
-			case DateFormat::DATE_FILENAME_MDY: strftime(buffer, sizeof(buffer), "%m-%d-%Y", &cachedLocal); break;
+			case DateFormat::DATE_DMY:          strftime(buffer, sizeof(buffer), "%d/%m/%Y", &parts); break;
+			case DateFormat::DATE_MDY:          strftime(buffer, sizeof(buffer), "%m/%d/%Y", &parts); break;
+			case DateFormat::DATE_ISO_8601:     strftime(buffer, sizeof(buffer), "%Y-%m-%d", &parts); break;
+			case DateFormat::DATE_TEXT_DMY:     strftime(buffer, sizeof(buffer), "%d %B, %Y", &parts); break;
+			case DateFormat::DATE_TEXT_MDY:     strftime(buffer, sizeof(buffer), "%B %d, %Y", &parts); break;
+			case DateFormat::DATE_FILENAME_DMY: strftime(buffer, sizeof(buffer), "%d-%m-%Y", &parts); break;
+			case DateFormat::DATE_FILENAME_MDY: strftime(buffer, sizeof(buffer), "%m-%d-%Y", &parts); break;
 			default:                            buffer[0] = '\0'; break;
 			}
 
-			cached[idx] = buffer;
-			return cached[idx];
+			text = buffer;
+			return text;
 		}
 
 		//Prints a log message to the console using fwrite.
@@ -339,9 +692,18 @@ namespace KalaHeaders::KalaLog
 				return;
 			}
 
-			string trimmed = TrimUTF8(message);
 			target = target.substr(0, MAX_TAG_LENGTH);
 
+			if (type == LogType::LOG_ERROR) ++errorCount;
+
+			if (recordSink)
+			{
+				recordSink(recordContext, type, target, message);
+				if (type != LogType::LOG_ERROR) return;
+			}
+
+			string trimmed = TrimUTF8(message);
+
 			const string& timeStamp = 
 				(timeFormat == TimeFormat::TIME_NONE)
 				? empty
@@ -414,13 +776,14 @@ namespace KalaHeaders::KalaLog
 				: stdout;
 
 			const size_t length = scast<size_t>(p - logBuffer.data());
-			fwrite(logBuffer.data(), 1, length, out);
-
-			if (flush
-				|| type == LogType::LOG_ERROR)
-			{
-				fflush(out);
-			}
+			//the async sink flushes errors together with the rest of their batch
+			Write(
+				out,
+				logBuffer.data(),
+				length,
+				flush
+				|| (type == LogType::LOG_ERROR
+				&& !IsAsyncSinkEnabled()));
 		}
 
 		//Prints a log message to the console using fwrite.
@@ -441,10 +804,151 @@ namespace KalaHeaders::KalaLog
 			memcpy(logBuffer.data(), trimmed.data(), length);
 			logBuffer[length] = '\n';
 
-			fwrite(logBuffer.data(), 1, totalLength, stdout);
-			if (flush) fflush(stdout);
+			Write(
+				stdout,
+				logBuffer.data(),
+				totalLength,
+				flush);
+		}
+
+		//Prints text to stdout exactly as passed, without trimming or a trailing newline.
+		//Meant for forwarding output that was produced elsewhere, like a child process
+		static inline void PrintRaw(
+			string_view text,
+			bool flush = false)
+		{
+			if (text.empty()) return;
+
+			Write(
+				stdout,
+				text.data(),
+				text.size(),
+				flush);
 		}
 	private:
+		//Steady clock time that TIME_ELAPSED counts from, set when the program starts
+		static inline const steady_clock::time_point startTime = steady_clock::now();
+
+		//Writes value as exactly count digits with leading zeros
+		static inline void WriteDigits(
+			char* out,
+			int value,
+			int count)
+		{
+			for (int i = count - 1; i >= 0; --i)
+			{
+				out[i] = scast<char>('0' + value % 10);
+				value /= 10;
+			}
+		}
+
+		//Returns the split local or UTC time of this second, only converted once per second and thread
+		static inline const tm& GetCachedTM(
+			long long second,
+			bool isUTC)
+		{
+			static thread_local array<tm, 2> parts{};
+			static thread_local array<long long, 2> cachedSecond{ LLONG_MIN, LLONG_MIN };
+
+			const size_t idx = isUTC ? 1 : 0;
+			if (cachedSecond[idx] != second)
+			{
+				const time_t in_time_t = scast<time_t>(second);
+				if (isUTC) gmtime_s(&parts[idx], &in_time_t);
+				else localtime_s(&parts[idx], &in_time_t);
+
+				cachedSecond[idx] = second;
+			}
+
+			return parts[idx];
+		}
+
+		//Formats the steady clock time since startTime as seconds with microseconds, for example '00012.345678'.
+		//It changes on every call, so it is written directly without any calendar lookup
+		static inline void FormatElapsed(string& out)
+		{
+			const long long us = duration_cast<microseconds>(steady_clock::now() - startTime).count();
+
+			long long whole = us / 1000000;
+
+			char buffer[32]{};
+			char* end = buffer + sizeof(buffer);
+			char* p = end;
+
+			p -= 6;
+			WriteDigits(p, scast<int>(us % 1000000), 6);
+			*--p = '.';
+
+			int digits{};
+			do
+			{
+				*--p = scast<char>('0' + whole % 10);
+				whole /= 10;
+				++digits;
+			} while (whole > 0 || digits < 5);
+
+			out.assign(p, scast<size_t>(end - p));
+		}
+
+		//Capture of the calling thread, null when prints go straight to the console
+		static inline thread_local LogCapture* activeCapture{};
+
+		//Tagged LOG_ERROR prints of the calling thread, captured and recorded ones included
+		static inline thread_local size_t errorCount{};
+
+		//Receiver of tagged prints, null while they are formatted as text
+		static inline LogRecordSink recordSink{};
+		static inline void* recordContext{};
+
+		//Background writer shared by all threads, null while prints are written directly
+		static inline atomic<AsyncLogSink*> asyncSink{};
+
+		static inline void DrainOnExit()
+		{
+			Flush();
+		}
+
+		//Single exit point of every print, appends to the active capture if there is one,
+		//otherwise queues to the async sink or writes directly. With the async sink flush waits for the writer
+		static inline void Write(
+			FILE* out,
+			const char* data,
+			size_t length,
+			bool flush)
+		{
+			if (activeCapture != nullptr)
+			{
+				const bool isError = out == stderr;
+
+				if (activeCapture->onWrite)
+				{
+					activeCapture->onWrite(activeCapture->context, isError, data, length);
+					return;
+				}
+
+				auto& segments = activeCapture->segments;
+				if (segments.empty()
+					|| segments.back().isError != isError)
+				{
+					segments.push_back({ isError, std::pmr::string(segments.get_allocator()) });
+				}
+				segments.back().text.append(data, length);
+
+				return;
+			}
+
+			if (AsyncLogSink* sink = asyncSink.load(memory_order_acquire))
+			{
+				sink->Push(out == stderr, data, length);
+				if (flush) sink->Flush();
+
+				return;
+			}
+
+			fwrite(data, 1, length, out);
+			if (flush) fflush(out);
+		}
+
 		static inline TimeFormat defaultTimeFormat = TimeFormat::TIME_HMS_MS;
 		static inline DateFormat defaultDateFormat = DateFormat::DATE_NONE;
 		
@@ -18,6 +18,7 @@
 #pragma once
 
 #include <cmath>
+#include <math.h>
 #include <cstdint>
 #include <algorithm>
 
@@ -25,18 +26,10 @@
 #include <basetsd.h>
 #endif
 
-using std::sinf;
-using std::cosf;
-using std::tanf;
-using std::sqrtf;
-using std::fabsf;
-using std::atan2f;
+//the float functions are used from math.h, libstdc++ only declares them in std since GCC 14
 using std::clamp;
 using std::min;
 using std::max;
-using std::fmodf;
-using std::powf;
-using std::floorf;
 
 //============================================================================
 //
@@ -423,4 +423,51 @@ namespace KalaHeaders::KalaString
 			target.size(),
 			target) == 0;
 	}
+
+	//Check if origin matches a glob pattern where '*' matches any run of characters
+	//including none and '?' matches exactly one character, everything else is literal
+	inline bool MatchesGlob(
+		string_view origin,
+		string_view pattern)
+	{
+		size_t o{};
+		size_t p{};
+
+		//position of the last '*' and the origin position it currently covers up to
+		size_t starPattern = string_view::npos;
+		size_t starOrigin{};
+
+		while (o < origin.size())
+		{
+			if (p < pattern.size()
+				&& (pattern[p] == '?'
+				|| pattern[p] == origin[o]))
+			{
+				++o;
+				++p;
+			}
+			else if (p < pattern.size()
+				&& pattern[p] == '*')
+			{
+				starPattern = p++;
+				starOrigin = o;
+			}
+			else if (starPattern != string_view::npos)
+			{
+				//let the last '*' swallow one more character and retry
+				p = starPattern + 1;
+				o = ++starOrigin;
+			}
+			else return false;
+		}
+
+		//only trailing '*' may be left over
+		while (p < pattern.size()
+			&& pattern[p] == '*')
+		{
+			++p;
+		}
+
+		return p == pattern.size();
+	}
 }
\ No newline at end of file
@@ -11,6 +11,7 @@
 //   - lock_m, lockwait_m (where applicable) and unlock_m for mutexes
 //   - jthread (joinable thread) which returns the created thread so it can be joined
 //   - dthread (self-exiting thread)
+//   - ThreadPool (fixed-size work-stealing pool with futures)
 //------------------------------------------------------------------------------
 
 #pragma once
@@ -19,6 +20,14 @@
 #include <concepts>
 #include <thread>
 #include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <future>
+#include <functional>
+#include <type_traits>
 
 namespace KalaHeaders::KalaThread
 {	
@@ -26,6 +35,7 @@ namespace KalaHeaders::KalaThread
 	using std::memory_order_acquire;
 	using std::memory_order_release;
 	using std::memory_order_relaxed;
+	using std::memory_order_acq_rel;
 	using std::convertible_to;
 	using std::is_arithmetic_v;
 	using std::is_pointer_v;
@@ -39,6 +49,22 @@ namespace KalaHeaders::KalaThread
 	using std::chrono::duration;
 	using std::chrono::time_point;
 	using std::remove_cvref_t;
+	using std::mutex;
+	using std::lock_guard;
+	using std::unique_lock;
+	using std::condition_variable;
+	using std::deque;
+	using std::vector;
+	using std::unique_ptr;
+	using std::make_unique;
+	using std::make_shared;
+	using std::future;
+	using std::future_status;
+	using std::packaged_task;
+	using std::function;
+	using std::invoke_result_t;
+	using std::decay_t;
+	using std::move;
 	
 	//
 	// CREATE THREAD
@@ -309,4 +335,217 @@ namespace KalaHeaders::KalaThread
 		ptr.store(value, memory_order_release);
 		return true;
 	}
-}
\ No newline at end of file
+	
+	//
+	// THREAD POOL
+	//
+	
+	//Fixed-size pool of worker threads that each own a task deque.
+	//Workers run their newest task first and steal the oldest task of another worker
+	//once their own deque is empty, idle workers sleep on a condition variable
+	class ThreadPool
+	{
+	public:
+		//Starts threadCount workers, 0 uses the hardware thread count
+		explicit ThreadPool(size_t threadCount = 0)
+		{
+			if (threadCount == 0) threadCount = thread::hardware_concurrency();
+			if (threadCount == 0) threadCount = 1;
+			
+			queues.reserve(threadCount);
+			for (size_t i = 0; i < threadCount; ++i) queues.push_back(make_unique<WorkerQueue>());
+			
+			threads.reserve(threadCount);
+			for (size_t i = 0; i < threadCount; ++i)
+			{
+				threads.emplace_back([this, i]() { WorkerLoop(i); });
+			}
+		}
+		
+		//Runs every task that is still queued and joins the workers
+		~ThreadPool()
+		{
+			{
+				lock_guard<mutex> lock(sleepMutex);
+				isStopping = true;
+			}
+			wake.notify_all();
+			
+			for (auto& t : threads) t.join();
+		}
+		
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+		
+		//Pool shared by everything in the process that needs to run work in parallel,
+		//started on first use with one worker per hardware thread
+		static ThreadPool& GetShared()
+		{
+			static ThreadPool pool{};
+			return pool;
+		}
+		
+		size_t GetThreadCount() const { return threads.size(); }
+		
+		//Queues a task and returns a future for its result, exceptions are stored in the future.
+		//Tasks queued from a worker of this pool go to the deque of that worker
+		template <invocable F>
+		auto Submit(F&& func) -> future<invoke_result_t<decay_t<F>>>
+		{
+			using R = invoke_result_t<decay_t<F>>;
+			
+			auto task = make_shared<packaged_task<R()>>(forward<F>(func));
+			future<R> result = task->get_future();
+			
+			Push([task]() { (*task)(); });
+			
+			return result;
+		}
+		
+		//Waits for a future of a task from this pool. Queued tasks are run on the calling thread
+		//while there are any, so tasks waiting on their own sub-tasks can't starve the pool
+		template <typename T>
+		T Await(future<T>& f)
+		{
+			while (f.wait_for(milliseconds(0)) != future_status::ready)
+			{
+				if (!TryRunOne())
+				{
+					f.wait();
+					break;
+				}
+			}
+			
+			return f.get();
+		}
+		
+		//Queues a task without a future for callers that count finished tasks themselves, see AwaitCount.
+		//Lambdas that only capture a pointer or two are stored in the queue without allocating
+		template <invocable F>
+		void Post(F&& func)
+		{
+			Push(function<void()>(forward<F>(func)));
+		}
+		
+		//Waits until tasks queued with Post have counted remaining down to 0, each task must
+		//decrement it and then call remaining.notify_all. Queued tasks are run on the calling
+		//thread meanwhile like with Await. The last notify can still be in flight when this returns,
+		//so remaining must be kept alive after the wait, for example by reusing it
+		void AwaitCount(atomic<size_t>& remaining)
+		{
+			while (true)
+			{
+				const size_t value = remaining.load(memory_order_acquire);
+				if (value == 0) return;
+				
+				if (!TryRunOne()) remaining.wait(value, memory_order_acquire);
+			}
+		}
+	private:
+		struct WorkerQueue
+		{
+			mutex m{};
+			deque<function<void()>> tasks{};
+		};
+		
+		vector<unique_ptr<WorkerQueue>> queues{};
+		vector<thread> threads{};
+		
+		atomic<size_t> pendingCount{}; //queued tasks that no worker has taken yet
+		atomic<size_t> nextQueue{};    //round-robin target for tasks queued from outside the pool
+		
+		mutex sleepMutex{};
+		condition_variable wake{};
+		bool isStopping{};
+		
+		//The pool and queue index the calling thread works for, if any
+		static inline thread_local ThreadPool* ownerPool{};
+		static inline thread_local size_t ownerIndex{};
+		
+		void Push(function<void()> task)
+		{
+			const size_t index = (ownerPool == this)
+				? ownerIndex
+				: nextQueue.fetch_add(1, memory_order_relaxed) % queues.size();
+				
+			{
+				lock_guard<mutex> lock(queues[index]->m);
+				queues[index]->tasks.push_back(move(task));
+			}
+			
+			pendingCount.fetch_add(1, memory_order_release);
+			
+			//taking the sleep mutex orders this wake after a worker that is about to sleep has checked the count
+			{
+				lock_guard<mutex> lock(sleepMutex);
+			}
+			wake.notify_one();
+		}
+		
+		//Takes one task, own newest first and then the oldest of the other workers,
+		//runs it and returns false if every deque was empty
+		bool TryRunOne()
+		{
+			const size_t count = queues.size();
+			const bool isWorker = ownerPool == this;
+			const size_t start = isWorker
+				? ownerIndex
+				: nextQueue.load(memory_order_relaxed) % count;
+			
+			function<void()> task{};
+			
+			if (isWorker)
+			{
+				WorkerQueue& own = *queues[start];
+				lock_guard<mutex> lock(own.m);
+				if (!own.tasks.empty())
+				{
+					task = move(own.tasks.back());
+					own.tasks.pop_back();
+				}
+			}
+			
+			for (size_t i = isWorker ? 1 : 0; !task && i < count; ++i)
+			{
+				WorkerQueue& other = *queues[(start + i) % count];
+				lock_guard<mutex> lock(other.m);
+				if (!other.tasks.empty())
+				{
+					task = move(other.tasks.front());
+					other.tasks.pop_front();
+				}
+			}
+			
+			if (!task) return false;
+			
+			pendingCount.fetch_sub(1, memory_order_acq_rel);
+			task();
+			
+			return true;
+		}
+		
+		void WorkerLoop(size_t index)
+		{
+			ownerPool = this;
+			ownerIndex = index;
+			
+			while (true)
+			{
+				if (TryRunOne()) continue;
+				
+				unique_lock<mutex> lock(sleepMutex);
+				wake.wait(lock, [this]()
+					{
+						return isStopping
+							|| pendingCount.load(memory_order_acquire) > 0;
+					});
+					
+				if (isStopping
+					&& pendingCount.load(memory_order_acquire) == 0)
+				{
+					return;
+				}
+			}
+		}
+	};
+}
@@ -0,0 +1,17 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include "core.hpp"
+
+using KalaCLI::Core;
+
+//Runs the cli with only the built-in commands, programs built on this template
+//pass a function that registers their own commands instead of nullptr
+int main(int argc, char* argv[])
+{
+	Core::Run(argc, argv, nullptr);
+
+	return 0;
+}
@@ -0,0 +1,87 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <filesystem>
+
+#include "KalaHeaders/core_utils.hpp"
+#include "KalaHeaders/math_utils.hpp"
+
+namespace KalaCLI
+{
+	using std::string;
+	using std::string_view;
+	using std::vector;
+	using std::function;
+	using std::filesystem::path;
+
+	//Seed of every generator in the benchmarks so each run measures the same data
+	constexpr u32 BENCH_SEED = 0x4B414C41;
+
+	struct BenchOptions
+	{
+		string filter{};      //only benchmarks whose name contains this are run, empty runs all
+		u32 repetitions = 10; //timed runs per benchmark after one untimed warmup run
+		bool quick{};         //smaller generated data for a fast sanity run
+		path scratchDir{};    //where generated files and folders are written
+	};
+
+	//Timings of one benchmark, every time is of a whole run of opsPerRun operations
+	struct BenchResult
+	{
+		string name{};
+		u64 opsPerRun{};
+		u64 bytesPerRun{};  //0 if the benchmark doesn't process a known amount of bytes
+		u32 repetitions{};
+		u64 minNS{};
+		u64 medianNS{};
+		u64 meanNS{};
+		u64 maxNS{};
+	};
+
+	class BenchRunner
+	{
+	public:
+		explicit BenchRunner(const BenchOptions& options) : options(options) {}
+
+		const BenchOptions& GetOptions() const { return options; }
+
+		//Returns true if a benchmark with this name passes the filter,
+		//lets suites skip generating data nobody asked for
+		bool IsSelected(string_view name) const;
+
+		//Calls body once untimed and then options.repetitions times timed, the result is kept for ToJSON
+		void Run(
+			string_view name,
+			u64 opsPerRun,
+			u64 bytesPerRun,
+			const function<void()>& body);
+
+		//Every result so far plus the options they were measured with as a single JSON document
+		string ToJSON() const;
+
+		//Keeps value observable so the compiler can't drop the work that produced it
+		static void Consume(u64 value);
+	private:
+		BenchOptions options{};
+		vector<BenchResult> results{};
+	};
+
+	//Command registry sizes, the lexer and a whole script through ParseLine
+	void RunDispatchBenchmarks(BenchRunner& runner);
+
+	//TokenizeString, SplitString and log time stamps
+	void RunStringBenchmarks(BenchRunner& runner);
+
+	//Directory listing and byte pattern search over generated folders and files
+	void RunFileBenchmarks(BenchRunner& runner);
+
+	//Kfd and kmd importers over generated asset files
+	void RunImporterBenchmarks(BenchRunner& runner);
+}
@@ -0,0 +1,350 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include <random>
+#include <span>
+
+#include "bench.hpp"
+#include "command.hpp"
+#include "lexer.hpp"
+
+using KalaCLI::BenchRunner;
+using KalaCLI::Command;
+using KalaCLI::StaticCommand;
+using KalaCLI::MakeCommandTable;
+using KalaCLI::CommandManager;
+using KalaCLI::Lexer;
+using KalaCLI::LexedLine;
+using KalaCLI::COMMAND_PREFIX;
+using KalaCLI::BENCH_SEED;
+
+using std::string;
+using std::string_view;
+using std::vector;
+using std::span;
+using std::to_string;
+using std::move;
+using std::mt19937;
+using std::uniform_int_distribution;
+
+//Registry sizes the dispatch benchmarks are measured at, commands are only ever added
+constexpr size_t REGISTRY_SIZES[] = { 10, 100, 1000, 10000 };
+
+//Dispatches per run of each registry size
+constexpr size_t DISPATCH_COUNT = 100000;
+
+//Misspelled names looked up per run of each registry size
+constexpr size_t SUGGEST_COUNT = 1000;
+
+//Lines of the generated script, and of the quick one
+constexpr size_t SCRIPT_LINE_COUNT = 1000000;
+constexpr size_t QUICK_SCRIPT_LINE_COUNT = 100000;
+
+//Lines of four commands joined with '&&&' per run, each line is a round trip through the thread pool
+constexpr size_t PARALLEL_LINE_COUNT = 10000;
+
+//Tokens seen by every benchmark handler, keeps the dispatch from being optimized out
+static u64 handledTokens{};
+
+static void HandleStatic(span<const string_view> params)
+{
+	handledTokens += params.size();
+}
+
+//Sixteen static commands with two primary variants each, the size of a typical built-in set
+static constexpr auto staticBenchCommands = MakeCommandTable(
+	StaticCommand{ .primary = { "static_cmd_0", "sc0" }, .paramCount = 1, .maxParamCount = 8, .targetFunction = HandleStatic },
+	StaticCommand{ .primary = { "static_cmd_1", "sc1" }, .paramCount = 1, .maxParamCount = 8, .targetFunction = HandleStatic },
+	StaticCommand{ .primary = { "static_cmd_2", "sc2" }, .paramCount = 1, .maxParamCount = 8, .targetFunction = HandleStatic },
+	StaticCommand{ .primary = { "static_cmd_3", "sc3" }, .paramCount = 1, .maxParamCount = 8, .targetFunction = HandleStatic },
+	StaticCommand{ .primary = { "static_cmd_4", "sc4" }, .paramCount = 1, .maxParamCount = 8, .targetFunction = HandleStatic },
+	StaticCommand{ .primary = { "static_cmd_5", "sc5" }, .paramCount = 1, .maxParamCount = 8, .targetFunction = HandleStatic },
+	StaticCommand{ .primary = { "static_cmd_6", "sc6" }, .paramCount = 1, .maxParamCount = 8, .targetFunction = HandleStatic },
+	StaticCommand{ .primary = { "static_cmd_7", "sc7" }, .paramCount = 1, .maxParamCount = 8, .targetFunction = HandleStatic },
+	StaticCommand{ .primary = { "static_cmd_8", "sc8" }, .paramCount = 1, .maxParamCount = 8, .targetFunction = HandleStatic },
+	StaticCommand{ .primary = { "static_cmd_9", "sc9" }, .paramCount = 1, .maxParamCount = 8, .targetFunction = HandleStatic },
+	StaticCommand{ .primary = { "static_cmd_10", "sc10" }, .paramCount = 1, .maxParamCount = 8, .targetFunction = HandleStatic },
+	StaticCommand{ .primary = { "static_cmd_11", "sc11" }, .paramCount = 1, .maxParamCount = 8, .targetFunction = HandleStatic },
+	StaticCommand{ .primary = { "static_cmd_12", "sc12" }, .paramCount = 1, .maxParamCount = 8, .targetFunction = HandleStatic },
+	StaticCommand{ .primary = { "static_cmd_13", "sc13" }, .paramCount = 1, .maxParamCount = 8, .targetFunction = HandleStatic },
+	StaticCommand{ .primary = { "static_cmd_14", "sc14" }, .paramCount = 1, .maxParamCount = 8, .targetFunction = HandleStatic },
+	StaticCommand{ .primary = { "static_cmd_15", "sc15" }, .paramCount = 1, .maxParamCount = 8, .targetFunction = HandleStatic });
+
+static string GetCommandName(size_t index)
+{
+	return "bench_cmd_" + to_string(index);
+}
+
+//Adds registered commands until there are count of them
+static void GrowRegistry(size_t count)
+{
+	for (size_t i = CommandManager::commands.size(); i < count; ++i)
+	{
+		Command c
+		{
+			.primary = { GetCommandName(i), "bc" + to_string(i) },
+			.description = "Benchmark command.",
+			.paramCount = 1,
+			.maxParamCount = 8,
+			.targetViewFunction = [](span<const string_view> params)
+				{
+					handledTokens += params.size();
+				},
+			.isThreadSafe = true
+		};
+
+		CommandManager::AddCommand(c);
+	}
+}
+
+//A script line of one to three chained commands with quoted and plain arguments,
+//each command picked from the first commandCount registered commands
+static string MakeScriptLine(
+	mt19937& rng,
+	size_t commandCount)
+{
+	uniform_int_distribution<size_t> pickCommand(0, commandCount - 1);
+	uniform_int_distribution<int> pickCount(0, 3);
+
+	string line{};
+
+	const int chainLength = 1 + pickCount(rng) % 3;
+	for (int c = 0; c < chainLength; ++c)
+	{
+		if (c > 0) line += " & ";
+
+		line += COMMAND_PREFIX;
+		line += GetCommandName(pickCommand(rng));
+
+		const int argCount = pickCount(rng);
+		for (int a = 0; a < argCount; ++a)
+		{
+			if (a % 2 == 0) line += " arg" + to_string(a);
+			else line += " \"quoted arg " + to_string(a) + "\"";
+		}
+	}
+
+	return line;
+}
+
+namespace KalaCLI
+{
+	void RunDispatchBenchmarks(BenchRunner& runner)
+	{
+		mt19937 rng(BENCH_SEED);
+
+		for (size_t registrySize : REGISTRY_SIZES)
+		{
+			const string sizeName = to_string(registrySize);
+
+			if (!runner.IsSelected("dispatch/parse_command/" + sizeName)
+				&& !runner.IsSelected("dispatch/find_command/" + sizeName)
+				&& !runner.IsSelected("dispatch/suggest_command/" + sizeName))
+			{
+				continue;
+			}
+
+			GrowRegistry(registrySize);
+
+			//the same random command order for every repetition
+			uniform_int_distribution<size_t> pick(0, registrySize - 1);
+
+			vector<string> names{};
+			names.reserve(DISPATCH_COUNT);
+			for (size_t i = 0; i < DISPATCH_COUNT; ++i)
+			{
+				names.push_back(string(COMMAND_PREFIX) + GetCommandName(pick(rng)));
+			}
+
+			runner.Run(
+				"dispatch/parse_command/" + sizeName,
+				DISPATCH_COUNT,
+				0,
+				[&names]()
+				{
+					string_view params[2] = { {}, "value" };
+					for (const auto& name : names)
+					{
+						params[0] = name;
+						CommandManager::ParseCommand(span<const string_view>(params, 2));
+					}
+				});
+
+			runner.Run(
+				"dispatch/find_command/" + sizeName,
+				DISPATCH_COUNT,
+				0,
+				[&names]()
+				{
+					u64 found{};
+					for (const auto& name : names)
+					{
+						found += CommandManager::FindCommand(string_view(name).substr(COMMAND_PREFIX.size())) != nullptr;
+					}
+					BenchRunner::Consume(found);
+				});
+
+			//one typo in the middle of every name, far fewer names than dispatches because each one walks the trie
+			vector<string> typos{};
+			typos.reserve(SUGGEST_COUNT);
+			for (size_t i = 0; i < SUGGEST_COUNT; ++i)
+			{
+				string typo = names[i].substr(COMMAND_PREFIX.size());
+				typo[typo.size() / 2] = 'x';
+				typos.push_back(move(typo));
+			}
+
+			runner.Run(
+				"dispatch/suggest_command/" + sizeName,
+				SUGGEST_COUNT,
+				0,
+				[&typos]()
+				{
+					u64 found{};
+					vector<string> suggestions{};
+					for (const auto& typo : typos)
+					{
+						suggestions.clear();
+						CommandManager::SuggestCommands(typo, suggestions);
+						found += suggestions.size();
+					}
+					BenchRunner::Consume(found);
+				});
+		}
+
+		if (runner.IsSelected("dispatch/parse_static_command"))
+		{
+			CommandManager::AddStaticCommands(staticBenchCommands);
+
+			uniform_int_distribution<size_t> pick(0, staticBenchCommands.commands.size() - 1);
+
+			vector<string> names{};
+			names.reserve(DISPATCH_COUNT);
+			for (size_t i = 0; i < DISPATCH_COUNT; ++i)
+			{
+				names.push_back(string(COMMAND_PREFIX) + "static_cmd_" + to_string(pick(rng)));
+			}
+
+			runner.Run(
+				"dispatch/parse_static_command",
+				DISPATCH_COUNT,
+				0,
+				[&names]()
+				{
+					string_view params[2] = { {}, "value" };
+					for (const auto& name : names)
+					{
+						params[0] = name;
+						CommandManager::ParseCommand(span<const string_view>(params, 2));
+					}
+				});
+		}
+
+		if (runner.IsSelected("dispatch/parallel_parse_line"))
+		{
+			GrowRegistry(REGISTRY_SIZES[0]);
+
+			vector<LexedLine> lexedLines(PARALLEL_LINE_COUNT);
+			for (size_t i = 0; i < PARALLEL_LINE_COUNT; ++i)
+			{
+				string line{};
+				for (size_t c = 0; c < 4; ++c)
+				{
+					if (c > 0) line += " &&& ";
+
+					line += COMMAND_PREFIX;
+					line += GetCommandName((i + c) % REGISTRY_SIZES[0]);
+					line += " arg";
+				}
+
+				Lexer::Tokenize(line, lexedLines[i]);
+			}
+
+			runner.Run(
+				"dispatch/parallel_parse_line",
+				PARALLEL_LINE_COUNT,
+				0,
+				[&lexedLines]()
+				{
+					u64 failed{};
+					for (const auto& lexed : lexedLines) failed += CommandManager::ParseLine(lexed);
+					BenchRunner::Consume(failed);
+				});
+		}
+
+		const bool wantsLexer = runner.IsSelected("dispatch/lexer_tokenize");
+		const bool wantsScript = runner.IsSelected("dispatch/script_parse_line");
+		if (!wantsLexer && !wantsScript) return;
+
+		//scripts use the largest registry so every picked command exists
+		const size_t commandCount = REGISTRY_SIZES[std::size(REGISTRY_SIZES) - 1];
+		GrowRegistry(commandCount);
+
+		const size_t lineCount = runner.GetOptions().quick
+			? QUICK_SCRIPT_LINE_COUNT
+			: SCRIPT_LINE_COUNT;
+
+		string script{};
+		vector<string_view> lines{};
+		{
+			vector<string> generated{};
+			generated.reserve(lineCount);
+			for (size_t i = 0; i < lineCount; ++i) generated.push_back(MakeScriptLine(rng, commandCount));
+
+			size_t total{};
+			for (const auto& l : generated) total += l.size() + 1;
+			script.reserve(total);
+
+			for (const auto& l : generated)
+			{
+				script += l;
+				script += '\n';
+			}
+		}
+
+		lines.reserve(lineCount);
+		for (size_t start = 0; start < script.size();)
+		{
+			const size_t end = script.find('\n', start);
+			lines.push_back(string_view(script).substr(start, end - start));
+			start = end + 1;
+		}
+
+		runner.Run(
+			"dispatch/lexer_tokenize",
+			lineCount,
+			script.size(),
+			[&lines]()
+			{
+				LexedLine lexed{};
+				u64 tokens{};
+				for (string_view line : lines)
+				{
+					Lexer::Tokenize(line, lexed);
+					tokens += lexed.tokens.size();
+				}
+				BenchRunner::Consume(tokens);
+			});
+
+		//what a batch run does per line, without reading the script from a stream
+		runner.Run(
+			"dispatch/script_parse_line",
+			lineCount,
+			script.size(),
+			[&lines]()
+			{
+				LexedLine lexed{};
+				u64 failed{};
+				for (string_view line : lines)
+				{
+					Lexer::Tokenize(line, lexed);
+					failed += CommandManager::ParseLine(lexed);
+				}
+				BenchRunner::Consume(failed);
+			});
+
+		BenchRunner::Consume(handledTokens);
+	}
+}
@@ -0,0 +1,175 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include <random>
+#include <fstream>
+#include <cstdio>
+#include <system_error>
+
+#include "KalaHeaders/file_utils.hpp"
+
+#include "bench.hpp"
+
+using KalaHeaders::KalaFile::ListDirectoryContents;
+using KalaHeaders::KalaFile::GetRangeByValue;
+using KalaHeaders::KalaFile::GetRangesByValues;
+using KalaHeaders::KalaFile::BinaryRange;
+using KalaHeaders::KalaFile::PatternRange;
+
+using KalaCLI::BenchRunner;
+using KalaCLI::BENCH_SEED;
+
+using std::string;
+using std::vector;
+using std::to_string;
+using std::ofstream;
+using std::ios;
+using std::streamsize;
+using std::mt19937;
+using std::mt19937_64;
+using std::uniform_int_distribution;
+using std::error_code;
+using std::filesystem::path;
+using std::filesystem::create_directory;
+
+//Subfolders per folder and levels of the generated tree, and of the quick one
+constexpr size_t TREE_FANOUT = 8;
+constexpr size_t TREE_DEPTH = 3;
+constexpr size_t QUICK_TREE_FANOUT = 4;
+
+//Empty files in every folder of the generated tree
+constexpr size_t TREE_FILES_PER_FOLDER = 8;
+
+//Size of the searched file, and of the quick one
+constexpr size_t SEARCH_FILE_SIZE = 64ULL * 1024 * 1024;
+constexpr size_t QUICK_SEARCH_FILE_SIZE = 8ULL * 1024 * 1024;
+
+//How many copies of each pattern are planted in the searched file
+constexpr size_t PLANTED_MATCH_COUNT = 64;
+
+//Creates TREE_FILES_PER_FOLDER files in folder and fanout subfolders below it until depth runs out,
+//returns how many files and folders were made
+static u64 MakeTree(
+	const path& folder,
+	size_t fanout,
+	size_t depth)
+{
+	u64 count{};
+
+	for (size_t f = 0; f < TREE_FILES_PER_FOLDER; ++f)
+	{
+		ofstream(folder / ("file_" + to_string(f) + ".txt"));
+		++count;
+	}
+
+	if (depth == 0) return count;
+
+	for (size_t d = 0; d < fanout; ++d)
+	{
+		const path sub = folder / ("dir_" + to_string(d));
+
+		error_code ec{};
+		create_directory(sub, ec);
+
+		count += 1 + MakeTree(sub, fanout, depth - 1);
+	}
+
+	return count;
+}
+
+namespace KalaCLI
+{
+	void RunFileBenchmarks(BenchRunner& runner)
+	{
+		const BenchOptions& options = runner.GetOptions();
+
+		if (runner.IsSelected("files/list_directory_recursive"))
+		{
+			const path treeRoot = options.scratchDir / "tree";
+
+			error_code ec{};
+			create_directory(treeRoot, ec);
+
+			const u64 entryCount = MakeTree(
+				treeRoot,
+				options.quick ? QUICK_TREE_FANOUT : TREE_FANOUT,
+				TREE_DEPTH);
+
+			runner.Run(
+				"files/list_directory_recursive",
+				entryCount,
+				0,
+				[&treeRoot]()
+				{
+					vector<path> entries{};
+					string result = ListDirectoryContents(treeRoot, entries, true);
+					BenchRunner::Consume(entries.size() + result.size());
+				});
+		}
+
+		const bool wantsSingle = runner.IsSelected("files/get_range_by_value");
+		const bool wantsMany = runner.IsSelected("files/get_ranges_by_values");
+		if (!wantsSingle && !wantsMany) return;
+
+		const size_t fileSize = options.quick
+			? QUICK_SEARCH_FILE_SIZE
+			: SEARCH_FILE_SIZE;
+
+		//random bytes never contain the planted patterns by chance at these lengths
+		const vector<vector<uint8_t>> patterns =
+		{
+			{ 'K', 'A', 'L', 'A', 'C', 'L', 'I', '!' },
+			{ 0xDE, 0xAD, 0xBE, 0xEF, 0xFE, 0xED, 0xFA, 0xCE },
+			{ 'n', 'e', 'e', 'd', 'l', 'e', '_', '0', '1' },
+			{ 0x00, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0xFF }
+		};
+
+		const path searchFile = options.scratchDir / "search.bin";
+		{
+			vector<uint8_t> data(fileSize);
+
+			mt19937_64 rng(BENCH_SEED);
+			for (size_t i = 0; i + sizeof(u64) <= data.size(); i += sizeof(u64))
+			{
+				const u64 value = rng();
+				memcpy(data.data() + i, &value, sizeof(u64));
+			}
+
+			uniform_int_distribution<size_t> pickOffset(0, fileSize - 16);
+			for (size_t i = 0; i < PLANTED_MATCH_COUNT; ++i)
+			{
+				for (const auto& p : patterns)
+				{
+					memcpy(data.data() + pickOffset(rng), p.data(), p.size());
+				}
+			}
+
+			ofstream out(searchFile, ios::binary);
+			out.write(rcast<const char*>(data.data()), scast<streamsize>(data.size()));
+		}
+
+		runner.Run(
+			"files/get_range_by_value",
+			1,
+			fileSize,
+			[&searchFile, &patterns]()
+			{
+				vector<BinaryRange> matches{};
+				string result = GetRangeByValue(searchFile, patterns[0], matches);
+				BenchRunner::Consume(matches.size() + result.size());
+			});
+
+		runner.Run(
+			"files/get_ranges_by_values",
+			1,
+			fileSize,
+			[&searchFile, &patterns]()
+			{
+				vector<PatternRange> matches{};
+				string result = GetRangesByValues(searchFile, patterns, matches);
+				BenchRunner::Consume(matches.size() + result.size());
+			});
+	}
+}
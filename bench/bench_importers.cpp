@@ -0,0 +1,403 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include <random>
+#include <fstream>
+#include <future>
+#include <algorithm>
+#include <cstring>
+#include <system_error>
+
+#include "KalaHeaders/thread_utils.hpp"
+#include "KalaHeaders/import_kfd.hpp"
+#include "KalaHeaders/import_kmd.hpp"
+
+#include "bench.hpp"
+#include "asset_inspector.hpp"
+
+namespace KalaFontData = KalaHeaders::KalaFontData;
+namespace KalaModelData = KalaHeaders::KalaModelData;
+
+using KalaHeaders::KalaThread::ThreadPool;
+
+using KalaCLI::BenchRunner;
+using KalaCLI::BENCH_SEED;
+using KalaCLI::AssetInspector;
+using KalaCLI::AssetSummary;
+using KalaCLI::InspectStats;
+
+using std::string;
+using std::vector;
+using std::function;
+using std::future;
+using std::to_string;
+using std::ofstream;
+using std::ios;
+using std::streamsize;
+using std::min;
+using std::mt19937;
+using std::uniform_real_distribution;
+using std::error_code;
+using std::filesystem::path;
+using std::filesystem::create_directory;
+using std::filesystem::copy_file;
+
+//Glyphs of the generated font, the most a kfd may hold
+constexpr u32 FONT_GLYPH_COUNT = 1024;
+//Pixels per glyph, keeps the blocks of all glyphs below the kfd block size limit
+constexpr u16 FONT_GLYPH_WIDTH = 28;
+constexpr u16 FONT_GLYPH_HEIGHT = 32;
+
+//Models and vertices per model of the generated scene, and of the quick one
+constexpr u32 SCENE_MODEL_COUNT = 64;
+constexpr u32 SCENE_VERTEX_COUNT = 16384;
+constexpr u32 QUICK_SCENE_MODEL_COUNT = 16;
+constexpr u32 QUICK_SCENE_VERTEX_COUNT = 2048;
+
+//Copies of both generated assets in the folder walked by the inspect benchmark
+constexpr size_t INSPECT_FOLDER_FILE_COUNT = 256;
+
+//Models decoded by one pool task in the pooled kmd arena import
+constexpr size_t MODELS_PER_TASK = 4;
+
+template<typename T>
+static void Put(
+	vector<u8>& data,
+	T value)
+{
+	const size_t offset = data.size();
+	data.resize(offset + sizeof(T));
+	memcpy(data.data() + offset, &value, sizeof(T));
+}
+
+static void WriteFile(
+	const path& target,
+	const vector<u8>& data)
+{
+	ofstream out(target, ios::binary);
+	out.write(rcast<const char*>(data.data()), scast<streamsize>(data.size()));
+}
+
+//Bitmap font with FONT_GLYPH_COUNT glyphs of FONT_GLYPH_WIDTH * FONT_GLYPH_HEIGHT pixels each
+static vector<u8> MakeFont()
+{
+	const u32 pixelSize = FONT_GLYPH_WIDTH * FONT_GLYPH_HEIGHT;
+	const u32 blockSize = KalaFontData::RAW_PIXEL_DATA_OFFSET + pixelSize;
+	const u32 tableSize = FONT_GLYPH_COUNT * KalaFontData::CORRECT_GLYPH_TABLE_SIZE;
+
+	vector<u8> data{};
+	data.reserve(KalaFontData::CORRECT_GLYPH_HEADER_SIZE + tableSize + blockSize * FONT_GLYPH_COUNT);
+
+	Put<u32>(data, KalaFontData::KFD_MAGIC);
+	Put<u8>(data, KalaFontData::KFD_VERSION);
+	Put<u8>(data, 1);
+	Put<u16>(data, FONT_GLYPH_HEIGHT);
+	Put<u32>(data, FONT_GLYPH_COUNT);
+	for (u8 index : { 0, 1, 2, 2, 3, 0 }) Put<u8>(data, index);
+	for (u8 uv : { 0, 0, 1, 0, 1, 1, 0, 1 }) Put<u8>(data, uv);
+	Put<u32>(data, tableSize);
+	Put<u32>(data, blockSize * FONT_GLYPH_COUNT);
+
+	const u32 firstBlock = KalaFontData::CORRECT_GLYPH_HEADER_SIZE + tableSize;
+	for (u32 i = 0; i < FONT_GLYPH_COUNT; ++i)
+	{
+		Put<u32>(data, 32 + i);
+		Put<u32>(data, firstBlock + i * blockSize);
+		Put<u32>(data, blockSize);
+	}
+
+	for (u32 i = 0; i < FONT_GLYPH_COUNT; ++i)
+	{
+		Put<u32>(data, 32 + i);
+		Put<u16>(data, FONT_GLYPH_WIDTH);
+		Put<u16>(data, FONT_GLYPH_HEIGHT);
+		Put<i16>(data, 1);
+		Put<i16>(data, FONT_GLYPH_HEIGHT);
+		Put<u16>(data, FONT_GLYPH_WIDTH + 2);
+		for (i16 v : { 0, 0, 28, 0, 28, 32, 0, 32 }) Put<i16>(data, v);
+		Put<u32>(data, pixelSize);
+
+		for (u32 p = 0; p < pixelSize; ++p) data.push_back(scast<u8>(p * 7 + i));
+	}
+
+	return data;
+}
+
+//Scene of modelCount models with vertexCount vertices and as many indices each
+static vector<u8> MakeScene(
+	u32 modelCount,
+	u32 vertexCount)
+{
+	using KalaModelData::Vertex;
+
+	mt19937 rng(BENCH_SEED);
+	uniform_real_distribution<f32> pickFloat(-1.0f, 1.0f);
+
+	const u32 verticesSize = vertexCount * scast<u32>(sizeof(Vertex));
+	const u32 indicesSize = vertexCount * scast<u32>(sizeof(u32));
+	const u32 blockSize = KalaModelData::VERTICE_DATA_OFFSET + verticesSize + indicesSize;
+	const u32 tableSize = modelCount * KalaModelData::CORRECT_MODEL_TABLE_SIZE;
+
+	vector<u8> data{};
+	data.reserve(KalaModelData::CORRECT_MODEL_HEADER_SIZE + tableSize + scast<size_t>(blockSize) * modelCount);
+
+	Put<u32>(data, KalaModelData::KMD_MAGIC);
+	Put<u8>(data, KalaModelData::KMD_VERSION);
+	Put<u8>(data, 0);
+	Put<u32>(data, modelCount);
+	Put<u32>(data, tableSize);
+	Put<u32>(data, blockSize * modelCount);
+
+	const u32 firstBlock = KalaModelData::CORRECT_MODEL_HEADER_SIZE + tableSize;
+	for (u32 m = 0; m < modelCount; ++m)
+	{
+		char name[20]{};
+		snprintf(name, sizeof(name), "model_%u", m);
+
+		data.insert(data.end(), name, name + sizeof(name));
+		Put<u32>(data, firstBlock + m * blockSize);
+		Put<u32>(data, blockSize);
+	}
+
+	for (u32 m = 0; m < modelCount; ++m)
+	{
+		const u32 blockStart = firstBlock + m * blockSize;
+
+		char names[90]{};
+		snprintf(names, 20, "model_%u", m);
+		snprintf(names + 20, 20, "mesh_%u", m);
+		snprintf(names + 40, 50, "scene/model_%u", m);
+		data.insert(data.end(), names, names + sizeof(names));
+
+		Put<u8>(data, 0b00000011);
+		Put<u8>(data, scast<u8>(m % 3));
+		for (f32 v : { 1.0f, 2.0f, 3.0f }) Put<f32>(data, v);
+		for (f32 v : { 1.0f, 0.0f, 0.0f, 0.0f }) Put<f32>(data, v);
+		for (f32 v : { 1.0f, 1.0f, 1.0f }) Put<f32>(data, v);
+
+		Put<u32>(data, blockStart + KalaModelData::VERTICE_DATA_OFFSET);
+		Put<u32>(data, verticesSize);
+		Put<u32>(data, blockStart + KalaModelData::VERTICE_DATA_OFFSET + verticesSize);
+		Put<u32>(data, indicesSize);
+
+		for (u32 v = 0; v < vertexCount; ++v)
+		{
+			Vertex vertex{};
+			for (f32& f : vertex.position) f = pickFloat(rng) * 100.0f;
+			for (f32& f : vertex.normal) f = pickFloat(rng);
+			for (f32& f : vertex.texCoord) f = pickFloat(rng);
+			for (f32& f : vertex.tangent) f = pickFloat(rng);
+
+			Put<Vertex>(data, vertex);
+		}
+
+		for (u32 i = 0; i < vertexCount; ++i) Put<u32>(data, (i * 3) % vertexCount);
+	}
+
+	return data;
+}
+
+//Decodes the models of ImportKMDArena in batches on the shared pool
+static void PoolParallelFor(
+	size_t count,
+	const function<void(size_t)>& job)
+{
+	ThreadPool& pool = ThreadPool::GetShared();
+	vector<future<void>> tasks{};
+
+	for (size_t start = 0; start < count; start += MODELS_PER_TASK)
+	{
+		const size_t end = min(start + MODELS_PER_TASK, count);
+		tasks.push_back(pool.Submit([&job, start, end]()
+			{
+				for (size_t i = start; i < end; ++i) job(i);
+			}));
+	}
+
+	for (auto& t : tasks) pool.Await(t);
+}
+
+namespace KalaCLI
+{
+	void RunImporterBenchmarks(BenchRunner& runner)
+	{
+		const BenchOptions& options = runner.GetOptions();
+
+		const path fontFile = options.scratchDir / "font.kfd";
+		const path sceneFile = options.scratchDir / "scene.kmd";
+
+		const vector<u8> font = MakeFont();
+		WriteFile(fontFile, font);
+
+		const vector<u8> scene = options.quick
+			? MakeScene(QUICK_SCENE_MODEL_COUNT, QUICK_SCENE_VERTEX_COUNT)
+			: MakeScene(SCENE_MODEL_COUNT, SCENE_VERTEX_COUNT);
+		WriteFile(sceneFile, scene);
+
+		const u32 modelCount = options.quick ? QUICK_SCENE_MODEL_COUNT : SCENE_MODEL_COUNT;
+
+		//
+		// KFD
+		//
+
+		runner.Run(
+			"kfd/header_and_tables",
+			1,
+			0,
+			[&fontFile]()
+			{
+				KalaFontData::GlyphHeader header{};
+				vector<KalaFontData::GlyphTable> tables{};
+				KalaFontData::GetHeaderData(fontFile, header);
+				KalaFontData::GetTableData(fontFile, tables, true);
+				BenchRunner::Consume(tables.size());
+			});
+
+		runner.Run(
+			"kfd/import",
+			FONT_GLYPH_COUNT,
+			font.size(),
+			[&fontFile]()
+			{
+				KalaFontData::GlyphHeader header{};
+				vector<KalaFontData::GlyphTable> tables{};
+				vector<KalaFontData::GlyphBlock> blocks{};
+				KalaFontData::ImportKFD(fontFile, header, tables, blocks);
+				BenchRunner::Consume(blocks.size());
+			});
+
+		runner.Run(
+			"kfd/stream_glyphs",
+			FONT_GLYPH_COUNT,
+			font.size(),
+			[&fontFile]()
+			{
+				vector<KalaFontData::GlyphTable> tables{};
+				vector<KalaFontData::GlyphBlock> blocks{};
+				KalaFontData::GetTableData(fontFile, tables);
+				KalaFontData::StreamGlyphs(fontFile, tables, blocks, true);
+				BenchRunner::Consume(blocks.size());
+			});
+
+		runner.Run(
+			"kfd/import_arena",
+			FONT_GLYPH_COUNT,
+			font.size(),
+			[&fontFile]()
+			{
+				KalaFontData::GlyphArena arena{};
+				KalaFontData::ImportKFDArena(fontFile, arena);
+				BenchRunner::Consume(arena.glyphs.size());
+			});
+
+		runner.Run(
+			"kfd/import_arena_lazy",
+			1,
+			font.size(),
+			[&fontFile]()
+			{
+				KalaFontData::GlyphArena arena{};
+				KalaFontData::ImportKFDArena(fontFile, arena, true);
+
+				const KalaFontData::GlyphView* glyph{};
+				KalaFontData::GetGlyph(arena, 'A', glyph);
+				BenchRunner::Consume(glyph != nullptr);
+			});
+
+		//
+		// KMD
+		//
+
+		runner.Run(
+			"kmd/header_and_tables",
+			1,
+			0,
+			[&sceneFile]()
+			{
+				KalaModelData::ModelHeader header{};
+				vector<KalaModelData::ModelTable> tables{};
+				KalaModelData::GetHeaderData(sceneFile, header);
+				KalaModelData::GetTableData(sceneFile, tables, true);
+				BenchRunner::Consume(tables.size());
+			});
+
+		runner.Run(
+			"kmd/import",
+			modelCount,
+			scene.size(),
+			[&sceneFile]()
+			{
+				KalaModelData::ModelHeader header{};
+				vector<KalaModelData::ModelTable> tables{};
+				vector<KalaModelData::ModelBlock> blocks{};
+				KalaModelData::ImportKMD(sceneFile, header, tables, blocks);
+				BenchRunner::Consume(blocks.size());
+			});
+
+		runner.Run(
+			"kmd/stream_models",
+			modelCount,
+			scene.size(),
+			[&sceneFile]()
+			{
+				vector<KalaModelData::ModelTable> tables{};
+				vector<KalaModelData::ModelBlock> blocks{};
+				KalaModelData::GetTableData(sceneFile, tables);
+				KalaModelData::StreamModels(sceneFile, tables, blocks, true);
+				BenchRunner::Consume(blocks.size());
+			});
+
+		runner.Run(
+			"kmd/import_arena",
+			modelCount,
+			scene.size(),
+			[&sceneFile]()
+			{
+				KalaModelData::ModelArena arena{};
+				KalaModelData::ImportKMDArena(sceneFile, arena);
+				BenchRunner::Consume(arena.streams.positions.size());
+			});
+
+		runner.Run(
+			"kmd/import_arena_pool",
+			modelCount,
+			scene.size(),
+			[&sceneFile]()
+			{
+				KalaModelData::ModelArena arena{};
+				KalaModelData::ImportKMDArena(sceneFile, arena, PoolParallelFor);
+				BenchRunner::Consume(arena.streams.positions.size());
+			});
+
+		//
+		// INSPECT
+		//
+
+		if (!runner.IsSelected("inspect/folder")) return;
+
+		const path assetFolder = options.scratchDir / "assets";
+
+		error_code ec{};
+		create_directory(assetFolder, ec);
+
+		for (size_t i = 0; i < INSPECT_FOLDER_FILE_COUNT; ++i)
+		{
+			copy_file(fontFile, assetFolder / ("font_" + to_string(i) + ".kfd"), ec);
+			copy_file(sceneFile, assetFolder / ("scene_" + to_string(i) + ".kmd"), ec);
+		}
+
+		runner.Run(
+			"inspect/folder",
+			INSPECT_FOLDER_FILE_COUNT * 2,
+			0,
+			[&assetFolder]()
+			{
+				vector<AssetSummary> files{};
+				InspectStats stats{};
+				AssetInspector::InspectPath(assetFolder, false, files, stats);
+				BenchRunner::Consume(stats.fileCount);
+			});
+	}
+}
@@ -0,0 +1,235 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <system_error>
+
+#include "bench.hpp"
+
+using KalaCLI::BenchRunner;
+using KalaCLI::BenchOptions;
+using KalaCLI::BenchResult;
+
+using std::string;
+using std::string_view;
+using std::vector;
+using std::function;
+using std::ofstream;
+using std::ios;
+using std::streamsize;
+using std::ostringstream;
+using std::sort;
+using std::move;
+using std::atomic;
+using std::from_chars;
+using std::errc;
+using std::error_code;
+using std::memory_order_relaxed;
+using std::chrono::steady_clock;
+using std::chrono::duration_cast;
+using std::chrono::nanoseconds;
+using std::filesystem::path;
+using std::filesystem::temp_directory_path;
+using std::filesystem::create_directories;
+using std::filesystem::remove_all;
+
+#ifndef PROGRAM_VERSION
+	#define PROGRAM_VERSION "KalaCLI"
+#endif
+
+//Written to by BenchRunner::Consume, never read
+static atomic<u64> consumed{};
+
+static void PrintUsage()
+{
+	printf(
+		"Usage: KalaCLI_bench [--filter <text>] [--repetitions <count>] [--quick] [--out <file>] [--scratch <folder>]\n"
+		"  --filter       only runs benchmarks whose name contains text\n"
+		"  --repetitions  timed runs per benchmark, default 10\n"
+		"  --quick        smaller generated data for a fast sanity run\n"
+		"  --out          writes the JSON results to file instead of stdout\n"
+		"  --scratch      folder for generated files, default is a kalacli_bench folder in the temp directory\n");
+}
+
+namespace KalaCLI
+{
+	bool BenchRunner::IsSelected(string_view name) const
+	{
+		return options.filter.empty()
+			|| name.find(options.filter) != string_view::npos;
+	}
+
+	void BenchRunner::Run(
+		string_view name,
+		u64 opsPerRun,
+		u64 bytesPerRun,
+		const function<void()>& body)
+	{
+		if (!IsSelected(name)) return;
+
+		//warmup, also faults in every page the timed runs touch
+		body();
+
+		vector<u64> times{};
+		times.reserve(options.repetitions);
+
+		for (u32 i = 0; i < options.repetitions; ++i)
+		{
+			const auto start = steady_clock::now();
+			body();
+			const auto end = steady_clock::now();
+
+			times.push_back(scast<u64>(duration_cast<nanoseconds>(end - start).count()));
+		}
+
+		sort(times.begin(), times.end());
+
+		BenchResult result{};
+		result.name = string(name);
+		result.opsPerRun = opsPerRun;
+		result.bytesPerRun = bytesPerRun;
+		result.repetitions = options.repetitions;
+
+		if (!times.empty())
+		{
+			u64 total{};
+			for (u64 t : times) total += t;
+
+			result.minNS = times.front();
+			result.medianNS = times[times.size() / 2];
+			result.meanNS = total / times.size();
+			result.maxNS = times.back();
+		}
+
+		//progress goes to stderr so stdout only ever holds the JSON
+		fprintf(stderr, "%-48s %12llu ns median\n",
+			result.name.c_str(),
+			scast<unsigned long long>(result.medianNS));
+
+		results.push_back(move(result));
+	}
+
+	string BenchRunner::ToJSON() const
+	{
+		ostringstream oss{};
+
+		oss << "{\n"
+			<< "  \"version\": \"" << PROGRAM_VERSION << "\",\n"
+			<< "  \"seed\": " << BENCH_SEED << ",\n"
+			<< "  \"repetitions\": " << options.repetitions << ",\n"
+			<< "  \"quick\": " << (options.quick ? "true" : "false") << ",\n"
+			<< "  \"benchmarks\": [";
+
+		for (size_t i = 0; i < results.size(); ++i)
+		{
+			const BenchResult& r = results[i];
+
+			//names are generated by the suites and never need escaping
+			oss << (i == 0 ? "\n" : ",\n")
+				<< "    { \"name\": \"" << r.name << "\""
+				<< ", \"opsPerRun\": " << r.opsPerRun
+				<< ", \"bytesPerRun\": " << r.bytesPerRun
+				<< ", \"minNS\": " << r.minNS
+				<< ", \"medianNS\": " << r.medianNS
+				<< ", \"meanNS\": " << r.meanNS
+				<< ", \"maxNS\": " << r.maxNS
+				<< ", \"nsPerOp\": " << (r.opsPerRun > 0
+					? scast<double>(r.medianNS) / scast<double>(r.opsPerRun)
+					: 0.0)
+				<< " }";
+		}
+
+		oss << "\n  ]\n}\n";
+
+		return oss.str();
+	}
+
+	void BenchRunner::Consume(u64 value)
+	{
+		consumed.fetch_add(value, memory_order_relaxed);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	BenchOptions options{};
+	path outFile{};
+
+	for (int i = 1; i < argc; ++i)
+	{
+		string_view arg = argv[i];
+		const bool hasValue = i + 1 < argc;
+
+		if (arg == "--quick") options.quick = true;
+		else if (arg == "--filter" && hasValue) options.filter = argv[++i];
+		else if (arg == "--out" && hasValue) outFile = argv[++i];
+		else if (arg == "--scratch" && hasValue) options.scratchDir = argv[++i];
+		else if (arg == "--repetitions" && hasValue)
+		{
+			string_view value = argv[++i];
+			auto [ptr, ec] = from_chars(value.data(), value.data() + value.size(), options.repetitions);
+			if (ec != errc{}
+				|| ptr != value.data() + value.size()
+				|| options.repetitions == 0)
+			{
+				fprintf(stderr, "Repetitions must be a positive number, got '%s'!\n", argv[i]);
+				return 1;
+			}
+		}
+		else
+		{
+			PrintUsage();
+			return arg == "--help" ? 0 : 1;
+		}
+	}
+
+	//the scratch folder is always one this run made itself, so it is safe to remove afterwards
+	if (options.scratchDir.empty()) options.scratchDir = temp_directory_path() / "kalacli_bench";
+	options.scratchDir /= "run";
+
+	error_code ec{};
+	remove_all(options.scratchDir, ec);
+	create_directories(options.scratchDir, ec);
+	if (ec)
+	{
+		fprintf(stderr, "Failed to create scratch folder '%s'! Reason: %s\n",
+			options.scratchDir.string().c_str(),
+			ec.message().c_str());
+		return 1;
+	}
+
+	BenchRunner runner(options);
+
+	KalaCLI::RunDispatchBenchmarks(runner);
+	KalaCLI::RunStringBenchmarks(runner);
+	KalaCLI::RunFileBenchmarks(runner);
+	KalaCLI::RunImporterBenchmarks(runner);
+
+	remove_all(options.scratchDir, ec);
+
+	const string json = runner.ToJSON();
+
+	if (outFile.empty())
+	{
+		fwrite(json.data(), 1, json.size(), stdout);
+		return 0;
+	}
+
+	ofstream out(outFile, ios::binary);
+	out.write(json.data(), scast<streamsize>(json.size()));
+	if (!out)
+	{
+		fprintf(stderr, "Failed to write results to '%s'!\n", outFile.string().c_str());
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,131 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include <random>
+
+#include "KalaHeaders/string_utils.hpp"
+#include "KalaHeaders/log_utils.hpp"
+
+#include "bench.hpp"
+
+using KalaHeaders::KalaString::TokenizeString;
+using KalaHeaders::KalaString::SplitString;
+using KalaHeaders::KalaLog::Log;
+using KalaHeaders::KalaLog::TimeFormat;
+
+using KalaCLI::BenchRunner;
+using KalaCLI::BENCH_SEED;
+
+using std::string;
+using std::vector;
+using std::to_string;
+using std::mt19937;
+using std::uniform_int_distribution;
+
+//Lines split per run, and for the quick run
+constexpr size_t STRING_LINE_COUNT = 100000;
+constexpr size_t QUICK_STRING_LINE_COUNT = 10000;
+
+//Time stamps formatted per run, the same count as a busy log writes in a fraction of a second
+constexpr size_t TIME_STAMP_COUNT = 1000000;
+
+//A command-like line of a few words with a quoted span every few words
+static string MakeLine(mt19937& rng)
+{
+	uniform_int_distribution<int> pickCount(2, 12);
+	uniform_int_distribution<int> pickLength(1, 16);
+
+	string line{};
+
+	const int wordCount = pickCount(rng);
+	for (int w = 0; w < wordCount; ++w)
+	{
+		if (w > 0) line += ' ';
+
+		const bool isQuoted = w % 4 == 3;
+		if (isQuoted) line += '"';
+
+		const int length = pickLength(rng);
+		for (int c = 0; c < length; ++c) line += scast<char>('a' + (c + w) % 26);
+
+		//quoted spans hide a space from the splitter
+		if (isQuoted) line += " word\"";
+	}
+
+	return line;
+}
+
+namespace KalaCLI
+{
+	void RunStringBenchmarks(BenchRunner& runner)
+	{
+		//what every Print with a time stamp pays before the message is written
+		auto runTimeStamps = [&runner](
+			const string& name,
+			TimeFormat format)
+			{
+				runner.Run(
+					name,
+					TIME_STAMP_COUNT,
+					0,
+					[format]()
+					{
+						u64 length{};
+						for (size_t i = 0; i < TIME_STAMP_COUNT; ++i) length += Log::GetTime(format).size();
+						BenchRunner::Consume(length);
+					});
+			};
+
+		runTimeStamps("strings/log_time_hms_ms", TimeFormat::TIME_HMS_MS);
+		runTimeStamps("strings/log_time_12h", TimeFormat::TIME_12H);
+		runTimeStamps("strings/log_time_elapsed", TimeFormat::TIME_ELAPSED);
+
+		if (!runner.IsSelected("strings/tokenize_string")
+			&& !runner.IsSelected("strings/split_string"))
+		{
+			return;
+		}
+
+		mt19937 rng(BENCH_SEED);
+
+		const size_t lineCount = runner.GetOptions().quick
+			? QUICK_STRING_LINE_COUNT
+			: STRING_LINE_COUNT;
+
+		vector<string> lines{};
+		lines.reserve(lineCount);
+
+		u64 totalSize{};
+		for (size_t i = 0; i < lineCount; ++i)
+		{
+			lines.push_back(MakeLine(rng));
+			totalSize += lines.back().size();
+		}
+
+		const string splitter = " ";
+
+		runner.Run(
+			"strings/tokenize_string",
+			lineCount,
+			totalSize,
+			[&lines, &splitter]()
+			{
+				u64 parts{};
+				for (const auto& line : lines) parts += TokenizeString(line, '"', splitter).size();
+				BenchRunner::Consume(parts);
+			});
+
+		runner.Run(
+			"strings/split_string",
+			lineCount,
+			totalSize,
+			[&lines, &splitter]()
+			{
+				u64 parts{};
+				for (const auto& line : lines) parts += SplitString(line, splitter).size();
+				BenchRunner::Consume(parts);
+			});
+	}
+}
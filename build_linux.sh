@@ -0,0 +1,51 @@
+#!/bin/bash
+
+# Set the working directory to the script's location
+PROJECT_ROOT="$(cd "$(dirname "$0")" && pwd)"
+cd "$PROJECT_ROOT" || exit 1
+
+# ================================
+# Build with a given preset
+# $1 = preset name
+# ================================
+BuildWithPreset()
+{
+	if [ -z "$1" ]; then
+		echo "[ERROR] No preset name provided to BuildWithPreset!"
+		exit 1
+	fi
+
+	PRESET="$1"
+
+	echo "====================================="
+	echo "[INFO] Building in $PRESET mode..."
+	echo "====================================="
+	echo
+
+	echo "[INFO] Configuring with preset: $PRESET"
+	if ! cmake --preset "$PRESET"; then
+		echo "[ERROR] Configuration failed"
+		exit 1
+	fi
+
+	echo "[INFO] Building with preset: $PRESET"
+	if ! cmake --build --preset "$PRESET"; then
+		echo "[ERROR] Build failed"
+		exit 1
+	fi
+
+	echo
+	echo "[SUCCESS] Finished building preset: $PRESET"
+	echo
+}
+
+# ================================
+# Run builds
+# ================================
+BuildWithPreset linux-debug
+BuildWithPreset linux-release
+
+echo "====================================="
+echo "[SUCCESS] Finished building and installing!"
+echo "====================================="
+echo
@@ -0,0 +1,87 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "KalaHeaders/core_utils.hpp"
+#include "KalaHeaders/math_utils.hpp"
+
+namespace KalaCLI
+{
+	using std::string;
+	using std::string_view;
+	using std::vector;
+
+	//A single character of the trie, children are a sibling list sorted by character
+	//so every walk visits words in lexicographic order
+	struct AliasTrieNode
+	{
+		u32 firstChild = UINT32_MAX; //UINT32_MAX means no children
+		u32 nextSibling = UINT32_MAX;
+		char c{};
+		bool isWord{}; //true if the path from the root to this node is an inserted word
+	};
+
+	//A word found by AliasTrie::FindSimilar and its edit distance to the searched word
+	struct AliasMatch
+	{
+		string word{};
+		size_t distance{};
+	};
+
+	//Prefix trie of every command primary variant, words are only ever added so that
+	//the trie can be updated incrementally while commands are registered
+	class LIB_API AliasTrie
+	{
+	public:
+		//Adds word to the trie, adding the same word twice does nothing
+		void Insert(string_view word);
+
+		//Appends up to maxResults words that start with prefix in lexicographic order,
+		//an empty prefix matches every word
+		void Complete(
+			string_view prefix,
+			size_t maxResults,
+			vector<string>& outWords) const;
+
+		//Appends up to maxResults words within maxDistance insertions, deletions or
+		//substitutions of word, closest first and lexicographic within the same distance.
+		//Branches whose prefix is already further than maxDistance are never walked
+		void FindSimilar(
+			string_view word,
+			size_t maxDistance,
+			size_t maxResults,
+			vector<AliasMatch>& outMatches) const;
+
+		size_t GetWordCount() const { return wordCount; }
+	private:
+		//Node 0 is the root and holds no character
+		vector<AliasTrieNode> nodes{ AliasTrieNode{} };
+		size_t wordCount{};
+
+		//Returns the child of parent holding c, or UINT32_MAX if there is none
+		u32 FindChild(
+			u32 parent,
+			char c) const;
+
+		void CollectWords(
+			u32 node,
+			string& path,
+			size_t maxResults,
+			vector<string>& outWords) const;
+
+		void CollectSimilar(
+			u32 node,
+			string_view word,
+			size_t maxDistance,
+			vector<size_t>& rows,
+			string& path,
+			vector<AliasMatch>& outMatches) const;
+	};
+}
@@ -0,0 +1,88 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <filesystem>
+
+#include "KalaHeaders/core_utils.hpp"
+#include "KalaHeaders/math_utils.hpp"
+
+namespace KalaCLI
+{
+	using std::string;
+	using std::vector;
+	using std::filesystem::path;
+
+	enum class AssetType : u8
+	{
+		ASSET_KFD, //kalafontdata, glyphs
+		ASSET_KMD  //kalamodeldata, models
+	};
+
+	//One model or glyph table of an inspected file
+	struct AssetTable
+	{
+		u32 charCode{};      //glyph char code, 0 for kmd
+		string nodeName{};   //model node name, empty for kfd
+		u32 blockOffset{};
+		u32 blockSize{};
+	};
+
+	//What the header and tables of one kfd or kmd file hold, its blocks are never read
+	struct AssetSummary
+	{
+		path target{};
+		AssetType type{};
+		uintmax_t fileSize{};
+		u8 version{};
+		u32 count{};              //glyph or model count from the header
+		u32 tableSize{};          //combined size of all tables
+		u32 blockSize{};          //combined size of all blocks
+		u32 tableCount{};         //tables that were actually found
+		u32 outOfRangeCount{};    //tables whose block reaches past the end of the file
+		u8 fontType{};            //kfd only, 1 is per-glyph and 2 is bitmap
+		u16 glyphHeight{};        //kfd only
+		u8 scaleFactor{};         //kmd only
+		vector<AssetTable> tables{};  //only filled if keepTables was passed
+		string error{};           //why the file couldn't be inspected, empty on success
+	};
+
+	//Totals of every file of an AssetInspector::InspectPath call
+	struct InspectStats
+	{
+		u64 fileCount{};        //kfd and kmd files that were found
+		u64 kfdCount{};
+		u64 kmdCount{};
+		u64 failedCount{};      //files whose header or tables were invalid
+		u64 glyphCount{};       //sum of the glyph counts of every valid kfd
+		u64 modelCount{};       //sum of the model counts of every valid kmd
+		u64 outOfRangeCount{};  //tables of every valid file whose block reaches past the end of its file
+		uintmax_t totalSize{};  //bytes of every found file
+		uintmax_t tableSize{};  //table bytes of every valid file
+		uintmax_t blockSize{};  //block bytes of every valid file
+		u64 elapsedMS{};
+	};
+
+	class LIB_API AssetInspector
+	{
+	public:
+		//Reads only the header and tables of the target kfd or kmd file, or of every kfd and kmd file
+		//inside the target folder and its subfolders. Folder files are inspected in batches on the
+		//shared thread pool and skip the per-file open checks, because the walk already found them.
+		//outFiles is sorted by path and keeps the tables of each file only with keepTables.
+		//Returns an empty string on success or the reason why the target couldn't be inspected
+		static string InspectPath(
+			const path& target,
+			bool keepTables,
+			vector<AssetSummary>& outFiles,
+			InspectStats& outStats);
+
+		//Returns true if the path has the kfd or kmd extension
+		static bool IsAsset(const path& target);
+	};
+}
@@ -0,0 +1,83 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <string>
+#include <filesystem>
+#include <functional>
+
+#include "KalaHeaders/core_utils.hpp"
+#include "KalaHeaders/math_utils.hpp"
+#include "KalaHeaders/log_utils.hpp"
+
+namespace KalaCLI
+{
+	using std::string;
+	using std::string_view;
+	using std::function;
+	using std::filesystem::path;
+	using KalaHeaders::KalaLog::LogType;
+
+	//First bytes of every binary log file, 'KLOG' in little-endian
+	constexpr u32 BINARY_LOG_MAGIC = 0x474F4C4B;
+	constexpr u32 BINARY_LOG_VERSION = 1;
+
+	//Magic and version
+	constexpr size_t BINARY_LOG_HEADER_SIZE = 8;
+
+	//Buffered records are written to the file once they grow past this size
+	constexpr size_t BINARY_LOG_FLUSH_SIZE = 65536;
+
+	//How many distinct tags one file can intern, prints with further tags are dropped
+	constexpr size_t MAX_BINARY_LOG_TAGS = 65535;
+
+	//Every record starts with its kind, all numbers are little-endian
+	enum class BinaryRecordKind : u8
+	{
+		//u8 kind, u8 LogType, u16 tag id, u64 microseconds since epoch, u32 message length, message
+		RECORD_MESSAGE = 0,
+
+		//u8 kind, u16 tag id, u8 tag length, tag, written before the first message of that tag
+		RECORD_TAG = 1
+	};
+
+	//A decoded message, the views point into the read file and are only valid during the callback
+	struct BinaryLogRecord
+	{
+		u64 timestampUS{};
+		LogType type{};
+		string_view tag{};
+		string_view message{};
+	};
+
+	//Which records BinaryLog::Read passes on, a default filter passes every record
+	struct BinaryLogFilter
+	{
+		u8 typeMask = 0xFF;  //bit 1 << LogType of every passed type
+		string_view tag{};   //only this tag if not empty
+	};
+
+	class LIB_API BinaryLog
+	{
+	public:
+		//Starts writing every tagged Log::Print to target as binary records instead of text,
+		//errors are still printed as text too. Target is replaced if it exists
+		static string Open(const path& target);
+
+		//Writes every buffered record, stops recording and closes the file
+		static void Close();
+
+		static bool IsOpen();
+
+		//Decodes every record of origin in order and calls onRecord for those that pass filter.
+		//Records that don't pass are skipped by their length without reading their message.
+		//A record cut short by a crash ends the file without an error
+		static string Read(
+			const path& origin,
+			const BinaryLogFilter& filter,
+			const function<void(const BinaryLogRecord&)>& onRecord);
+	};
+}
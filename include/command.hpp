@@ -8,21 +8,39 @@
 #include <string>
 #include <vector>
 #include <functional>
+#include <span>
+#include <array>
+#include <algorithm>
+#include <cstdint>
 
 #include "KalaHeaders/core_utils.hpp"
 #include "KalaHeaders/math_utils.hpp"
 
+#include "lexer.hpp"
+#include "alias_trie.hpp"
+#include "param_schema.hpp"
+
 namespace KalaCLI
 {
 	using std::string;
 	using std::string_view;
 	using std::vector;
 	using std::function;
+	using std::span;
+	using std::array;
+	using std::sort;
 
 	//The prefix that must be in front of the primary parameter,
 	//for example '--help', leave empty if you dont want a required prefix
 	constexpr string_view COMMAND_PREFIX = "--";
 
+	//Run option for starting the process as a background job
+	constexpr string_view RUN_ASYNC_FLAG = "--async";
+	//Run option for reading the process stdout through a pipe and printing it once it exits
+	constexpr string_view RUN_CAPTURE_FLAG = "--capture";
+	//Run option for going through the system shell for built-ins, pipes and redirection
+	constexpr string_view RUN_SHELL_FLAG = "--shell";
+
 	struct LIB_API Command
 	{
 		//Variants for the primary keyword that determines the desired action,
@@ -36,20 +54,281 @@ namespace KalaCLI
 		//Range should be 1-255
 		u8 paramCount{};
 
+		//Optional upper limit for commands that take trailing options,
+		//params between paramCount and this are accepted. 0 means exactly paramCount
+		u8 maxParamCount{};
+
 		//Reference to the target function you want this command to call,
 		//must contain vector<string> as its only parameter to be able to receive user-passed parameters
 		function<void(const vector<string>&)> targetFunction{};
+
+		//Allocation-free alternative to targetFunction, receives views into the parsed parameters
+		//that are only valid for the duration of the call. Used instead of targetFunction if both are set
+		function<void(span<const string_view>)> targetViewFunction{};
+
+		//Optional declaration of typed params and options, when set the params are checked and
+		//converted before targetArgsFunction is called and paramCount and maxParamCount are ignored.
+		//Must outlive the command, so declare it as 'static constexpr'
+		const ParamSchema* schema{};
+
+		//Handler of schema commands, receives the already converted arguments
+		function<void(const ParsedArgs&)> targetArgsFunction{};
+
+		//Set to true if the handler can run on a worker thread at the same time as other commands.
+		//Commands that aren't thread-safe still run when chained with '&&&',
+		//but only after the thread-safe commands of the same chain have finished
+		bool isThreadSafe{};
+	};
+
+	//How many similar commands are suggested when a command doesn't exist
+	constexpr size_t MAX_SUGGESTIONS = 3;
+
+	//How many primary variants are listed by completion unless the caller asks for another count
+	constexpr size_t MAX_COMPLETIONS = 64;
+
+	//How many primary variants a static command can have at most
+	constexpr size_t MAX_STATIC_ALIASES = 4;
+
+	//How many static command tables can be added
+	constexpr size_t MAX_STATIC_TABLES = 8;
+
+	//64-bit FNV-1a hash of a primary variant, shared by the runtime alias index and static command tables
+	constexpr u64 HashAlias(string_view alias)
+	{
+		u64 hash = 14695981039346656037ULL;
+		for (char c : alias)
+		{
+			hash ^= scast<unsigned char>(c);
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
+
+	//Handler of a static command, receives the same params as Command::targetViewFunction
+	using StaticCommandFunction = void(*)(span<const string_view> params);
+
+	//Handler of a static schema command, receives the same arguments as Command::targetArgsFunction
+	using StaticArgsFunction = void(*)(const ParsedArgs& args);
+
+	//Command known at compile time, fields mean the same as in Command
+	//but nothing is allocated and the handler is called through a plain function pointer.
+	//Build tables of these with MakeCommandTable and add them with CommandManager::AddStaticCommands
+	struct StaticCommand
+	{
+		//Unused trailing variants are left empty
+		array<string_view, MAX_STATIC_ALIASES> primary{};
+
+		string_view description{};
+
+		u8 paramCount{};
+		u8 maxParamCount{};
+
+		StaticCommandFunction targetFunction{};
+
+		const ParamSchema* schema{};
+		StaticArgsFunction targetArgsFunction{};
+
+		bool isThreadSafe{};
+	};
+
+	//A primary variant of a static command table, tables keep these sorted by hash
+	struct StaticAlias
+	{
+		u64 hash{};
+		u32 commandIndex{};
+		u32 aliasIndex{};
+	};
+
+	//Commands and their primary variants sorted by hash, built at compile time by MakeCommandTable
+	template<size_t N>
+	struct StaticCommandTable
+	{
+		array<StaticCommand, N> commands{};
+		array<StaticAlias, N * MAX_STATIC_ALIASES> aliases{};
+		size_t aliasCount{};
+	};
+
+	//Builds a sorted static command table at compile time, a command without a primary variant,
+	//param count or handler, an invalid schema or a primary variant used twice fails to compile.
+	//Duplicates with runtime commands and other tables are checked by CommandManager::AddStaticCommands
+	template<typename... T>
+	consteval auto MakeCommandTable(const T&... commands)
+	{
+		StaticCommandTable<sizeof...(T)> table{ { commands... } };
+
+		for (size_t c = 0; c < table.commands.size(); ++c)
+		{
+			const StaticCommand& command = table.commands[c];
+
+			const bool hasTarget = command.schema
+				? command.targetArgsFunction != nullptr
+				: command.paramCount != 0 && command.targetFunction != nullptr;
+
+			if (command.primary[0].empty()
+				|| !hasTarget)
+			{
+				throw "static command has no primary variant, param count or target function";
+			}
+
+			if (command.schema
+				&& !IsValidSchema(*command.schema))
+			{
+				throw "static command schema is invalid";
+			}
+
+			for (size_t a = 0; a < MAX_STATIC_ALIASES; ++a)
+			{
+				string_view alias = command.primary[a];
+				if (alias.empty()) continue;
+
+				if (alias == "run"
+					|| alias == "r")
+				{
+					throw "static command uses a primary variant of the built-in run command";
+				}
+
+				for (size_t i = 0; i < table.aliasCount; ++i)
+				{
+					const StaticAlias& other = table.aliases[i];
+					if (table.commands[other.commandIndex].primary[other.aliasIndex] == alias)
+					{
+						throw "static command primary variant is already in use";
+					}
+				}
+
+				table.aliases[table.aliasCount++] = { HashAlias(alias), scast<u32>(c), scast<u32>(a) };
+			}
+		}
+
+		sort(
+			table.aliases.begin(),
+			table.aliases.begin() + table.aliasCount,
+			[](const StaticAlias& a, const StaticAlias& b) { return a.hash < b.hash; });
+
+		return table;
+	}
+
+	//A static command table added to CommandManager, the table itself is never copied
+	struct StaticTableView
+	{
+		span<const StaticCommand> commands{};
+		span<const StaticAlias> aliases{};
+		size_t firstIndex{}; //index of the first command of this table across all added tables
+	};
+
+	//A single open-addressing slot of the alias index,
+	//points to the alias by command and primary variant index instead of
+	//owning it so that growing the commands vector never invalidates it
+	struct AliasSlot
+	{
+		u64 hash{};
+		u32 commandIndex = UINT32_MAX; //UINT32_MAX means the slot is empty
+		u32 aliasIndex{};
 	};
 
 	class LIB_API CommandManager
 	{
 	public:
+		//All registered commands in registration order, used for enumeration.
+		//Always add new commands through AddCommand so that the alias index stays in sync
 		static inline vector<Command> commands{};
 
-		//Parse given strings from end user
+		//Parse given strings from end user, returns false if the command couldn't run
+		//or its handler logged an error
 		static bool ParseCommand(const vector<string>& params);
 
-		//Add new command to commands list
+		//Parse given string views from end user without copying them,
+		//the views only need to stay valid until this call returns
+		static bool ParseCommand(span<const string_view> params);
+
+		//Runs every chained command of a lexed line and returns how many of them failed.
+		//Commands joined with '&&&' run on the shared thread pool and their output is
+		//printed per command in chain order once the whole group has finished.
+		//Per-line dispatch state comes from the LineArena of the calling thread, which
+		//the outermost ParseLine call rewinds, so steady-state lines don't allocate
+		static size_t ParseLine(const LexedLine& line);
+
+		//Returns true if the command these params would call can run on a worker thread
+		static bool IsThreadSafe(span<const string_view> params);
+
+		//Add new command to commands list.
+		//Must not be called from inside a command handler because
+		//the handler is borrowed from the commands vector while it runs
 		static bool AddCommand(Command newValue);
+
+		//Adds a table built by MakeCommandTable without allocating, its primary variants
+		//must not be in use by any other command. The table must outlive the manager,
+		//so declare it as 'static constexpr' or 'inline constexpr'
+		template<size_t N>
+		static bool AddStaticCommands(const StaticCommandTable<N>& table)
+		{
+			return AddStaticTable(
+				span<const StaticCommand>(table.commands),
+				span<const StaticAlias>(table.aliases.data(), table.aliasCount));
+		}
+
+		//Returns the command that owns this primary variant or nullptr if none does.
+		//The returned pointer is only valid until the next AddCommand call
+		static const Command* FindCommand(string_view alias);
+
+		//Returns the static command that owns this primary variant or nullptr if none does
+		static const StaticCommand* FindStaticCommand(string_view alias);
+
+		//Appends up to maxResults primary variants of every command, including the built-in run command,
+		//that start with prefix in lexicographic order. The prefix must not contain COMMAND_PREFIX
+		static void CompleteCommand(
+			string_view prefix,
+			vector<string>& outAliases,
+			size_t maxResults = MAX_COMPLETIONS);
+
+		//Appends up to MAX_SUGGESTIONS primary variants within one or two typos
+		//of a name that doesn't exist, closest first
+		static void SuggestCommands(
+			string_view name,
+			vector<string>& outAliases);
+
+		//Changes every time a command or static table is added, lets callers cache
+		//output built from the registry and rebuild it only after registration
+		static u64 GetRegistrationVersion();
+
+		//Returns the count of static commands across all added tables
+		static size_t GetStaticCommandCount();
+
+		//Returns the static command at index across all added tables in the order they were added
+		static const StaticCommand& GetStaticCommand(size_t index);
+	private:
+		//Every primary variant of both kinds of commands, only used for completion and suggestions
+		static inline AliasTrie aliasTrie{};
+		static inline u64 registrationVersion{};
+
+		static inline array<StaticTableView, MAX_STATIC_TABLES> staticTables{};
+		static inline size_t staticTableCount{};
+		static inline size_t staticCommandCount{};
+
+		static bool AddStaticTable(
+			span<const StaticCommand> commands,
+			span<const StaticAlias> aliases);
+
+		//Adds a primary variant to the alias trie, the first call also adds the built-in run command
+		static void InsertCompletion(string_view alias);
+
+		//Returns the static command that owns this primary variant and its index across all tables
+		static const StaticCommand* FindStatic(
+			string_view alias,
+			size_t& outIndex);
+
+		//Open-addressing hash table from every primary variant to its command,
+		//capacity is always a power of two and kept at most half full
+		static inline vector<AliasSlot> aliasIndex{};
+		static inline size_t aliasCount{};
+
+		//Returns the index of the slot holding this alias,
+		//or the first empty slot where it would be inserted
+		static size_t FindSlot(
+			string_view alias,
+			u64 hash);
+
+		//Doubles the alias index capacity and re-inserts all existing aliases
+		static void GrowIndex();
 	};
 }
\ No newline at end of file
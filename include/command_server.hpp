@@ -0,0 +1,58 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <string>
+#include <span>
+
+#include "KalaHeaders/core_utils.hpp"
+#include "KalaHeaders/math_utils.hpp"
+
+namespace KalaCLI
+{
+	using std::string;
+	using std::string_view;
+	using std::span;
+
+	//Kinds of frames the server streams back to the client, every frame is
+	//one kind byte, a little-endian u32 payload size and the payload
+	enum class ServerFrame : u8
+	{
+		FRAME_STDOUT = 0, //output the command printed to stdout
+		FRAME_STDERR = 1, //output the command printed to stderr
+		FRAME_RESULT = 2  //last frame, a single byte that is 1 if the command succeeded
+	};
+
+	//Keeps a registered cli warm so that repeated invocations only pay for a connection.
+	//The endpoint is a pipe name on Windows, where '\\.\pipe\' is prepended if missing,
+	//and a Unix socket path everywhere else
+	class LIB_API CommandServer
+	{
+	public:
+		//Listens on endpoint and dispatches every forwarded command on the calling thread
+		//one at a time, streaming its output back to the client that sent it.
+		//Returns once a served command asks the cli to exit,
+		//or an error if the endpoint couldn't be opened or is already served.
+		//Only the user running the server may connect, the socket file is owner-only
+		//and clients of other users are rejected, on Windows the pipe only grants access to that user
+		static string Serve(const string& endpoint);
+
+		//Sends params and the current directory to the server listening on endpoint
+		//and writes its output to stdout and stderr as it arrives.
+		//Returns an error without sending anything if no server is listening,
+		//otherwise outSucceeded is set to the dispatch result of the server
+		static string Forward(
+			const string& endpoint,
+			span<const string_view> params,
+			bool& outSucceeded);
+
+		//Returns true while Serve is dispatching commands
+		static bool IsServing();
+
+		//Makes Serve return once the command it is dispatching has finished
+		static void RequestStop();
+	};
+}
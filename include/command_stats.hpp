@@ -0,0 +1,79 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "KalaHeaders/core_utils.hpp"
+#include "KalaHeaders/math_utils.hpp"
+
+namespace KalaCLI
+{
+	using std::string;
+	using std::vector;
+
+	//Latency histogram buckets, values below 4 ns get a bucket each
+	//and every power of two above that is split into four buckets
+	constexpr size_t LATENCY_BUCKET_COUNT = 252;
+
+	//Command index that the first static command is recorded under,
+	//runtime commands at or past this index in CommandManager::commands only count towards the totals
+	constexpr u32 STATIC_COMMAND_INDEX_BASE = 32768;
+
+	//Command index of dispatches that only count towards the totals
+	constexpr u32 UNRECORDED_COMMAND_INDEX = UINT32_MAX - 2;
+	//Command index that 'run' is recorded under, it is dispatched before the registered commands
+	constexpr u32 RUN_COMMAND_INDEX = UINT32_MAX - 1;
+	//Command index of dispatches whose command couldn't be found
+	constexpr u32 UNKNOWN_COMMAND_INDEX = UINT32_MAX;
+
+	//Totals of one command across every thread
+	struct CommandTimings
+	{
+		string name{};           //first primary variant of the command
+		u64 invocationCount{};   //calls that found this command, including the failed ones
+		u64 failureCount{};      //calls rejected before the handler ran, whose handler logged an error or where 'run' failed
+		u64 totalNS{};           //time spent inside the handler
+		u64 maxNS{};
+		u64 p50NS{};             //upper bound of the histogram bucket holding the median
+		u64 p99NS{};
+	};
+
+	//Totals of every ParseCommand call since the process started
+	struct StatsSnapshot
+	{
+		vector<CommandTimings> commands{}; //invoked commands in registration order, static commands first and 'run' last
+		u64 dispatchCount{};  //every ParseCommand call
+		u64 unknownCount{};   //calls whose command was missing its prefix or didn't exist
+		u64 parseNS{};        //prefix and param checks and building the handler params
+		u64 lookupNS{};       //finding the command by name
+		u64 executeNS{};      //inside handlers, nested dispatches are also counted by their own call
+	};
+
+	class LIB_API CommandStats
+	{
+	public:
+		//Adds one dispatch to the counters of the calling thread, never locks
+		//once the thread has recorded its first dispatch.
+		//  - commandIndex: index in CommandManager::commands, STATIC_COMMAND_INDEX_BASE plus the static command index,
+		//                  or one of RUN_COMMAND_INDEX, UNKNOWN_COMMAND_INDEX and UNRECORDED_COMMAND_INDEX
+		//  - wasExecuted: false if the call was rejected before the handler ran
+		//  - succeeded: false if the call was rejected, its handler logged an error or 'run' failed
+		static void Record(
+			u32 commandIndex,
+			bool wasExecuted,
+			bool succeeded,
+			u64 parseNS,
+			u64 lookupNS,
+			u64 executeNS);
+
+		//Sums the counters of every thread that has recorded a dispatch.
+		//Counts may trail dispatches still running on other threads by a few calls
+		static StatsSnapshot GetSnapshot();
+	};
+}
@@ -0,0 +1,86 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <functional>
+
+#include "KalaHeaders/core_utils.hpp"
+#include "KalaHeaders/math_utils.hpp"
+
+namespace KalaCLI
+{
+	using std::string;
+	using std::vector;
+	using std::function;
+	using std::filesystem::path;
+
+	//How far a running copy has come, passed to CopyOptions::onProgress
+	struct CopyProgress
+	{
+		u64 doneFileCount{};    //files that were copied, skipped or failed so far
+		u64 totalFileCount{};   //regular files found in the origin tree
+		uintmax_t doneSize{};   //bytes of the files counted in doneFileCount
+		uintmax_t totalSize{};  //bytes of every regular file found in the origin tree
+	};
+
+	struct CopyOptions
+	{
+		//replace files that already exist in target, otherwise they are left as they are
+		bool overwrite{};
+		//only copy files that are missing from target or whose size or last write time differ,
+		//changed files are replaced even without overwrite
+		bool incremental{};
+		//called at most once per COPY_PROGRESS_INTERVAL_MS from whichever thread finished a file,
+		//so it must be safe to call from any thread
+		function<void(const CopyProgress&)> onProgress{};
+	};
+
+	//Milliseconds between two calls of CopyOptions::onProgress
+	constexpr u32 COPY_PROGRESS_INTERVAL_MS = 1000;
+
+	//Totals of a finished CopyEngine::CopyPath or CopyEngine::MovePath
+	struct CopyStats
+	{
+		u64 fileCount{};         //regular files found in the origin tree
+		u64 copiedCount{};       //files whose contents were written to target
+		uintmax_t copiedSize{};  //bytes written to target
+		u64 skippedCount{};      //files left alone because they existed or were unchanged
+		u64 directoryCount{};    //folders created or reused in target
+		u64 linkCount{};         //symbolic links recreated in target, never followed
+		u64 elapsedMS{};
+		bool wasRenamed{};       //true if MovePath moved origin with a single rename
+		vector<string> failures{};  //reason of every file or folder that couldn't be copied
+	};
+
+	class LIB_API CopyEngine
+	{
+	public:
+		//Copies the origin file or folder to the target path. The origin tree is walked once
+		//on the calling thread to create the folders, then the files are copied in batches
+		//on the shared thread pool with the OS copy offload where the platform has one.
+		//Files that fail are listed in outStats.failures and don't stop the rest.
+		//Returns an empty string on success or the reason why the copy couldn't start
+		//or why some of it failed
+		static string CopyPath(
+			const path& origin,
+			const path& target,
+			const CopyOptions& options,
+			CopyStats& outStats);
+
+		//Moves the origin file or folder to the target path with a rename if possible,
+		//or with CopyPath and then deleting origin if target is on another volume.
+		//An existing target is only replaced with options.overwrite, and only after origin
+		//has been renamed or fully copied next to it, origin and target are kept if any part of the copy failed
+		static string MovePath(
+			const path& origin,
+			const path& target,
+			const CopyOptions& options,
+			CopyStats& outStats);
+	};
+}
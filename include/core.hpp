@@ -7,13 +7,71 @@
 
 #include <string>
 #include <functional>
+#include <istream>
 
 #include "KalaHeaders/core_utils.hpp"
 
 namespace KalaCLI
 {
 	using std::string;
+	using std::string_view;
 	using std::function;
+	using std::istream;
+
+	//Launch flag for running every line of a script file as a command
+	constexpr string_view SCRIPT_FLAG = "--script";
+	//Launch flag for running every line piped into stdin as a command
+	constexpr string_view STDIN_BATCH_FLAG = "--stdin-batch";
+	//Launch flag for printing the per-command stats as JSON to stderr on exit,
+	//must come before every other launch flag
+	constexpr string_view PROFILE_FLAG = "--profile";
+	//Launch flag for printing only the data of help, info, list, go, where and complete,
+	//without headings or bullets, must come before every other launch flag
+	constexpr string_view PLAIN_FLAG = "--plain";
+	//Launch flag for writing every tagged log print to the next parameter's file as binary records
+	//instead of text, must come before every other launch flag
+	constexpr string_view BINARY_LOG_FLAG = "--binary-log";
+	//Launch flag for staying open and dispatching commands forwarded to the next parameter's endpoint
+	constexpr string_view SERVE_FLAG = "--serve";
+	//Launch flag for forwarding the params after the next parameter's endpoint to a server,
+	//the command runs in this process instead if no server is listening
+	constexpr string_view CLIENT_FLAG = "--client";
+
+	//List option for walking into every subfolder
+	constexpr string_view LIST_RECURSIVE_FLAG = "--recursive";
+	//List option for stopping after the next parameter's count of listed entries
+	constexpr string_view LIST_LIMIT_FLAG = "--limit";
+	//List option for only listing entries whose name matches the next parameter's glob pattern
+	constexpr string_view LIST_FILTER_FLAG = "--filter";
+
+	//Disk usage option for rescanning every folder instead of reusing unchanged cached folders
+	constexpr string_view DU_NO_CACHE_FLAG = "--no-cache";
+
+	//Find-bytes separator between the searched patterns and the searched files
+	constexpr string_view FIND_BYTES_IN_FLAG = "--in";
+	//Find-bytes pattern prefix for passing raw bytes as hex digits, for example '0xDEADBEEF'
+	constexpr string_view FIND_BYTES_HEX_PREFIX = "0x";
+
+	//Copy and move option for replacing files that already exist in the target
+	constexpr string_view COPY_OVERWRITE_FLAG = "--overwrite";
+	//Copy option for only copying files whose size or last write time differ from the target
+	constexpr string_view COPY_INCREMENTAL_FLAG = "--incremental";
+
+	//Inspect option for printing one JSON object per file and one for the totals instead of text
+	constexpr string_view INSPECT_JSON_FLAG = "--json";
+	//Inspect option for listing the tables of every file, a single file always lists them
+	constexpr string_view INSPECT_TABLES_FLAG = "--tables";
+
+	//Stats option for printing the per-command stats as one JSON object instead of text
+	constexpr string_view STATS_JSON_FLAG = "--json";
+
+	//Watch option for stopping the watch started earlier
+	constexpr string_view WATCH_STOP_FLAG = "--stop";
+
+	//Logdump option for only listing records of the next parameter's log type
+	constexpr string_view LOGDUMP_TYPE_FLAG = "--type";
+	//Logdump option for only listing records of the next parameter's tag
+	constexpr string_view LOGDUMP_TAG_FLAG = "--tag";
 
 	class LIB_API Core
 	{
@@ -24,5 +82,12 @@ namespace KalaCLI
 			int argc,
 			char* argv[],
 			function<void()> AddExternalCommands);
+
+		//Reads the stream in chunks of chunkSize bytes and dispatches every line
+		//as a command without prompting, then prints a summary of failed lines and elapsed time.
+		//Returns the count of commands that failed to dispatch or whose handler logged an error
+		static size_t RunBatch(
+			istream& in,
+			size_t chunkSize);
 	};
 }
\ No newline at end of file
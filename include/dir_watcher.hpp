@@ -0,0 +1,73 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <string>
+#include <filesystem>
+#include <functional>
+
+#include "KalaHeaders/core_utils.hpp"
+#include "KalaHeaders/math_utils.hpp"
+#include "KalaHeaders/file_utils.hpp"
+
+#include "disk_usage.hpp"
+
+namespace KalaCLI
+{
+	using std::string;
+	using std::string_view;
+	using std::function;
+	using std::filesystem::path;
+	using KalaHeaders::KalaFile::VisitResult;
+
+	//How many bytes of change events are read from the system at once
+	constexpr size_t WATCH_EVENT_BUFFER_SIZE = 64ULL * 1024;
+
+	//One entry of a watched folder passed to DirectoryWatcher::VisitDirectory,
+	//the views are only valid during the visitor call
+	struct WatchedEntry
+	{
+		string_view relativePath{}; //from the visited folder, with subfolders joined by the platform separator
+		string_view name{};
+		bool isDirectory{};         //true for folders and links to folders, like directory_entry::is_directory
+	};
+
+	//Keeps a snapshot of one folder tree up to date from the change events of the system
+	//instead of walking the tree again.
+	//Pending events are applied by every query before it answers, so a query always sees
+	//every change the system reported before it and costs only as much as the changes since the last one.
+	//Queries for paths outside the watched tree return false so callers can fall back to walking it.
+	//If the system drops events the tree is scanned again, if a folder can't be watched anymore
+	//watching stops so that no query ever answers from an outdated snapshot
+	class LIB_API DirectoryWatcher
+	{
+	public:
+		//Scans target and starts watching it and every subfolder, replaces the tree watched so far
+		static string Start(const path& target);
+
+		//Stops watching and frees the snapshot
+		static void Stop();
+
+		static bool IsWatching();
+
+		//Watched folder, empty if nothing is watched
+		static string GetRoot();
+
+		//Calls visitor for every entry of target folder from the snapshot, with optional recursive flag.
+		//Subfolders are visited right after their own entry like recursive_directory_iterator does.
+		//Returns false without calling visitor if target isn't inside the watched tree
+		static bool VisitDirectory(
+			const path& target,
+			const function<VisitResult(const WatchedEntry&)>& visitor,
+			bool recursive = false);
+
+		//Fills outSize with the totals of target folder from the snapshot, every folder counts as cached.
+		//Returns false if target isn't inside the watched tree
+		static bool GetDirectorySize(
+			const path& target,
+			DirectorySize& outSize);
+	};
+}
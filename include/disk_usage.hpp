@@ -0,0 +1,65 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <filesystem>
+#include <mutex>
+
+#include "KalaHeaders/core_utils.hpp"
+#include "KalaHeaders/math_utils.hpp"
+
+namespace KalaCLI
+{
+	using std::string;
+	using std::vector;
+	using std::unordered_map;
+	using std::mutex;
+	using std::filesystem::path;
+	using std::filesystem::file_time_type;
+
+	//Totals of a directory tree measured with DiskUsage::GetDirectorySize
+	struct DirectorySize
+	{
+		uintmax_t size{};      //total bytes of all regular files, symbolic links are not followed
+		u64 fileCount{};       //regular files that were counted
+		u64 directoryCount{};  //subfolders that were walked, not counting the target itself
+		u64 skippedCount{};    //subfolders that couldn't be opened and were left out
+		u64 cachedCount{};     //folders whose own files were taken from the cache instead of rescanned
+	};
+
+	//What is remembered about one folder between scans
+	struct CachedDirectory
+	{
+		file_time_type lastWrite{};    //folder mtime when it was scanned
+		uintmax_t ownSize{};           //bytes of the regular files directly inside it
+		u64 ownFileCount{};
+		vector<path> subdirectories{}; //direct subfolders, each with its own cache entry
+	};
+
+	class LIB_API DiskUsage
+	{
+	public:
+		//Measures the target folder with every subfolder scanned as its own task on the shared thread pool.
+		//With useCache a folder whose mtime hasn't changed since its last scan reuses its remembered file sizes,
+		//note that a folder mtime only changes when entries are added, removed or renamed,
+		//files that grow in place keep their old size until their folder changes or the cache is cleared.
+		//With useCache a folder inside the tree watched by DirectoryWatcher is answered from its snapshot instead.
+		//Returns an empty string on success or the reason why the target couldn't be measured
+		static string GetDirectorySize(
+			const path& target,
+			DirectorySize& outSize,
+			bool useCache = true);
+
+		//Forgets every cached folder
+		static void ClearCache();
+	private:
+		static inline unordered_map<string, CachedDirectory> cache{};
+		static inline mutex cacheMutex{};
+	};
+}
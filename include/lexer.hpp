@@ -0,0 +1,71 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <span>
+
+#include "KalaHeaders/core_utils.hpp"
+#include "KalaHeaders/math_utils.hpp"
+
+namespace KalaCLI
+{
+	using std::string;
+	using std::string_view;
+	using std::vector;
+	using std::span;
+
+	//The symbol that separates chained commands on a single line
+	constexpr char CHAIN_SEPARATOR = '&';
+	//The symbol that chains commands which are started at the same time on worker threads
+	constexpr string_view PARALLEL_SEPARATOR = "&&&";
+
+	//Range of tokens in LexedLine::tokens that belong to one chained command
+	struct LexedCommand
+	{
+		u32 first{};
+		u32 count{};
+		bool isParallelWithNext{}; //true if '&&&' joins this command to the next one
+	};
+
+	//Reusable result of a single lexed line, keep one alive across lines
+	//so that its buffers are only reallocated when a line outgrows them
+	struct LIB_API LexedLine
+	{
+		//Copy of the line that all tokens point into, quotes are stripped in place
+		string buffer{};
+
+		//Tokens of every chained command in order of appearance
+		vector<string_view> tokens{};
+
+		//One entry per chained command, empty commands are skipped
+		vector<LexedCommand> commands{};
+
+		//Returns the tokens of the chained command at this index
+		span<const string_view> GetCommand(size_t index) const
+		{
+			const LexedCommand& c = commands[index];
+			return span<const string_view>(tokens.data() + c.first, c.count);
+		}
+	};
+
+	class LIB_API Lexer
+	{
+	public:
+		//Splits a line into chained commands and their tokens in a single pass.
+		//  - whitespace runs separate tokens
+		//  - '&' separates chained commands that run one after another
+		//  - '&&&' separates chained commands that run at the same time
+		//  - text between "double" or 'single' quotes is kept as part of one token,
+		//    the other quote style and '&' are treated as plain characters inside it
+		//  - an unterminated quote runs to the end of the line
+		static void Tokenize(
+			string_view line,
+			LexedLine& outLine);
+	};
+}
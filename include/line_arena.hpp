@@ -0,0 +1,89 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <memory_resource>
+
+#include "KalaHeaders/core_utils.hpp"
+#include "KalaHeaders/math_utils.hpp"
+
+namespace KalaCLI
+{
+	using std::array;
+	using std::atomic;
+	using std::mutex;
+	using std::pmr::memory_resource;
+
+	//Size of the first block, large enough for the dispatch state of a long '&&&' chain
+	constexpr size_t ARENA_FIRST_BLOCK_SIZE = 65536;
+
+	//How many blocks one line can grow into, each block is at least twice the size of the last one
+	constexpr size_t MAX_ARENA_BLOCKS = 32;
+
+	//Monotonic bump allocator for everything that lives only as long as one input line.
+	//Deallocating does nothing, Reset rewinds the arena for the next line and keeps its memory,
+	//so once the arena has grown to the largest line it never touches the heap again.
+	//Allocating is lock-free and safe from every thread of a '&&&' group, only a full block takes a lock
+	class LIB_API LineArena : public memory_resource
+	{
+	public:
+		LineArena() = default;
+		~LineArena() override;
+
+		LineArena(const LineArena&) = delete;
+		LineArena& operator=(const LineArena&) = delete;
+
+		//Arena of the line being dispatched on the calling thread, null outside CommandManager::ParseLine.
+		//Handlers can allocate temporaries from it that are released with the line
+		static LineArena* GetCurrent() { return current; }
+		static void SetCurrent(LineArena* arena) { current = arena; }
+
+		//Frees every allocation at once, must not be called while anything from this arena is still in use.
+		//A line that needed more than one block is merged into a single block of the same total size
+		void Reset();
+
+		//Bytes handed out since the last Reset, including alignment padding
+		size_t GetUsedSize() const;
+
+		//Bytes held by every block
+		size_t GetCapacity() const;
+	private:
+		static inline thread_local LineArena* current{};
+
+		struct Block
+		{
+			char* data{};
+			size_t size{};
+		};
+
+		//Blocks are only ever added until Reset, so a published block never moves
+		array<Block, MAX_ARENA_BLOCKS> blocks{};
+		atomic<size_t> blockCount{};
+
+		//Index of the block being bumped in the upper bits and its used bytes in the lower bits,
+		//packed so that moving to the next block and bumping can't interleave
+		atomic<u64> state{};
+
+		//Taken only to add a block
+		mutex growMutex{};
+
+		void* do_allocate(
+			size_t bytes,
+			size_t alignment) override;
+
+		void do_deallocate(void*, size_t, size_t) override {}
+
+		bool do_is_equal(const memory_resource& other) const noexcept override
+		{
+			return this == &other;
+		}
+
+		void FreeBlocks();
+	};
+}
@@ -0,0 +1,124 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <string>
+#include <charconv>
+#include <type_traits>
+#include <atomic>
+
+#include "KalaHeaders/core_utils.hpp"
+#include "KalaHeaders/math_utils.hpp"
+
+namespace KalaCLI
+{
+	using std::string;
+	using std::string_view;
+	using std::atomic;
+	using std::to_chars;
+	using std::is_integral_v;
+	using std::is_floating_point_v;
+	using std::memory_order_relaxed;
+
+	//Buffered output is written once it grows past this size while stdout is a console,
+	//small enough that long listings still show up while they are being built
+	constexpr size_t CONSOLE_FLUSH_SIZE = 4096;
+
+	//Buffered output is written once it grows past this size while stdout is a file or pipe
+	constexpr size_t REDIRECTED_FLUSH_SIZE = 65536;
+
+	enum class OutputStyle : u8
+	{
+		OUTPUT_DECORATED = 0, //headings, bullets and blank lines for reading in a console
+		OUTPUT_PLAIN     = 1  //only the data, one value per line for scripts and pipes
+	};
+
+	//Growable text buffer that command handlers write their output into instead of building
+	//a string and printing it. Each thread has one sink whose buffer keeps its capacity
+	//between commands, it is written out through Log::PrintRaw in large pieces so captures
+	//and the async log sink still see every byte, and CommandManager::ParseCommand flushes it
+	//after every handler. Handlers must flush before printing through Log::Print directly
+	//so that their buffered output stays in front of it
+	class LIB_API OutputSink
+	{
+	public:
+		//Returns the sink of the calling thread
+		static OutputSink& Get();
+
+		static void SetStyle(OutputStyle newStyle) { style.store(newStyle, memory_order_relaxed); }
+		static OutputStyle GetStyle() { return style.load(memory_order_relaxed); }
+		static bool IsPlain() { return GetStyle() == OutputStyle::OUTPUT_PLAIN; }
+
+		//Returns true if stdout is a file or pipe instead of a console, checked once per process
+		static bool IsRedirected();
+
+		OutputSink& Append(string_view text)
+		{
+			buffer.append(text);
+			return FlushIfFull();
+		}
+		OutputSink& Append(const char* text) { return Append(string_view(text)); }
+		OutputSink& Append(const string& text) { return Append(string_view(text)); }
+		OutputSink& Append(char c)
+		{
+			buffer.push_back(c);
+			return FlushIfFull();
+		}
+
+		//Appends integers and floats without going through a locale,
+		//floats use the shortest text that reads back as the same value
+		template<typename T>
+			requires (is_integral_v<T> || is_floating_point_v<T>)
+		OutputSink& Append(T value)
+		{
+			char text[64]{};
+			auto [end, ec] = to_chars(text, text + sizeof(text), value);
+			buffer.append(text, scast<size_t>(end - text));
+			return FlushIfFull();
+		}
+
+		//Appends pattern with every '{}' replaced by the next argument in order, like std::format_to
+		//without format specs. Arguments past the last '{}' are dropped and unfilled fields are kept as text
+		template<typename... Args>
+		OutputSink& Format(
+			string_view pattern,
+			const Args&... args)
+		{
+			(AppendField(pattern, args), ...);
+			return Append(pattern);
+		}
+
+		//Writes everything buffered so far, keeping the buffer capacity for the next command
+		void Flush();
+
+		//Everything buffered since the last flush
+		string_view View() const { return buffer; }
+		size_t Size() const { return buffer.size(); }
+	private:
+		static inline atomic<OutputStyle> style{ OutputStyle::OUTPUT_DECORATED };
+
+		string buffer{};
+		size_t flushSize = CONSOLE_FLUSH_SIZE;
+
+		OutputSink& FlushIfFull()
+		{
+			if (buffer.size() >= flushSize) Flush();
+			return *this;
+		}
+
+		//Appends pattern up to its next '{}' and removes both from pattern,
+		//returns false and leaves pattern untouched if there are no fields left
+		bool AppendUntilField(string_view& pattern);
+
+		template<typename T>
+		void AppendField(
+			string_view& pattern,
+			const T& arg)
+		{
+			if (AppendUntilField(pattern)) Append(arg);
+		}
+	};
+}
@@ -0,0 +1,148 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <string>
+#include <array>
+#include <span>
+#include <cstdint>
+
+#include "KalaHeaders/core_utils.hpp"
+#include "KalaHeaders/math_utils.hpp"
+
+namespace KalaCLI
+{
+	using std::string;
+	using std::string_view;
+	using std::array;
+	using std::span;
+
+	//How many positional params a schema command can receive, including the repeats of a variadic one
+	constexpr size_t MAX_PARSED_PARAMS = 32;
+
+	//How many named options a schema can declare
+	constexpr size_t MAX_PARSED_OPTIONS = 16;
+
+	//Separator between the choices of an enum param, for example 'fast|safe'
+	constexpr char PARAM_CHOICE_SEPARATOR = '|';
+
+	enum class ParamType : u8
+	{
+		PARAM_STRING = 0, //any text
+		PARAM_INT    = 1, //signed 64-bit integer within minValue and maxValue
+		PARAM_FLOAT  = 2, //64-bit float
+		PARAM_PATH   = 3, //non-empty text, handlers resolve it against Core::currentDir
+		PARAM_ENUM   = 4, //one of the choices, stored as its index in intValue
+		PARAM_FLAG   = 5  //option that takes no value, only valid for options
+	};
+
+	//A positional param or named option of a ParamSchema
+	struct ParamSpec
+	{
+		//Shown in errors and usage for positional params, matched as '<name>' or '<name>=<value>'
+		//for options, so option names should start with COMMAND_PREFIX like '--limit'
+		string_view name{};
+
+		ParamType type{};
+
+		//PARAM_ENUM only, every choice separated by PARAM_CHOICE_SEPARATOR
+		string_view choices{};
+
+		//PARAM_INT only, both limits are inclusive
+		i64 minValue = INT64_MIN;
+		i64 maxValue = INT64_MAX;
+	};
+
+	//Declares the params a command accepts so they are checked and converted
+	//in one pass before the handler runs. Usually declared constexpr next to the handler
+	struct ParamSchema
+	{
+		//Positional params after the command name, in order
+		span<const ParamSpec> params{};
+
+		//Named options, accepted anywhere after the command name
+		span<const ParamSpec> options{};
+
+		//How many positional params must be passed
+		u8 minCount{};
+
+		//If true the last positional param repeats up to MAX_PARSED_PARAMS times
+		bool isVariadic{};
+	};
+
+	//A converted param or option, text always holds the passed value
+	struct ParsedArg
+	{
+		string_view text{};
+		i64 intValue{};
+		f64 floatValue{};
+		bool isSet{}; //false for options that weren't passed and positional params past positionalCount
+	};
+
+	//Every argument of one call, sized up front so parsing never allocates.
+	//The views point into the dispatched params and are only valid while the handler runs
+	struct ParsedArgs
+	{
+		//Command name without COMMAND_PREFIX
+		string_view name{};
+
+		array<ParsedArg, MAX_PARSED_PARAMS> params{};
+		u8 paramCount{};
+
+		//In the order of ParamSchema::options
+		array<ParsedArg, MAX_PARSED_OPTIONS> options{};
+	};
+
+	class LIB_API ParamParser
+	{
+	public:
+		//Checks and converts params in a single pass, params must not include the command name.
+		//Returns an error naming the first param that didn't fit the schema
+		static string Parse(
+			const ParamSchema& schema,
+			string_view name,
+			span<const string_view> params,
+			ParsedArgs& outArgs);
+
+		//Returns a usage line such as '<target:path> [--limit <int>] [--recursive]'
+		static string FormatUsage(const ParamSchema& schema);
+	};
+
+	//Returns true if the schema can be parsed, checked by MakeCommandTable at compile time
+	//and by CommandManager::AddCommand for runtime commands
+	constexpr bool IsValidSchema(const ParamSchema& schema)
+	{
+		if (schema.params.size() > MAX_PARSED_PARAMS
+			|| schema.options.size() > MAX_PARSED_OPTIONS
+			|| schema.minCount > schema.params.size()
+			|| (schema.isVariadic && schema.params.empty()))
+		{
+			return false;
+		}
+
+		for (const auto& p : schema.params)
+		{
+			if (p.type == ParamType::PARAM_FLAG
+				|| (p.type == ParamType::PARAM_ENUM && p.choices.empty())
+				|| p.minValue > p.maxValue)
+			{
+				return false;
+			}
+		}
+
+		for (const auto& o : schema.options)
+		{
+			if (o.name.empty()
+				|| (o.type == ParamType::PARAM_ENUM && o.choices.empty())
+				|| o.minValue > o.maxValue)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,71 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <span>
+#include <mutex>
+
+#include "KalaHeaders/core_utils.hpp"
+#include "KalaHeaders/math_utils.hpp"
+
+namespace KalaCLI
+{
+	using std::string;
+	using std::string_view;
+	using std::vector;
+	using std::span;
+	using std::mutex;
+
+	//A child process started with ProcessLauncher::StartJob
+	struct ProcessJob
+	{
+		u32 id{};              //job id shown to the user, starts from 1
+		string commandLine{};  //the passed arguments joined for display only
+		u64 handle{};          //process handle on Windows, pid everywhere else
+		bool waiting{};        //true while WaitJob is blocking on this job
+		bool finished{};       //true once the process has exited and was reaped
+		int exitCode{};        //only valid once finished is true
+	};
+
+	class LIB_API ProcessLauncher
+	{
+	public:
+		//Starts args[0] directly without a shell, with the rest of args as its arguments,
+		//and waits for it to exit. If outCapture is not null then the child stdout
+		//is read through a pipe into it instead of being printed to the console.
+		//Returns an empty string on success or the reason why launching failed
+		static string Run(
+			span<const string_view> args,
+			int& outExitCode,
+			string* outCapture = nullptr);
+
+		//Runs the command line through the system shell, only needed for
+		//shell built-ins, pipes and redirection
+		static string RunShell(
+			string_view commandLine,
+			int& outExitCode);
+
+		//Starts args[0] like Run but returns immediately with the id of the new job
+		static string StartJob(
+			span<const string_view> args,
+			u32& outJobID);
+
+		//Blocks until the job has exited and returns its exit code
+		static string WaitJob(
+			u32 jobID,
+			int& outExitCode);
+
+		//Reaps all finished jobs and returns a snapshot of every job started so far
+		static vector<ProcessJob> GetJobs();
+	private:
+		static inline vector<ProcessJob> jobs{};
+		static inline u32 nextJobID = 1;
+		static inline mutex jobsMutex{};
+	};
+}
@@ -0,0 +1,191 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include <algorithm>
+#include <utility>
+
+#include "alias_trie.hpp"
+
+using KalaCLI::AliasTrieNode;
+using KalaCLI::AliasMatch;
+
+using std::string;
+using std::string_view;
+using std::vector;
+using std::min;
+using std::stable_sort;
+using std::move;
+
+namespace KalaCLI
+{
+	void AliasTrie::Insert(string_view word)
+	{
+		u32 node = 0;
+
+		for (char c : word)
+		{
+			//find the sibling to insert after so the list stays sorted
+			u32 previous = UINT32_MAX;
+			u32 child = nodes[node].firstChild;
+			while (child != UINT32_MAX
+				&& nodes[child].c < c)
+			{
+				previous = child;
+				child = nodes[child].nextSibling;
+			}
+
+			if (child == UINT32_MAX
+				|| nodes[child].c != c)
+			{
+				const u32 added = scast<u32>(nodes.size());
+
+				AliasTrieNode newNode{};
+				newNode.c = c;
+				newNode.nextSibling = child;
+				nodes.push_back(newNode);
+
+				if (previous == UINT32_MAX) nodes[node].firstChild = added;
+				else nodes[previous].nextSibling = added;
+
+				child = added;
+			}
+
+			node = child;
+		}
+
+		if (!nodes[node].isWord)
+		{
+			nodes[node].isWord = true;
+			++wordCount;
+		}
+	}
+
+	void AliasTrie::Complete(
+		string_view prefix,
+		size_t maxResults,
+		vector<string>& outWords) const
+	{
+		u32 node = 0;
+		for (char c : prefix)
+		{
+			node = FindChild(node, c);
+			if (node == UINT32_MAX) return;
+		}
+
+		string path(prefix);
+		CollectWords(node, path, maxResults, outWords);
+	}
+
+	void AliasTrie::FindSimilar(
+		string_view word,
+		size_t maxDistance,
+		size_t maxResults,
+		vector<AliasMatch>& outMatches) const
+	{
+		//one row of the edit distance table per trie depth, the root row is the distance to an empty prefix
+		vector<size_t> rows(word.size() + 1);
+		for (size_t i = 0; i <= word.size(); ++i) rows[i] = i;
+
+		vector<AliasMatch> matches{};
+		string path{};
+
+		for (u32 child = nodes[0].firstChild; child != UINT32_MAX; child = nodes[child].nextSibling)
+		{
+			CollectSimilar(child, word, maxDistance, rows, path, matches);
+		}
+
+		//matches are found in lexicographic order, so a stable sort by distance keeps that order within ties
+		stable_sort(matches.begin(), matches.end(),
+			[](const AliasMatch& a, const AliasMatch& b)
+			{
+				return a.distance < b.distance;
+			});
+
+		for (size_t i = 0; i < matches.size() && i < maxResults; ++i)
+		{
+			outMatches.push_back(move(matches[i]));
+		}
+	}
+
+	u32 AliasTrie::FindChild(
+		u32 parent,
+		char c) const
+	{
+		for (u32 child = nodes[parent].firstChild; child != UINT32_MAX; child = nodes[child].nextSibling)
+		{
+			if (nodes[child].c == c) return child;
+			if (nodes[child].c > c) break;
+		}
+		return UINT32_MAX;
+	}
+
+	void AliasTrie::CollectWords(
+		u32 node,
+		string& path,
+		size_t maxResults,
+		vector<string>& outWords) const
+	{
+		if (outWords.size() >= maxResults) return;
+
+		if (nodes[node].isWord) outWords.push_back(path);
+
+		for (u32 child = nodes[node].firstChild; child != UINT32_MAX; child = nodes[child].nextSibling)
+		{
+			if (outWords.size() >= maxResults) return;
+
+			path.push_back(nodes[child].c);
+			CollectWords(child, path, maxResults, outWords);
+			path.pop_back();
+		}
+	}
+
+	void AliasTrie::CollectSimilar(
+		u32 node,
+		string_view word,
+		size_t maxDistance,
+		vector<size_t>& rows,
+		string& path,
+		vector<AliasMatch>& outMatches) const
+	{
+		const size_t columns = word.size() + 1;
+		const size_t parentRow = path.size() * columns;
+		const size_t row = parentRow + columns;
+
+		if (rows.size() < row + columns) rows.resize(row + columns);
+
+		const char c = nodes[node].c;
+		path.push_back(c);
+
+		rows[row] = rows[parentRow] + 1;
+		size_t rowMin = rows[row];
+
+		for (size_t i = 1; i < columns; ++i)
+		{
+			const size_t substitution = rows[parentRow + i - 1] + (word[i - 1] == c ? 0 : 1);
+			const size_t insertion = rows[row + i - 1] + 1;
+			const size_t deletion = rows[parentRow + i] + 1;
+
+			rows[row + i] = min(substitution, min(insertion, deletion));
+			rowMin = min(rowMin, rows[row + i]);
+		}
+
+		if (nodes[node].isWord
+			&& rows[row + columns - 1] <= maxDistance)
+		{
+			outMatches.push_back({ path, rows[row + columns - 1] });
+		}
+
+		//every longer word below this node is at least rowMin edits away
+		if (rowMin <= maxDistance)
+		{
+			for (u32 child = nodes[node].firstChild; child != UINT32_MAX; child = nodes[child].nextSibling)
+			{
+				CollectSimilar(child, word, maxDistance, rows, path, outMatches);
+			}
+		}
+
+		path.pop_back();
+	}
+}
@@ -0,0 +1,274 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include <future>
+#include <chrono>
+#include <algorithm>
+#include <system_error>
+#include <cstring>
+
+#include "KalaHeaders/thread_utils.hpp"
+#include "KalaHeaders/file_utils.hpp"
+#include "KalaHeaders/import_kfd.hpp"
+#include "KalaHeaders/import_kmd.hpp"
+
+#include "asset_inspector.hpp"
+
+namespace KalaFontData = KalaHeaders::KalaFontData;
+namespace KalaModelData = KalaHeaders::KalaModelData;
+
+using KalaHeaders::KalaThread::ThreadPool;
+using KalaHeaders::KalaFile::VisitDirectoryContents;
+using KalaHeaders::KalaFile::VisitResult;
+
+using KalaCLI::AssetInspector;
+using KalaCLI::AssetType;
+using KalaCLI::AssetTable;
+using KalaCLI::AssetSummary;
+using KalaCLI::InspectStats;
+
+using std::string;
+using std::vector;
+using std::future;
+using std::sort;
+using std::min;
+using std::move;
+using std::error_code;
+using std::chrono::steady_clock;
+using std::chrono::duration_cast;
+using std::chrono::milliseconds;
+using std::filesystem::path;
+using std::filesystem::directory_entry;
+using std::filesystem::is_directory;
+using std::filesystem::is_regular_file;
+using std::filesystem::exists;
+using std::filesystem::file_size;
+
+//A pool task inspects this many files, each file is only a few small reads
+constexpr size_t INSPECT_BATCH_FILE_COUNT = 64;
+
+//Fills the header fields of a kfd summary, the tables are read unless the header is invalid
+static void InspectFont(
+	AssetSummary& summary,
+	bool skipChecks,
+	bool keepTables)
+{
+	using KalaFontData::ImportResult;
+
+	summary.type = AssetType::ASSET_KFD;
+
+	KalaFontData::GlyphHeader header{};
+	ImportResult result = KalaFontData::GetHeaderData(
+		summary.target,
+		header,
+		skipChecks);
+
+	if (result == ImportResult::RESULT_SUCCESS)
+	{
+		summary.version = header.version;
+		summary.count = header.glyphCount;
+		summary.tableSize = header.glyphTableSize;
+		summary.blockSize = header.glyphBlockSize;
+		summary.fontType = header.type;
+		summary.glyphHeight = header.glyphHeight;
+
+		vector<KalaFontData::GlyphTable> tables{};
+		result = KalaFontData::GetTableData(
+			summary.target,
+			tables,
+			true);
+
+		summary.tableCount = scast<u32>(tables.size());
+		for (const auto& t : tables)
+		{
+			if (scast<uintmax_t>(t.blockOffset) + t.blockSize > summary.fileSize) ++summary.outOfRangeCount;
+			if (keepTables) summary.tables.push_back({ t.charCode, {}, t.blockOffset, t.blockSize });
+		}
+	}
+
+	if (result != ImportResult::RESULT_SUCCESS)
+	{
+		summary.error = "Failed to inspect '" + summary.target.string() + "'! Reason: " + KalaFontData::ResultToString(result);
+	}
+}
+
+//Fills the header fields of a kmd summary, the tables are read unless the header is invalid
+static void InspectModel(
+	AssetSummary& summary,
+	bool skipChecks,
+	bool keepTables)
+{
+	using KalaModelData::ImportResult;
+
+	summary.type = AssetType::ASSET_KMD;
+
+	KalaModelData::ModelHeader header{};
+	ImportResult result = KalaModelData::GetHeaderData(
+		summary.target,
+		header,
+		skipChecks);
+
+	if (result == ImportResult::RESULT_SUCCESS)
+	{
+		summary.version = header.version;
+		summary.count = header.modelCount;
+		summary.tableSize = header.modelTablesSize;
+		summary.blockSize = header.modelBlocksSize;
+		summary.scaleFactor = header.scaleFactor;
+
+		vector<KalaModelData::ModelTable> tables{};
+		result = KalaModelData::GetTableData(
+			summary.target,
+			tables,
+			true);
+
+		summary.tableCount = scast<u32>(tables.size());
+		for (const auto& t : tables)
+		{
+			if (scast<uintmax_t>(t.blockOffset) + t.blockSize > summary.fileSize) ++summary.outOfRangeCount;
+			if (keepTables)
+			{
+				//node names are fixed-length and not guaranteed to be terminated
+				const size_t length = strnlen(t.nodeName, sizeof(t.nodeName));
+				summary.tables.push_back({ 0, string(t.nodeName, length), t.blockOffset, t.blockSize });
+			}
+		}
+	}
+
+	if (result != ImportResult::RESULT_SUCCESS)
+	{
+		summary.error = "Failed to inspect '" + summary.target.string() + "'! Reason: " + KalaModelData::ResultToString(result);
+	}
+}
+
+static void InspectFile(
+	AssetSummary& summary,
+	bool skipChecks,
+	bool keepTables)
+{
+	if (summary.target.extension() == ".kfd") InspectFont(summary, skipChecks, keepTables);
+	else InspectModel(summary, skipChecks, keepTables);
+}
+
+namespace KalaCLI
+{
+	bool AssetInspector::IsAsset(const path& target)
+	{
+		const path extension = target.extension();
+		return extension == ".kfd"
+			|| extension == ".kmd";
+	}
+
+	string AssetInspector::InspectPath(
+		const path& target,
+		bool keepTables,
+		vector<AssetSummary>& outFiles,
+		InspectStats& outStats)
+	{
+		const auto startTime = steady_clock::now();
+
+		outFiles.clear();
+		outStats = {};
+
+		error_code ec{};
+		if (!exists(target, ec))
+		{
+			return "Failed to inspect target '" + target.string() + "' because it does not exist!";
+		}
+
+		vector<AssetSummary> files{};
+
+		if (!is_directory(target, ec))
+		{
+			if (!IsAsset(target))
+			{
+				return "Failed to inspect target '" + target.string() + "' because it is not a kfd or kmd file!";
+			}
+
+			AssetSummary& summary = files.emplace_back();
+			summary.target = target;
+			summary.fileSize = file_size(target, ec);
+
+			//a single file gets the full open checks
+			InspectFile(summary, false, keepTables);
+		}
+		else
+		{
+			string result = VisitDirectoryContents(
+				target,
+				[&files](const directory_entry& entry)
+				{
+					error_code entryEC{};
+					if (entry.is_regular_file(entryEC)
+						&& IsAsset(entry.path()))
+					{
+						AssetSummary& summary = files.emplace_back();
+						summary.target = entry.path();
+						summary.fileSize = entry.file_size(entryEC);
+					}
+
+					return VisitResult::VISIT_CONTINUE;
+				},
+				true);
+
+			if (!result.empty()) return result;
+
+			ThreadPool& pool = ThreadPool::GetShared();
+			vector<future<void>> tasks{};
+			tasks.reserve(files.size() / INSPECT_BATCH_FILE_COUNT + 1);
+
+			//every task writes only the summaries of its own batch
+			for (size_t batchStart = 0; batchStart < files.size(); batchStart += INSPECT_BATCH_FILE_COUNT)
+			{
+				const size_t batchEnd = min(batchStart + INSPECT_BATCH_FILE_COUNT, files.size());
+
+				tasks.push_back(pool.Submit([&files, keepTables, batchStart, batchEnd]()
+					{
+						for (size_t i = batchStart; i < batchEnd; ++i)
+						{
+							InspectFile(files[i], true, keepTables);
+						}
+					}));
+			}
+
+			for (auto& task : tasks) pool.Await(task);
+
+			sort(
+				files.begin(),
+				files.end(),
+				[](const AssetSummary& a, const AssetSummary& b)
+				{
+					return a.target < b.target;
+				});
+		}
+
+		for (const auto& file : files)
+		{
+			++outStats.fileCount;
+			outStats.totalSize += file.fileSize;
+
+			if (file.type == AssetType::ASSET_KFD) ++outStats.kfdCount;
+			else ++outStats.kmdCount;
+
+			if (!file.error.empty())
+			{
+				++outStats.failedCount;
+				continue;
+			}
+
+			if (file.type == AssetType::ASSET_KFD) outStats.glyphCount += file.count;
+			else outStats.modelCount += file.count;
+
+			outStats.outOfRangeCount += file.outOfRangeCount;
+			outStats.tableSize += file.tableSize;
+			outStats.blockSize += file.blockSize;
+		}
+
+		outFiles = move(files);
+		outStats.elapsedMS = scast<u64>(duration_cast<milliseconds>(steady_clock::now() - startTime).count());
+
+		return{};
+	}
+}
@@ -0,0 +1,315 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include <vector>
+#include <span>
+#include <fstream>
+#include <mutex>
+#include <chrono>
+
+#include "KalaHeaders/file_utils.hpp"
+
+#include "binary_log.hpp"
+
+using KalaHeaders::KalaLog::Log;
+using KalaHeaders::KalaLog::LogType;
+using KalaHeaders::KalaFile::MappedFile;
+using KalaHeaders::KalaFile::WriteU8;
+using KalaHeaders::KalaFile::WriteU16;
+using KalaHeaders::KalaFile::WriteU32;
+using KalaHeaders::KalaFile::WriteU64;
+using KalaHeaders::KalaFile::WriteFixedString;
+
+using KalaCLI::BinaryRecordKind;
+using KalaCLI::BinaryLogRecord;
+using KalaCLI::BINARY_LOG_MAGIC;
+using KalaCLI::BINARY_LOG_VERSION;
+using KalaCLI::BINARY_LOG_HEADER_SIZE;
+using KalaCLI::BINARY_LOG_FLUSH_SIZE;
+using KalaCLI::MAX_BINARY_LOG_TAGS;
+
+using std::string;
+using std::string_view;
+using std::to_string;
+using std::vector;
+using std::span;
+using std::ofstream;
+using std::ios;
+using std::mutex;
+using std::lock_guard;
+using std::chrono::system_clock;
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+using std::filesystem::path;
+
+//Size of a message record before its message
+constexpr size_t MESSAGE_RECORD_SIZE = 16;
+
+//Size of a tag record before its tag
+constexpr size_t TAG_RECORD_SIZE = 4;
+
+//Appended to by every printing thread, so all of it is only touched under writeMutex
+struct BinaryLogState
+{
+	mutex writeMutex{};
+	ofstream file{};
+	vector<u8> buffer{};
+	vector<string> tags{}; //index is the tag id
+};
+
+//Never destroyed so that pool threads which print during static destruction can still record safely
+static BinaryLogState& GetState()
+{
+	static BinaryLogState* state = new BinaryLogState{};
+	return *state;
+}
+
+//Readers of the mapped log, the caller checks that the whole value is inside data
+static u8 ReadU8(
+	span<const u8> data,
+	size_t offset)
+{
+	return data[offset];
+}
+static u16 ReadU16(
+	span<const u8> data,
+	size_t offset)
+{
+	return scast<u16>(data[offset]
+		| (data[offset + 1] << 8));
+}
+static u32 ReadU32(
+	span<const u8> data,
+	size_t offset)
+{
+	return scast<u32>(data[offset])
+		| (scast<u32>(data[offset + 1]) << 8)
+		| (scast<u32>(data[offset + 2]) << 16)
+		| (scast<u32>(data[offset + 3]) << 24);
+}
+static u64 ReadU64(
+	span<const u8> data,
+	size_t offset)
+{
+	return scast<u64>(ReadU32(data, offset))
+		| (scast<u64>(ReadU32(data, offset + 4)) << 32);
+}
+
+//Must be called under writeMutex
+static void WriteBuffer(BinaryLogState& state)
+{
+	if (state.buffer.empty()) return;
+
+	state.file.write(
+		rcast<const char*>(state.buffer.data()),
+		scast<std::streamsize>(state.buffer.size()));
+	state.buffer.clear();
+}
+
+//Installed as the record sink of Log, only the tag lookup and a few appends run per print
+static void RecordPrint(
+	void* context,
+	LogType type,
+	string_view target,
+	string_view message)
+{
+	BinaryLogState& state = *scast<BinaryLogState*>(context);
+
+	const u64 timestamp = scast<u64>(duration_cast<microseconds>(system_clock::now().time_since_epoch()).count());
+
+	lock_guard lock(state.writeMutex);
+
+	//closed while this print was on its way
+	if (!state.file.is_open()) return;
+
+	vector<u8>& buffer = state.buffer;
+	constexpr size_t append = scast<size_t>(-1);
+
+	//a handful of tags per program, so a linear scan beats hashing
+	size_t tagID{};
+	while (tagID < state.tags.size()
+		&& state.tags[tagID] != target)
+	{
+		++tagID;
+	}
+
+	if (tagID == state.tags.size())
+	{
+		if (tagID == MAX_BINARY_LOG_TAGS) return;
+
+		state.tags.emplace_back(target);
+
+		//Log clamps tags to 50 characters, so the length always fits in a byte
+		WriteU8(buffer, append, scast<u8>(BinaryRecordKind::RECORD_TAG));
+		WriteU16(buffer, append, scast<u16>(tagID));
+		WriteU8(buffer, append, scast<u8>(target.size()));
+		WriteFixedString(buffer, append, target, target.size());
+	}
+
+	const size_t length = message.size() < UINT32_MAX
+		? message.size()
+		: UINT32_MAX;
+
+	WriteU8(buffer, append, scast<u8>(BinaryRecordKind::RECORD_MESSAGE));
+	WriteU8(buffer, append, scast<u8>(type));
+	WriteU16(buffer, append, scast<u16>(tagID));
+	WriteU64(buffer, append, timestamp);
+	WriteU32(buffer, append, scast<u32>(length));
+	WriteFixedString(buffer, append, message, length);
+
+	//errors are written right away so that they survive a crash
+	if (type == LogType::LOG_ERROR)
+	{
+		WriteBuffer(state);
+		state.file.flush();
+	}
+	else if (buffer.size() >= BINARY_LOG_FLUSH_SIZE) WriteBuffer(state);
+}
+
+namespace KalaCLI
+{
+	string BinaryLog::Open(const path& target)
+	{
+		Close();
+
+		BinaryLogState& state = GetState();
+
+		{
+			lock_guard lock(state.writeMutex);
+
+			state.file.open(target, ios::out | ios::binary | ios::trunc);
+			if (!state.file.is_open())
+			{
+				return "Failed to open binary log '" + target.string() + "' for writing!";
+			}
+
+			state.buffer.reserve(BINARY_LOG_FLUSH_SIZE + 1024);
+
+			WriteU32(state.buffer, scast<size_t>(-1), BINARY_LOG_MAGIC);
+			WriteU32(state.buffer, scast<size_t>(-1), BINARY_LOG_VERSION);
+		}
+
+		Log::SetRecordSink(RecordPrint, &state);
+
+		return{};
+	}
+
+	void BinaryLog::Close()
+	{
+		BinaryLogState& state = GetState();
+
+		Log::SetRecordSink(nullptr, nullptr);
+
+		lock_guard lock(state.writeMutex);
+
+		if (!state.file.is_open()) return;
+
+		WriteBuffer(state);
+		state.file.close();
+		state.tags.clear();
+	}
+
+	bool BinaryLog::IsOpen()
+	{
+		BinaryLogState& state = GetState();
+
+		lock_guard lock(state.writeMutex);
+		return state.file.is_open();
+	}
+
+	string BinaryLog::Read(
+		const path& origin,
+		const BinaryLogFilter& filter,
+		const function<void(const BinaryLogRecord&)>& onRecord)
+	{
+		//mapped so that only the pages of records that are actually decoded get read,
+		//skipped messages are stepped over without being copied
+		MappedFile file{};
+		string result = file.Open(origin);
+		if (!result.empty()) return result;
+
+		const span<const u8> data = file.GetBytes();
+
+		if (data.size() < BINARY_LOG_HEADER_SIZE
+			|| ReadU32(data, 0) != BINARY_LOG_MAGIC)
+		{
+			return "File '" + origin.string() + "' is not a binary log!";
+		}
+
+		const u32 version = ReadU32(data, 4);
+		if (version != BINARY_LOG_VERSION)
+		{
+			return "Binary log '" + origin.string() + "' has unsupported version " + to_string(version) + "!";
+		}
+
+		const char* text = rcast<const char*>(data.data());
+
+		vector<string_view> tags{};
+		size_t wantedTagID = SIZE_MAX;
+
+		size_t offset = BINARY_LOG_HEADER_SIZE;
+		while (offset < data.size())
+		{
+			const BinaryRecordKind kind = scast<BinaryRecordKind>(ReadU8(data, offset));
+
+			if (kind == BinaryRecordKind::RECORD_TAG)
+			{
+				if (offset + TAG_RECORD_SIZE > data.size()) break;
+
+				const size_t tagID = ReadU16(data, offset + 1);
+				const size_t length = ReadU8(data, offset + 3);
+
+				const size_t end = offset + TAG_RECORD_SIZE + length;
+				if (end > data.size()) break;
+
+				if (tagID >= tags.size()) tags.resize(tagID + 1);
+				tags[tagID] = string_view(text + offset + TAG_RECORD_SIZE, length);
+
+				if (!filter.tag.empty()
+					&& tags[tagID] == filter.tag)
+				{
+					wantedTagID = tagID;
+				}
+
+				offset = end;
+				continue;
+			}
+
+			if (kind != BinaryRecordKind::RECORD_MESSAGE)
+			{
+				return "Binary log '" + origin.string() + "' has an unknown record at offset " + to_string(offset) + "!";
+			}
+
+			if (offset + MESSAGE_RECORD_SIZE > data.size()) break;
+
+			const size_t length = ReadU32(data, offset + 12);
+			const size_t end = offset + MESSAGE_RECORD_SIZE + length;
+			if (end > data.size()) break;
+
+			const u8 type = ReadU8(data, offset + 1);
+			const size_t tagID = ReadU16(data, offset + 2);
+
+			const bool isPassed = type < 8
+				&& (filter.typeMask & (1u << type)) != 0
+				&& (filter.tag.empty()
+				|| tagID == wantedTagID);
+
+			if (isPassed)
+			{
+				BinaryLogRecord record{};
+				record.timestampUS = ReadU64(data, offset + 4);
+				record.type = scast<LogType>(type);
+				record.tag = tagID < tags.size() ? tags[tagID] : string_view{};
+				record.message = string_view(text + offset + MESSAGE_RECORD_SIZE, length);
+
+				onRecord(record);
+			}
+
+			offset = end;
+		}
+
+		return{};
+	}
+}
@@ -3,20 +3,412 @@
 //This is free software, and you are welcome to redistribute it under certain conditions.
 //Read LICENSE.md for more information.
 
-#include <sstream>
+#include <array>
+#include <deque>
+#include <cstdio>
+#include <chrono>
+#include <new>
+#include <exception>
+#include <memory_resource>
 
 #include "KalaHeaders/log_utils.hpp"
-#include "KalaHeaders/string_utils.hpp"
+#include "KalaHeaders/thread_utils.hpp"
 
 #include "command.hpp"
+#include "process.hpp"
+#include "command_stats.hpp"
+#include "output_sink.hpp"
+#include "line_arena.hpp"
 
 using KalaHeaders::KalaLog::Log;
 using KalaHeaders::KalaLog::LogType;
-using KalaHeaders::KalaString::ContainsString;
-using KalaHeaders::KalaString::RemoveAllFromString;
+using KalaHeaders::KalaLog::LogCapture;
+using KalaHeaders::KalaThread::ThreadPool;
 
-using std::system;
-using std::ostringstream;
+using KalaCLI::ProcessLauncher;
+using KalaCLI::RUN_ASYNC_FLAG;
+using KalaCLI::RUN_CAPTURE_FLAG;
+using KalaCLI::RUN_SHELL_FLAG;
+using KalaCLI::COMMAND_PREFIX;
+using KalaCLI::CommandManager;
+using KalaCLI::AliasMatch;
+using KalaCLI::MAX_SUGGESTIONS;
+using KalaCLI::CommandStats;
+using KalaCLI::RUN_COMMAND_INDEX;
+using KalaCLI::UNKNOWN_COMMAND_INDEX;
+using KalaCLI::UNRECORDED_COMMAND_INDEX;
+using KalaCLI::STATIC_COMMAND_INDEX_BASE;
+using KalaCLI::HashAlias;
+using KalaCLI::StaticCommand;
+using KalaCLI::StaticAlias;
+using KalaCLI::ParamSchema;
+using KalaCLI::ParamParser;
+using KalaCLI::ParsedArgs;
+using KalaCLI::IsValidSchema;
+using KalaCLI::OutputSink;
+using KalaCLI::LineArena;
+
+using std::string;
+using std::to_string;
+using std::move;
+using std::string_view;
+using std::vector;
+using std::array;
+using std::deque;
+using std::span;
+using std::atomic;
+using std::exception_ptr;
+using std::current_exception;
+using std::rethrow_exception;
+using std::memory_order_relaxed;
+using std::memory_order_acq_rel;
+using std::pmr::memory_resource;
+using std::chrono::steady_clock;
+using std::chrono::duration_cast;
+using std::chrono::nanoseconds;
+
+//Starting capacity of the alias index, must be a power of two
+constexpr size_t MIN_INDEX_CAPACITY = 64;
+
+//Names up to this long only get suggestions one typo away, longer ones two
+constexpr size_t MAX_ONE_TYPO_LENGTH = 4;
+
+//How many params are stored on the stack before dispatch falls back to the heap
+constexpr size_t INLINE_PARAM_COUNT = 16;
+
+//Returns ' Did you mean ...?' listing the commands closest to name, or empty if nothing is close
+static string FormatSuggestions(string_view name)
+{
+	vector<string> suggestions{};
+	CommandManager::SuggestCommands(name, suggestions);
+
+	if (suggestions.empty()) return{};
+
+	string result = " Did you mean ";
+	for (size_t i = 0; i < suggestions.size(); ++i)
+	{
+		if (i > 0) result += i + 1 == suggestions.size() ? " or " : ", ";
+		result += "'" + string(COMMAND_PREFIX) + suggestions[i] + "'";
+	}
+	result += "?";
+
+	return result;
+}
+
+//Logs and returns false if the param count doesn't fit the command,
+//shared by runtime and static commands because their fields have the same names
+template<typename T>
+static bool CanDispatch(
+	const T& command,
+	string_view name,
+	size_t paramCount)
+{
+	const size_t maxParamCount = command.maxParamCount > command.paramCount
+		? command.maxParamCount
+		: command.paramCount;
+
+	if (paramCount < command.paramCount
+		|| paramCount > maxParamCount)
+	{
+		Log::Print(
+			"Failed to run command '" + string(name) + "'! Incorrect amount of parameters were passed for the command.",
+			"PARSE",
+			LogType::LOG_ERROR,
+			2);
+
+		return false;
+	}
+
+	if (command.paramCount == 0)
+	{
+		Log::Print(
+			"Target command '" + string(name) + "' has an invalid param count!",
+			"PARSE",
+			LogType::LOG_ERROR,
+			2);
+
+		return false;
+	}
+
+	return true;
+}
+
+//Calls a view handler with the name in place of the prefixed first param,
+//params are views so only the cleaned name needs its own copy
+template<typename F>
+static void CallWithViews(
+	const F& target,
+	string_view name,
+	span<const string_view> params)
+{
+	array<string_view, INLINE_PARAM_COUNT> inlineViews{};
+	vector<string_view> heapViews{};
+
+	span<string_view> cleanedParams{};
+	if (params.size() <= INLINE_PARAM_COUNT) cleanedParams = span(inlineViews.data(), params.size());
+	else
+	{
+		heapViews.resize(params.size());
+		cleanedParams = span(heapViews);
+	}
+
+	cleanedParams[0] = name;
+	for (size_t i = 1; i < params.size(); ++i) cleanedParams[i] = params[i];
+
+	target(span<const string_view>(cleanedParams));
+}
+
+static u64 ToNS(steady_clock::duration duration)
+{
+	return scast<u64>(duration_cast<nanoseconds>(duration).count());
+}
+
+//Times one ParseCommand call and records it in CommandStats when the call returns,
+//everything outside the lookup and the handler counts as parsing
+struct DispatchTimer
+{
+	u32 commandIndex = UNKNOWN_COMMAND_INDEX;
+	bool wasExecuted{};
+	bool succeeded{};
+
+	steady_clock::time_point start = steady_clock::now();
+	steady_clock::duration lookupTime{};
+	steady_clock::duration executeTime{};
+
+	steady_clock::time_point executeStart{};
+	size_t errorCountBefore{};
+
+	//Call right before the handler runs
+	void BeginExecute()
+	{
+		wasExecuted = true;
+		errorCountBefore = Log::GetErrorCount();
+		executeStart = steady_clock::now();
+	}
+
+	//Call right after the handler returns, handlers report failures only by logging them
+	//so the command failed if the handler printed an error on this thread
+	bool EndExecute()
+	{
+		executeTime = steady_clock::now() - executeStart;
+		succeeded = Log::GetErrorCount() == errorCountBefore;
+		return succeeded;
+	}
+
+	~DispatchTimer()
+	{
+		const steady_clock::duration totalTime = steady_clock::now() - start;
+
+		CommandStats::Record(
+			commandIndex,
+			wasExecuted,
+			succeeded,
+			ToNS(totalTime - lookupTime - executeTime),
+			ToNS(lookupTime),
+			ToNS(executeTime));
+	}
+};
+
+//Writes whatever the handler left in the output sink of this thread when ParseCommand returns,
+//so the next command or log print always comes after it
+struct OutputFlush
+{
+	~OutputFlush() { OutputSink::Get().Flush(); }
+};
+
+//Makes the calling thread allocate line state from arena until it goes out of scope,
+//then restores whichever arena was current before
+struct ArenaScope
+{
+	LineArena* previous = LineArena::GetCurrent();
+
+	explicit ArenaScope(LineArena* arena) { LineArena::SetCurrent(arena); }
+	~ArenaScope() { LineArena::SetCurrent(previous); }
+};
+
+//One command of a '&&&' group, allocated from the line arena together with its captured output
+struct ParallelTask
+{
+	explicit ParallelTask(memory_resource* resource) : capture(resource) {}
+
+	LogCapture capture;
+	span<const string_view> params{};
+	bool isThreadSafe{};
+	bool succeeded{};
+	exception_ptr error{};
+};
+
+//Shared by every pool task of a '&&&' group, lives in the line arena
+//so that the last notify of remaining never touches freed memory
+struct ParallelGroup
+{
+	atomic<size_t> remaining{};
+	LineArena* arena{};
+};
+
+//Converts params through the schema and calls target with the parsed arguments,
+//logs and returns false without calling it if they don't fit
+template<typename F>
+static bool DispatchWithSchema(
+	const ParamSchema& schema,
+	const F& target,
+	string_view name,
+	span<const string_view> params,
+	DispatchTimer& timer)
+{
+	ParsedArgs args{};
+	string result = ParamParser::Parse(schema, name, params.subspan(1), args);
+	if (!result.empty())
+	{
+		Log::Print(
+			"Failed to run command '" + string(name) + "'! " + result,
+			"PARSE",
+			LogType::LOG_ERROR,
+			2);
+
+		return false;
+	}
+
+	timer.BeginExecute();
+	target(args);
+	return timer.EndExecute();
+}
+
+//Handles the built-in run command, which is dispatched before the registered commands.
+//Returns false if the process couldn't be started or exited with a non-zero code
+static bool RunProcessCommand(
+	string_view name,
+	span<const string_view> params)
+{
+	bool isAsync{};
+	bool isCapture{};
+	bool isShell{};
+
+	//leading run options, everything after the first non-option belongs to the process
+	size_t first = 1;
+	for (; first < params.size(); ++first)
+	{
+		if (params[first] == RUN_ASYNC_FLAG) isAsync = true;
+		else if (params[first] == RUN_CAPTURE_FLAG) isCapture = true;
+		else if (params[first] == RUN_SHELL_FLAG) isShell = true;
+		else break;
+	}
+
+	if (first == params.size())
+	{
+		Log::Print(
+			"Failed to run command '" + string(name) + "'! You must pass 1 or more argument after the run command.",
+			"PARSE",
+			LogType::LOG_ERROR,
+			2);
+			
+		return false;
+	}
+	if (isShell
+		&& (isAsync
+		|| isCapture))
+	{
+		Log::Print(
+			"Failed to run command '" + string(name) + "'! '--shell' can't be combined with '--async' or '--capture'.",
+			"PARSE",
+			LogType::LOG_ERROR,
+			2);
+
+		return false;
+	}
+
+	span<const string_view> args = params.subspan(first);
+
+	string result{};
+	int exitCode{};
+
+	if (isShell)
+	{
+		//shell built-ins, pipes and redirection still need the system shell.
+		//A single argument is already the whole command line, like 'run --shell "ls | wc -l"',
+		//and goes to the shell unchanged so its pipes and quotes keep their meaning
+		string joined{};
+		if (args.size() == 1) joined = args[0];
+		else
+		{
+			for (size_t i = 0; i < args.size(); ++i)
+			{
+				//the lexer strips quotes, put them back for arguments the shell would split
+				bool needsQuotes = args[i].find_first_of(" \t\"'") != string_view::npos;
+
+				if (!needsQuotes) joined += args[i];
+				else
+				{
+					joined += '"';
+					for (char c : args[i])
+					{
+						if (c == '"') joined += '\\';
+						joined += c;
+					}
+					joined += '"';
+				}
+
+				if (i + 1 < args.size()) joined += ' ';
+			}
+		}
+
+		result = ProcessLauncher::RunShell(joined, exitCode);
+	}
+	else if (isAsync)
+	{
+		u32 jobID{};
+		result = ProcessLauncher::StartJob(args, jobID);
+
+		if (result.empty())
+		{
+			Log::Print("\nStarted job " + to_string(jobID) + ": " + string(args[0]));
+			return true;
+		}
+	}
+	else
+	{
+		//a captured print means this runs in a parallel chain, so the child output
+		//is piped as well to keep it grouped with the rest of this command
+		if (Log::IsCapturing()) isCapture = true;
+
+		string captured{};
+		result = ProcessLauncher::Run(
+			args,
+			exitCode,
+			isCapture ? &captured : nullptr);
+
+		//printed raw because captured output is not bound by the log message length limit
+		if (result.empty()
+			&& !captured.empty())
+		{
+			if (captured.back() != '\n') captured += '\n';
+			Log::PrintRaw(captured);
+		}
+	}
+
+	if (!result.empty())
+	{
+		Log::Print(
+			result,
+			"RUN",
+			LogType::LOG_ERROR,
+			2);
+
+		return false;
+	}
+	if (exitCode != 0)
+	{
+		Log::Print(
+			"Process '" + string(args[0]) + "' exited with code " + to_string(exitCode) + ".",
+			"RUN",
+			LogType::LOG_WARNING,
+			2);
+
+		return false;
+	}
+
+	return true;
+}
 
 namespace KalaCLI
 {
@@ -24,80 +416,87 @@ namespace KalaCLI
 	{
 		if (params.empty()) return false;
 
-		if (!COMMAND_PREFIX.empty()
-			&& !ContainsString(params[0], COMMAND_PREFIX.data()))
-		{
-			Log::Print(
-				"Target command '" + params[0] + "' is missing required prefix '" + COMMAND_PREFIX.data() + "'!",
-				"PARSE",
-				LogType::LOG_ERROR,
-				2);
+		array<string_view, INLINE_PARAM_COUNT> inlineViews{};
+		vector<string_view> heapViews{};
 
-				return false;
+		span<string_view> views{};
+		if (params.size() <= INLINE_PARAM_COUNT) views = span(inlineViews.data(), params.size());
+		else
+		{
+			heapViews.resize(params.size());
+			views = span(heapViews);
 		}
 
-		vector<string> cleanedParams = params;
+		for (size_t i = 0; i < params.size(); ++i) views[i] = params[i];
 
-		if (!COMMAND_PREFIX.empty()) cleanedParams[0] = RemoveAllFromString(cleanedParams[0], COMMAND_PREFIX.data());
-		
-		if (cleanedParams[0] == "run"
-			|| cleanedParams[0] == "r")
+		return ParseCommand(span<const string_view>(views));
+	}
+
+	bool CommandManager::ParseCommand(span<const string_view> params)
+	{
+		if (params.empty()) return false;
+
+		//declared before the timer so writing the output isn't counted as parsing
+		OutputFlush outputFlush{};
+		DispatchTimer timer{};
+
+		string_view name = params[0];
+
+		if (!COMMAND_PREFIX.empty())
 		{
-			if (cleanedParams.size() == 1)
+			if (!name.starts_with(COMMAND_PREFIX))
 			{
 				Log::Print(
-					"Failed to run command '" + cleanedParams[0] + "'! You must pass 1 or more argument after the run command.",
+					"Target command '" + string(name) + "' is missing required prefix '" + COMMAND_PREFIX.data() + "'!",
 					"PARSE",
 					LogType::LOG_ERROR,
 					2);
-					
+
 				return false;
 			}
-			
-			auto Join = [](const vector<string>& params) -> string
-				{
-					ostringstream oss{};
-					
-					for (size_t i = 1; i < params.size(); ++i)
-					{
-						oss << params[i];
-						if (i + 1 < params.size()) oss << ' ';
-					}
-					
-					return oss.str();
-				};
-			
-			system(Join(cleanedParams).c_str());
-			
-			return true;	
+
+			name.remove_prefix(COMMAND_PREFIX.size());
 		}
 		
-		Command foundCommand{};
+		if (name == "run"
+			|| name == "r")
+		{
+			timer.commandIndex = RUN_COMMAND_INDEX;
+			timer.wasExecuted = true;
 
-		for (const auto& c : commands)
+			const auto executeStart = steady_clock::now();
+			timer.succeeded = RunProcessCommand(name, params);
+			timer.executeTime = steady_clock::now() - executeStart;
+
+			return timer.succeeded;
+		}
+		
+		const auto lookupStart = steady_clock::now();
+		size_t staticIndex{};
+		const StaticCommand* foundStatic = FindStatic(name, staticIndex);
+		const Command* foundCommand = foundStatic ? nullptr : FindCommand(name);
+		timer.lookupTime = steady_clock::now() - lookupStart;
+
+		if (foundStatic)
 		{
-			if (find(c.primary.begin(), c.primary.end(), cleanedParams[0]) != c.primary.end())
-			{
-				if (cleanedParams.size() == c.paramCount)
-				{
-					foundCommand = c;
-					break;
-				}
-				
-				Log::Print(
-					"Failed to run command '" + cleanedParams[0] + "'! Incorrect amount of parameters were passed for the command.",
-					"PARSE",
-					LogType::LOG_ERROR,
-					2);
+			timer.commandIndex = scast<u32>(STATIC_COMMAND_INDEX_BASE + staticIndex);
 
-				return false;
+			if (foundStatic->schema)
+			{
+				return DispatchWithSchema(*foundStatic->schema, foundStatic->targetArgsFunction, name, params, timer);
 			}
+
+			if (!CanDispatch(*foundStatic, name, params.size())) return false;
+
+			timer.BeginExecute();
+			CallWithViews(foundStatic->targetFunction, name, params);
+			return timer.EndExecute();
 		}
 
-		if (foundCommand.primary.empty())
+		if (!foundCommand)
 		{
 			Log::Print(
-				"Failed to run command '" + cleanedParams[0] + "'! The command does not exist.",
+				"Failed to run command '" + string(name) + "'! The command does not exist." + FormatSuggestions(name),
 				"PARSE",
 				LogType::LOG_ERROR,
 				2);
@@ -105,10 +504,23 @@ namespace KalaCLI
 			return false;
 		}
 
-		if (foundCommand.paramCount == 0)
+		const size_t commandIndex = scast<size_t>(foundCommand - commands.data());
+		timer.commandIndex = commandIndex < STATIC_COMMAND_INDEX_BASE
+			? scast<u32>(commandIndex)
+			: UNRECORDED_COMMAND_INDEX;
+
+		if (foundCommand->schema)
+		{
+			return DispatchWithSchema(*foundCommand->schema, foundCommand->targetArgsFunction, name, params, timer);
+		}
+
+		if (!CanDispatch(*foundCommand, name, params.size())) return false;
+
+		if (!foundCommand->targetFunction
+			&& !foundCommand->targetViewFunction)
 		{
 			Log::Print(
-				"Target command '" + cleanedParams[0] + "' has an invalid param count!",
+				"Target command '" + string(name) + "' has no attached function!",
 				"PARSE",
 				LogType::LOG_ERROR,
 				2);
@@ -116,31 +528,260 @@ namespace KalaCLI
 			return false;
 		}
 
-		if (!foundCommand.targetFunction)
+		if (foundCommand->targetViewFunction)
+		{
+			timer.BeginExecute();
+			CallWithViews(foundCommand->targetViewFunction, name, params);
+			return timer.EndExecute();
+		}
+
+		//legacy handlers receive owned strings, reuse one buffer per nesting level
+		//so repeated calls only reallocate when a parameter outgrows its previous size
+		static thread_local deque<vector<string>> paramBuffers{};
+		static thread_local size_t depth{};
+
+		if (depth == paramBuffers.size()) paramBuffers.emplace_back();
+
+		vector<string>& cleanedParams = paramBuffers[depth];
+		cleanedParams.resize(params.size());
+
+		cleanedParams[0].assign(name);
+		for (size_t i = 1; i < params.size(); ++i) cleanedParams[i].assign(params[i]);
+
+		timer.BeginExecute();
+		++depth;
+		foundCommand->targetFunction(cleanedParams);
+		--depth;
+		return timer.EndExecute();
+	}
+
+	size_t CommandManager::ParseLine(const LexedLine& line)
+	{
+		//the outermost line on a thread rewinds its arena, nested lines and
+		//the '&&&' tasks of a line keep allocating from the arena of that line
+		static thread_local LineArena ownArena{};
+
+		LineArena* arena = LineArena::GetCurrent();
+		if (!arena)
+		{
+			arena = &ownArena;
+			arena->Reset();
+		}
+		ArenaScope scope(arena);
+
+		size_t failedCount{};
+
+		size_t first{};
+		while (first < line.commands.size())
+		{
+			//a group is a run of commands joined with '&&&'
+			size_t last = first;
+			while (last + 1 < line.commands.size()
+				&& line.commands[last].isParallelWithNext)
+			{
+				++last;
+			}
+
+			if (first == last)
+			{
+				if (!ParseCommand(line.GetCommand(first))) ++failedCount;
+
+				++first;
+				continue;
+			}
+
+			const size_t groupSize = last - first + 1;
+
+			ThreadPool& pool = ThreadPool::GetShared();
+
+			ParallelGroup* group = new (arena->allocate(sizeof(ParallelGroup), alignof(ParallelGroup))) ParallelGroup{};
+			group->arena = arena;
+
+			std::pmr::vector<ParallelTask> tasks(arena);
+			tasks.reserve(groupSize);
+
+			size_t queuedCount{};
+			for (size_t i = 0; i < groupSize; ++i)
+			{
+				ParallelTask& task = tasks.emplace_back(arena);
+				task.params = line.GetCommand(first + i);
+				task.isThreadSafe = IsThreadSafe(task.params);
+
+				if (task.isThreadSafe) ++queuedCount;
+			}
+
+			group->remaining.store(queuedCount, memory_order_relaxed);
+
+			for (auto& task : tasks)
+			{
+				if (!task.isThreadSafe) continue;
+
+				//two pointers fit in the small buffer of the queued function, so posting doesn't allocate
+				pool.Post([&task, group]()
+					{
+						{
+							ArenaScope scope(group->arena);
+
+							Log::BeginCapture(task.capture);
+							try
+							{
+								task.succeeded = ParseCommand(task.params);
+							}
+							catch (...)
+							{
+								task.error = current_exception();
+							}
+							Log::EndCapture();
+						}
+
+						group->remaining.fetch_sub(1, memory_order_acq_rel);
+						group->remaining.notify_all();
+					});
+			}
+
+			pool.AwaitCount(group->remaining);
+
+			for (const auto& task : tasks)
+			{
+				if (task.error) rethrow_exception(task.error);
+			}
+
+			//output is printed in chain order, commands that aren't thread-safe
+			//run here on the calling thread once the pool tasks are done
+			for (auto& task : tasks)
+			{
+				if (task.isThreadSafe) Log::WriteCapture(task.capture);
+				else task.succeeded = ParseCommand(task.params);
+
+				if (!task.succeeded) ++failedCount;
+			}
+
+			first = last + 1;
+		}
+
+		return failedCount;
+	}
+
+	bool CommandManager::IsThreadSafe(span<const string_view> params)
+	{
+		if (params.empty()) return false;
+
+		string_view name = params[0];
+
+		//let ParseCommand report the missing prefix on the calling thread
+		if (!COMMAND_PREFIX.empty())
+		{
+			if (!name.starts_with(COMMAND_PREFIX)) return false;
+			name.remove_prefix(COMMAND_PREFIX.size());
+		}
+
+		//process launching only touches the job list, which is behind its own mutex
+		if (name == "run"
+			|| name == "r")
+		{
+			return true;
+		}
+
+		if (const StaticCommand* foundStatic = FindStaticCommand(name))
+		{
+			return foundStatic->isThreadSafe;
+		}
+
+		const Command* foundCommand = FindCommand(name);
+		return foundCommand != nullptr
+			&& foundCommand->isThreadSafe;
+	}
+
+	bool CommandManager::AddCommand(Command newValue)
+	{
+		const bool hasTarget = newValue.schema
+			? newValue.targetArgsFunction != nullptr
+			: newValue.paramCount != 0
+				&& (newValue.targetFunction || newValue.targetViewFunction);
+
+		//skip empty commands
+		if (newValue.primary.size() == 0
+			|| !hasTarget)
+		{
+			Log::Print(
+				"Failed to add a command because it has no primary parameter, parameter count or target function!",
+				"COMMAND",
+				LogType::LOG_ERROR,
+				2);
+
+			return false;
+		}
+
+		if (newValue.schema
+			&& !IsValidSchema(*newValue.schema))
 		{
 			Log::Print(
-				"Target command '" + cleanedParams[0] + "' has no attached function!",
-				"PARSE",
+				"Failed to add command '" + newValue.primary[0] + "' because its parameter schema is invalid!",
+				"COMMAND",
 				LogType::LOG_ERROR,
 				2);
 
 			return false;
 		}
 
-		foundCommand.targetFunction(cleanedParams);
+		//skip existing primary variants, the built-in run command is dispatched
+		//before every registered one so its variants are always in use
+		for (size_t i = 0; i < newValue.primary.size(); ++i)
+		{
+			const string& p = newValue.primary[i];
+
+			bool isDuplicate = p == "run"
+				|| p == "r"
+				|| FindCommand(p) != nullptr
+				|| FindStaticCommand(p) != nullptr;
+			for (size_t j = 0; j < i && !isDuplicate; ++j)
+			{
+				if (newValue.primary[j] == p) isDuplicate = true;
+			}
+
+			if (isDuplicate)
+			{
+				Log::Print(
+					"Failed to add a command because its primary parameter '" + p + "' is already in use by another command!",
+					"COMMAND",
+					LogType::LOG_ERROR,
+					2);
+
+				return false;
+			}
+		}
+
+		const u32 commandIndex = scast<u32>(commands.size());
+		commands.push_back(move(newValue));
+
+		const Command& added = commands.back();
+		for (size_t i = 0; i < added.primary.size(); ++i)
+		{
+			//keep the index at most half full so probe chains stay short
+			if ((aliasCount + 1) * 2 > aliasIndex.size()) GrowIndex();
+
+			u64 hash = HashAlias(added.primary[i]);
+			size_t slot = FindSlot(added.primary[i], hash);
+
+			aliasIndex[slot] = { hash, commandIndex, scast<u32>(i) };
+			++aliasCount;
+
+			InsertCompletion(added.primary[i]);
+		}
+
+		++registrationVersion;
 
 		return true;
 	}
 
-	bool CommandManager::AddCommand(Command newValue)
+	bool CommandManager::AddStaticTable(
+		span<const StaticCommand> newCommands,
+		span<const StaticAlias> newAliases)
 	{
-		//skip empty commands
-		if (newValue.primary.size() == 0
-			|| newValue.paramCount == 0
-			|| !newValue.targetFunction)
+		if (staticTableCount == MAX_STATIC_TABLES)
 		{
 			Log::Print(
-				"Failed to add a command because it has no primary parameter, parameter count or target function!",
+				"Failed to add a static command table because " + to_string(MAX_STATIC_TABLES) + " tables have already been added!",
 				"COMMAND",
 				LogType::LOG_ERROR,
 				2);
@@ -148,26 +789,183 @@ namespace KalaCLI
 			return false;
 		}
 
-		//skip existing primary variants
-		for (const auto& c : commands)
+		//duplicates inside the table were already rejected when it was compiled
+		for (const auto& a : newAliases)
 		{
-			for (const auto& p : newValue.primary)
+			string_view p = newCommands[a.commandIndex].primary[a.aliasIndex];
+
+			if (FindCommand(p) != nullptr
+				|| FindStaticCommand(p) != nullptr)
 			{
-				if (find(c.primary.begin(), c.primary.end(), p) != c.primary.end())
-				{
-					Log::Print(
-						"Failed to add a command because its primary parameter '" + p + "' is already in use by another command!",
-						"COMMAND",
-						LogType::LOG_ERROR,
-						2);
+				Log::Print(
+					"Failed to add a static command table because its primary parameter '" + string(p) + "' is already in use by another command!",
+					"COMMAND",
+					LogType::LOG_ERROR,
+					2);
 
-					return false;
-				}
+				return false;
 			}
 		}
 
-		commands.push_back(newValue);
+		staticTables[staticTableCount++] = { newCommands, newAliases, staticCommandCount };
+		staticCommandCount += newCommands.size();
+
+		for (const auto& a : newAliases) InsertCompletion(newCommands[a.commandIndex].primary[a.aliasIndex]);
+		++registrationVersion;
 
 		return true;
 	}
+
+	const StaticCommand* CommandManager::FindStaticCommand(string_view alias)
+	{
+		size_t index{};
+		return FindStatic(alias, index);
+	}
+
+	const StaticCommand* CommandManager::FindStatic(
+		string_view alias,
+		size_t& outIndex)
+	{
+		if (staticTableCount == 0) return nullptr;
+
+		const u64 hash = HashAlias(alias);
+
+		for (size_t t = 0; t < staticTableCount; ++t)
+		{
+			const StaticTableView& table = staticTables[t];
+			if (table.aliases.empty()) continue;
+
+			//branchless lower bound, the loop runs log2 of the alias count times for every alias
+			const StaticAlias* first = table.aliases.data();
+			size_t length = table.aliases.size();
+			while (length > 1)
+			{
+				const size_t half = length / 2;
+				first = first[half - 1].hash < hash ? first + half : first;
+				length -= half;
+			}
+
+			const StaticAlias* end = table.aliases.data() + table.aliases.size();
+			for (; first != end && first->hash == hash; ++first)
+			{
+				const StaticCommand& command = table.commands[first->commandIndex];
+				if (command.primary[first->aliasIndex] == alias)
+				{
+					outIndex = table.firstIndex + first->commandIndex;
+					return &command;
+				}
+			}
+		}
+
+		return nullptr;
+	}
+
+	void CommandManager::CompleteCommand(
+		string_view prefix,
+		vector<string>& outAliases,
+		size_t maxResults)
+	{
+		aliasTrie.Complete(prefix, maxResults, outAliases);
+	}
+
+	void CommandManager::SuggestCommands(
+		string_view name,
+		vector<string>& outAliases)
+	{
+		//short names only allow one typo so they don't match half the registry,
+		//more than two would walk most of a registry of similar names
+		const size_t maxDistance = name.size() <= MAX_ONE_TYPO_LENGTH ? 1 : 2;
+
+		vector<AliasMatch> matches{};
+		aliasTrie.FindSimilar(name, maxDistance, MAX_SUGGESTIONS, matches);
+
+		for (auto& m : matches) outAliases.push_back(move(m.word));
+	}
+
+	u64 CommandManager::GetRegistrationVersion()
+	{
+		return registrationVersion;
+	}
+
+	void CommandManager::InsertCompletion(string_view alias)
+	{
+		//run is dispatched before the registered commands and never registered itself
+		if (aliasTrie.GetWordCount() == 0)
+		{
+			aliasTrie.Insert("run");
+			aliasTrie.Insert("r");
+		}
+
+		aliasTrie.Insert(alias);
+	}
+
+	size_t CommandManager::GetStaticCommandCount()
+	{
+		return staticCommandCount;
+	}
+
+	const StaticCommand& CommandManager::GetStaticCommand(size_t index)
+	{
+		size_t t = 0;
+		while (index >= staticTables[t].firstIndex + staticTables[t].commands.size()) ++t;
+
+		return staticTables[t].commands[index - staticTables[t].firstIndex];
+	}
+
+	const Command* CommandManager::FindCommand(string_view alias)
+	{
+		if (aliasIndex.empty()) return nullptr;
+
+		const AliasSlot& slot = aliasIndex[FindSlot(alias, HashAlias(alias))];
+
+		return slot.commandIndex == UINT32_MAX
+			? nullptr
+			: &commands[slot.commandIndex];
+	}
+
+	size_t CommandManager::FindSlot(
+		string_view alias,
+		u64 hash)
+	{
+		const size_t mask = aliasIndex.size() - 1;
+		size_t i = scast<size_t>(hash) & mask;
+
+		//linear probing, always terminates because the index is never full
+		while (true)
+		{
+			const AliasSlot& slot = aliasIndex[i];
+
+			if (slot.commandIndex == UINT32_MAX) return i;
+
+			if (slot.hash == hash
+				&& commands[slot.commandIndex].primary[slot.aliasIndex] == alias)
+			{
+				return i;
+			}
+
+			i = (i + 1) & mask;
+		}
+	}
+
+	void CommandManager::GrowIndex()
+	{
+		size_t newCapacity = aliasIndex.empty()
+			? MIN_INDEX_CAPACITY
+			: aliasIndex.size() * 2;
+
+		vector<AliasSlot> oldIndex = move(aliasIndex);
+		aliasIndex.assign(newCapacity, AliasSlot{});
+
+		const size_t mask = newCapacity - 1;
+		for (const auto& slot : oldIndex)
+		{
+			if (slot.commandIndex == UINT32_MAX) continue;
+
+			//aliases are unique so the first empty slot is always the right one
+			size_t i = scast<size_t>(slot.hash) & mask;
+			while (aliasIndex[i].commandIndex != UINT32_MAX) i = (i + 1) & mask;
+
+			aliasIndex[i] = slot;
+		}
+	}
 }
\ No newline at end of file
@@ -0,0 +1,688 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include <array>
+#include <vector>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <filesystem>
+
+#ifdef _WIN32
+	#include <windows.h>
+	#include <sddl.h>
+#else
+	#include <csignal>
+	#include <unistd.h>
+	#include <sys/socket.h>
+	#include <sys/un.h>
+	#include <sys/stat.h>
+#endif
+
+#include "KalaHeaders/log_utils.hpp"
+
+#include "command_server.hpp"
+#include "command.hpp"
+#include "core.hpp"
+
+using KalaHeaders::KalaLog::Log;
+using KalaHeaders::KalaLog::LogType;
+using KalaHeaders::KalaLog::LogCapture;
+
+using KalaCLI::CommandManager;
+using KalaCLI::Core;
+using KalaCLI::ServerFrame;
+
+using std::string;
+using std::string_view;
+using std::to_string;
+using std::vector;
+using std::array;
+using std::span;
+using std::atomic;
+using std::memory_order_relaxed;
+using std::filesystem::current_path;
+
+//Requests past this many params or bytes are dropped as malformed
+constexpr u32 MAX_REQUEST_PARAMS = 4096;
+constexpr u32 MAX_REQUEST_SIZE = 16U * 1024 * 1024;
+
+//Size of the kind byte and payload size of every frame
+constexpr size_t FRAME_HEADER_SIZE = 5;
+
+static atomic<bool> isServing{};
+static atomic<bool> isStopRequested{};
+
+#ifdef _WIN32
+using Connection = HANDLE;
+static const Connection INVALID_CONNECTION = INVALID_HANDLE_VALUE;
+
+constexpr string_view PIPE_PREFIX = "\\\\.\\pipe\\";
+
+//How long the client waits for a busy pipe before giving up
+constexpr DWORD PIPE_WAIT_MS = 5000;
+
+//Buffer size of each pipe instance in both directions
+constexpr DWORD PIPE_BUFFER_SIZE = 64 * 1024;
+
+static string GetPipeName(const string& endpoint)
+{
+	return endpoint.starts_with(PIPE_PREFIX)
+		? endpoint
+		: string(PIPE_PREFIX) + endpoint;
+}
+
+static string GetLastErrorString()
+{
+	return "(error " + to_string(GetLastError()) + ")";
+}
+
+static void CloseConnection(Connection c) { CloseHandle(c); }
+
+static bool WriteAll(
+	Connection c,
+	const void* data,
+	size_t size)
+{
+	const char* bytes = scast<const char*>(data);
+	while (size > 0)
+	{
+		DWORD written{};
+		const DWORD chunk = size > PIPE_BUFFER_SIZE ? PIPE_BUFFER_SIZE : scast<DWORD>(size);
+		if (!WriteFile(c, bytes, chunk, &written, nullptr)) return false;
+
+		bytes += written;
+		size -= written;
+	}
+	return true;
+}
+
+static bool ReadAll(
+	Connection c,
+	void* data,
+	size_t size)
+{
+	char* bytes = scast<char*>(data);
+	while (size > 0)
+	{
+		DWORD read{};
+		const DWORD chunk = size > PIPE_BUFFER_SIZE ? PIPE_BUFFER_SIZE : scast<DWORD>(size);
+		if (!ReadFile(c, bytes, chunk, &read, nullptr)
+			|| read == 0)
+		{
+			return false;
+		}
+
+		bytes += read;
+		size -= read;
+	}
+	return true;
+}
+
+//Fills outAttributes with a security descriptor that only gives the user running this process
+//access to the pipe, so other users on the machine can't send commands to it.
+//Free outAttributes.lpSecurityDescriptor with LocalFree once no more instances are created
+static string CreatePipeSecurity(SECURITY_ATTRIBUTES& outAttributes)
+{
+	HANDLE token{};
+	if (!OpenProcessToken(GetCurrentProcess(), TOKEN_QUERY, &token))
+	{
+		return "Failed to open the process token! Reason: " + GetLastErrorString();
+	}
+
+	DWORD size{};
+	GetTokenInformation(token, TokenUser, nullptr, 0, &size);
+
+	vector<u8> tokenUser(size);
+	if (!GetTokenInformation(token, TokenUser, tokenUser.data(), size, &size))
+	{
+		string reason = GetLastErrorString();
+		CloseHandle(token);
+
+		return "Failed to get the user of the process token! Reason: " + reason;
+	}
+	CloseHandle(token);
+
+	LPSTR userSID{};
+	if (!ConvertSidToStringSidA(rcast<TOKEN_USER*>(tokenUser.data())->User.Sid, &userSID))
+	{
+		return "Failed to convert the user SID! Reason: " + GetLastErrorString();
+	}
+
+	//protected DACL with a single entry granting the current user full access
+	const string descriptor = "D:P(A;;GA;;;" + string(userSID) + ")";
+	LocalFree(userSID);
+
+	PSECURITY_DESCRIPTOR securityDescriptor{};
+	if (!ConvertStringSecurityDescriptorToSecurityDescriptorA(
+		descriptor.c_str(),
+		SDDL_REVISION_1,
+		&securityDescriptor,
+		nullptr))
+	{
+		return "Failed to create the pipe security descriptor! Reason: " + GetLastErrorString();
+	}
+
+	outAttributes = {};
+	outAttributes.nLength = sizeof(outAttributes);
+	outAttributes.lpSecurityDescriptor = securityDescriptor;
+	outAttributes.bInheritHandle = FALSE;
+
+	return{};
+}
+
+static Connection CreatePipeInstance(
+	const string& pipeName,
+	SECURITY_ATTRIBUTES& security,
+	bool isFirst)
+{
+	return CreateNamedPipeA(
+		pipeName.c_str(),
+		PIPE_ACCESS_DUPLEX | (isFirst ? FILE_FLAG_FIRST_PIPE_INSTANCE : 0),
+		PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+		PIPE_UNLIMITED_INSTANCES,
+		PIPE_BUFFER_SIZE,
+		PIPE_BUFFER_SIZE,
+		0,
+		&security);
+}
+
+static string Connect(
+	const string& endpoint,
+	Connection& outConnection)
+{
+	const string pipeName = GetPipeName(endpoint);
+
+	while (true)
+	{
+		Connection c = CreateFileA(
+			pipeName.c_str(),
+			GENERIC_READ | GENERIC_WRITE,
+			0,
+			nullptr,
+			OPEN_EXISTING,
+			0,
+			nullptr);
+
+		if (c != INVALID_CONNECTION)
+		{
+			outConnection = c;
+			return{};
+		}
+
+		if (GetLastError() != ERROR_PIPE_BUSY
+			|| !WaitNamedPipeA(pipeName.c_str(), PIPE_WAIT_MS))
+		{
+			return "Failed to connect to '" + pipeName + "'! Reason: " + GetLastErrorString();
+		}
+	}
+}
+#else
+using Connection = int;
+constexpr Connection INVALID_CONNECTION = -1;
+
+static void CloseConnection(Connection c) { close(c); }
+
+static bool WriteAll(
+	Connection c,
+	const void* data,
+	size_t size)
+{
+	const char* bytes = scast<const char*>(data);
+	while (size > 0)
+	{
+		const ssize_t written = write(c, bytes, size);
+		if (written < 0)
+		{
+			if (errno == EINTR) continue;
+			return false;
+		}
+
+		bytes += written;
+		size -= scast<size_t>(written);
+	}
+	return true;
+}
+
+static bool ReadAll(
+	Connection c,
+	void* data,
+	size_t size)
+{
+	char* bytes = scast<char*>(data);
+	while (size > 0)
+	{
+		const ssize_t read = ::read(c, bytes, size);
+		if (read < 0)
+		{
+			if (errno == EINTR) continue;
+			return false;
+		}
+		if (read == 0) return false;
+
+		bytes += read;
+		size -= scast<size_t>(read);
+	}
+	return true;
+}
+
+//Fills the socket address of endpoint, returns false if the path doesn't fit
+static bool GetSocketAddress(
+	const string& endpoint,
+	sockaddr_un& outAddress)
+{
+	outAddress = {};
+	outAddress.sun_family = AF_UNIX;
+
+	if (endpoint.empty()
+		|| endpoint.size() >= sizeof(outAddress.sun_path))
+	{
+		return false;
+	}
+
+	memcpy(outAddress.sun_path, endpoint.data(), endpoint.size());
+	return true;
+}
+
+//Returns true if the process on the other end of c runs as the same user as this one
+static bool IsSameUser(
+	Connection c,
+	uid_t& outPeerUID)
+{
+#ifdef __linux__
+	ucred credentials{};
+	socklen_t size = sizeof(credentials);
+	if (getsockopt(c, SOL_SOCKET, SO_PEERCRED, &credentials, &size) != 0) return false;
+
+	outPeerUID = credentials.uid;
+#else
+	gid_t peerGID{};
+	if (getpeereid(c, &outPeerUID, &peerGID) != 0) return false;
+#endif
+
+	return outPeerUID == geteuid();
+}
+
+static string Connect(
+	const string& endpoint,
+	Connection& outConnection)
+{
+	sockaddr_un address{};
+	if (!GetSocketAddress(endpoint, address))
+	{
+		return "Failed to connect to '" + endpoint + "' because the socket path is empty or too long!";
+	}
+
+	Connection c = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (c == INVALID_CONNECTION)
+	{
+		return "Failed to connect to '" + endpoint + "'! Reason: " + strerror(errno);
+	}
+
+	if (connect(c, rcast<sockaddr*>(&address), sizeof(address)) != 0)
+	{
+		string reason = strerror(errno);
+		close(c);
+
+		return "Failed to connect to '" + endpoint + "'! Reason: " + reason;
+	}
+
+	outConnection = c;
+	return{};
+}
+#endif
+
+static void AppendU32(
+	string& out,
+	u32 value)
+{
+	for (int i = 0; i < 4; ++i) out += scast<char>((value >> (i * 8)) & 0xFF);
+}
+
+static u32 ReadU32(const u8* data)
+{
+	return scast<u32>(data[0])
+		| (scast<u32>(data[1]) << 8)
+		| (scast<u32>(data[2]) << 16)
+		| (scast<u32>(data[3]) << 24);
+}
+
+static bool WriteFrame(
+	Connection c,
+	ServerFrame kind,
+	const char* data,
+	size_t size)
+{
+	string header{};
+	header += scast<char>(kind);
+	AppendU32(header, scast<u32>(size));
+
+	return WriteAll(c, header.data(), header.size())
+		&& (size == 0 || WriteAll(c, data, size));
+}
+
+//Receives every print of the served command while Log captures the serving thread
+struct ServedOutput
+{
+	Connection connection = INVALID_CONNECTION;
+	bool isBroken{}; //set once the client went away, later output is dropped
+};
+
+static void StreamToClient(
+	void* context,
+	bool isError,
+	const char* data,
+	size_t length)
+{
+	ServedOutput* output = scast<ServedOutput*>(context);
+	if (output->isBroken) return;
+
+	if (!WriteFrame(
+		output->connection,
+		isError ? ServerFrame::FRAME_STDERR : ServerFrame::FRAME_STDOUT,
+		data,
+		length))
+	{
+		output->isBroken = true;
+	}
+}
+
+//Reads one request of a u32 string count followed by a u32 size and bytes per string,
+//the first string is the working directory of the client and the rest are its params
+static bool ReadRequest(
+	Connection c,
+	vector<string>& outStrings)
+{
+	array<u8, 4> value{};
+	if (!ReadAll(c, value.data(), value.size())) return false;
+
+	const u32 count = ReadU32(value.data());
+	if (count < 2
+		|| count > MAX_REQUEST_PARAMS)
+	{
+		return false;
+	}
+
+	outStrings.resize(count);
+
+	size_t totalSize{};
+	for (auto& s : outStrings)
+	{
+		if (!ReadAll(c, value.data(), value.size())) return false;
+
+		const u32 size = ReadU32(value.data());
+		totalSize += size;
+		if (totalSize > MAX_REQUEST_SIZE) return false;
+
+		s.resize(size);
+		if (size > 0
+			&& !ReadAll(c, s.data(), size))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//Dispatches one forwarded request and sends back its output and result
+static void ServeConnection(Connection c)
+{
+	vector<string> request{};
+	if (!ReadRequest(c, request)) return;
+
+	//every request runs from the directory of the client like a fresh invocation would
+	Core::currentDir = request[0];
+
+	vector<string_view> params(request.begin() + 1, request.end());
+
+	ServedOutput output{};
+	output.connection = c;
+
+	LogCapture capture{};
+	capture.onWrite = StreamToClient;
+	capture.context = &output;
+
+	Log::BeginCapture(capture);
+	const bool succeeded = CommandManager::ParseCommand(span<const string_view>(params));
+	Log::EndCapture();
+
+	if (output.isBroken) return;
+
+	const char result = succeeded ? 1 : 0;
+	WriteFrame(c, ServerFrame::FRAME_RESULT, &result, 1);
+}
+
+namespace KalaCLI
+{
+	string CommandServer::Serve(const string& endpoint)
+	{
+#ifdef _WIN32
+		const string pipeName = GetPipeName(endpoint);
+
+		SECURITY_ATTRIBUTES security{};
+		string result = CreatePipeSecurity(security);
+		if (!result.empty())
+		{
+			return "Failed to serve on '" + pipeName + "'! " + result;
+		}
+
+		Connection next = CreatePipeInstance(pipeName, security, true);
+		if (next == INVALID_CONNECTION)
+		{
+			string reason = GetLastErrorString();
+			LocalFree(security.lpSecurityDescriptor);
+
+			return "Failed to serve on '" + pipeName + "'! Reason: " + reason;
+		}
+
+		Log::Print("\nServing commands on '" + pipeName + "'");
+		Log::Flush();
+
+		isStopRequested.store(false, memory_order_relaxed);
+		isServing.store(true, memory_order_relaxed);
+
+		while (!isStopRequested.load(memory_order_relaxed))
+		{
+			Connection c = next;
+			if (!ConnectNamedPipe(c, nullptr)
+				&& GetLastError() != ERROR_PIPE_CONNECTED)
+			{
+				CloseConnection(c);
+				next = CreatePipeInstance(pipeName, security, false);
+				if (next == INVALID_CONNECTION) break;
+				continue;
+			}
+
+			//the next instance exists before this one closes so clients never find the pipe missing
+			next = CreatePipeInstance(pipeName, security, false);
+
+			ServeConnection(c);
+
+			FlushFileBuffers(c);
+			DisconnectNamedPipe(c);
+			CloseConnection(c);
+
+			if (next == INVALID_CONNECTION) break;
+		}
+
+		if (next != INVALID_CONNECTION) CloseConnection(next);
+		LocalFree(security.lpSecurityDescriptor);
+#else
+		sockaddr_un address{};
+		if (!GetSocketAddress(endpoint, address))
+		{
+			return "Failed to serve on '" + endpoint + "' because the socket path is empty or too long!";
+		}
+
+		//a socket file left behind by a crashed server is removed,
+		//one that still accepts connections belongs to a running server
+		Connection probe = INVALID_CONNECTION;
+		if (Connect(endpoint, probe).empty())
+		{
+			CloseConnection(probe);
+			return "Failed to serve on '" + endpoint + "' because another server is already listening on it!";
+		}
+		struct stat info{};
+		if (lstat(endpoint.c_str(), &info) == 0
+			&& S_ISSOCK(info.st_mode))
+		{
+			unlink(endpoint.c_str());
+		}
+
+		Connection listener = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (listener == INVALID_CONNECTION)
+		{
+			return "Failed to serve on '" + endpoint + "'! Reason: " + strerror(errno);
+		}
+
+		//the socket file is created owner-only so other users can't even connect,
+		//accepted peers are still checked in case the folder or mode is changed later
+		const mode_t previousMask = umask(077);
+		const bool isBound = bind(listener, rcast<sockaddr*>(&address), sizeof(address)) == 0;
+		umask(previousMask);
+
+		if (!isBound
+			|| listen(listener, SOMAXCONN) != 0)
+		{
+			string reason = strerror(errno);
+			CloseConnection(listener);
+
+			return "Failed to serve on '" + endpoint + "'! Reason: " + reason;
+		}
+
+		//a client that disconnects mid-command must not kill the server on the next write
+		signal(SIGPIPE, SIG_IGN);
+
+		Log::Print("\nServing commands on '" + endpoint + "'");
+		Log::Flush();
+
+		isStopRequested.store(false, memory_order_relaxed);
+		isServing.store(true, memory_order_relaxed);
+
+		while (!isStopRequested.load(memory_order_relaxed))
+		{
+			Connection c = accept(listener, nullptr, nullptr);
+			if (c == INVALID_CONNECTION)
+			{
+				if (errno == EINTR
+					|| errno == ECONNABORTED)
+				{
+					continue;
+				}
+				break;
+			}
+
+			uid_t peerUID{};
+			if (!IsSameUser(c, peerUID))
+			{
+				Log::Print(
+					"Rejected a connection to '" + endpoint + "' from user " + to_string(peerUID) + "!",
+					"SERVER",
+					LogType::LOG_WARNING,
+					2);
+
+				CloseConnection(c);
+				continue;
+			}
+
+			ServeConnection(c);
+			CloseConnection(c);
+		}
+
+		CloseConnection(listener);
+		unlink(endpoint.c_str());
+#endif
+
+		isServing.store(false, memory_order_relaxed);
+
+		return{};
+	}
+
+	string CommandServer::Forward(
+		const string& endpoint,
+		span<const string_view> params,
+		bool& outSucceeded)
+	{
+		outSucceeded = false;
+
+		Connection c = INVALID_CONNECTION;
+		string result = Connect(endpoint, c);
+		if (!result.empty()) return result;
+
+#ifndef _WIN32
+		//a server that rejects this user closes the connection unread,
+		//the failed write must be reported instead of killing the client
+		signal(SIGPIPE, SIG_IGN);
+#endif
+
+		string request{};
+		AppendU32(request, scast<u32>(params.size() + 1));
+
+		const string workingDir = current_path().string();
+		AppendU32(request, scast<u32>(workingDir.size()));
+		request += workingDir;
+
+		for (const auto& p : params)
+		{
+			AppendU32(request, scast<u32>(p.size()));
+			request += p;
+		}
+
+		if (!WriteAll(c, request.data(), request.size()))
+		{
+			CloseConnection(c);
+			return "Failed to send the command to '" + endpoint + "'!";
+		}
+
+		vector<char> payload{};
+		array<u8, FRAME_HEADER_SIZE> header{};
+
+		while (true)
+		{
+			if (!ReadAll(c, header.data(), header.size()))
+			{
+				//the command was sent, so this is only reported and never retried locally
+				fputs("Lost the connection to the server before the command finished!\n", stderr);
+				break;
+			}
+
+			const ServerFrame kind = scast<ServerFrame>(header[0]);
+			const u32 size = ReadU32(header.data() + 1);
+
+			payload.resize(size);
+			if (size > 0
+				&& !ReadAll(c, payload.data(), size))
+			{
+				fputs("Lost the connection to the server before the command finished!\n", stderr);
+				break;
+			}
+
+			if (kind == ServerFrame::FRAME_RESULT)
+			{
+				outSucceeded = size == 1 && payload[0] == 1;
+				break;
+			}
+
+			FILE* out = kind == ServerFrame::FRAME_STDERR ? stderr : stdout;
+			fwrite(payload.data(), 1, payload.size(), out);
+			fflush(out);
+		}
+
+		CloseConnection(c);
+		return{};
+	}
+
+	bool CommandServer::IsServing()
+	{
+		return isServing.load(memory_order_relaxed);
+	}
+
+	void CommandServer::RequestStop()
+	{
+		isStopRequested.store(true, memory_order_relaxed);
+	}
+}
@@ -0,0 +1,336 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <bit>
+
+#include "command_stats.hpp"
+#include "command.hpp"
+
+using KalaCLI::CommandManager;
+using KalaCLI::LATENCY_BUCKET_COUNT;
+using KalaCLI::RUN_COMMAND_INDEX;
+using KalaCLI::UNKNOWN_COMMAND_INDEX;
+using KalaCLI::STATIC_COMMAND_INDEX_BASE;
+
+using std::string;
+using std::vector;
+using std::array;
+using std::atomic;
+using std::mutex;
+using std::lock_guard;
+using std::bit_width;
+using std::memory_order_relaxed;
+using std::memory_order_acquire;
+using std::memory_order_release;
+
+//Counters of one command are allocated in pages of this many commands
+constexpr size_t COUNTER_PAGE_SIZE = 64;
+
+//How many pages every thread can hold, commands past the last page aren't recorded
+constexpr size_t MAX_COUNTER_PAGES = 1024;
+
+//Every counter is only ever written by the thread that owns it,
+//the atomics only exist so that snapshots can read them at the same time
+struct CommandCounters
+{
+	atomic<u64> invocationCount{};
+	atomic<u64> failureCount{};
+	atomic<u64> totalNS{};
+	atomic<u64> maxNS{};
+	array<atomic<u64>, LATENCY_BUCKET_COUNT> buckets{};
+};
+
+struct CounterPage
+{
+	array<atomic<CommandCounters*>, COUNTER_PAGE_SIZE> commands{};
+};
+
+struct ThreadCounters
+{
+	array<atomic<CounterPage*>, MAX_COUNTER_PAGES> pages{};
+	CommandCounters run{};
+
+	atomic<u64> dispatchCount{};
+	atomic<u64> unknownCount{};
+	atomic<u64> parseNS{};
+	atomic<u64> lookupNS{};
+	atomic<u64> executeNS{};
+};
+
+//Every thread that has recorded a dispatch, never destroyed so that
+//pool threads which outlive static destruction can still record safely
+struct ThreadRegistry
+{
+	mutex registryMutex{};
+	vector<ThreadCounters*> threads{};
+};
+
+static ThreadRegistry& GetRegistry()
+{
+	static ThreadRegistry* registry = new ThreadRegistry{};
+	return *registry;
+}
+
+//Only called by the owning thread, so a plain load and store is enough
+static void Add(
+	atomic<u64>& counter,
+	u64 value)
+{
+	counter.store(counter.load(memory_order_relaxed) + value, memory_order_relaxed);
+}
+
+static size_t GetBucket(u64 ns)
+{
+	if (ns < 4) return scast<size_t>(ns);
+
+	const size_t exponent = scast<size_t>(bit_width(ns)) - 1;
+	const size_t sub = scast<size_t>(ns >> (exponent - 2)) & 3;
+
+	return (exponent - 1) * 4 + sub;
+}
+
+//Largest value that still lands in this bucket
+static u64 GetBucketLimit(size_t bucket)
+{
+	if (bucket < 4) return scast<u64>(bucket);
+
+	const size_t exponent = bucket / 4 + 1;
+	const u64 sub = scast<u64>(bucket % 4);
+
+	const u64 low = (4 + sub) << (exponent - 2);
+	return low + ((1ULL << (exponent - 2)) - 1);
+}
+
+static ThreadCounters& GetLocalCounters()
+{
+	static thread_local ThreadCounters* local = []()
+		{
+			ThreadCounters* counters = new ThreadCounters{};
+
+			ThreadRegistry& registry = GetRegistry();
+			lock_guard lock(registry.registryMutex);
+			registry.threads.push_back(counters);
+
+			return counters;
+		}();
+
+	return *local;
+}
+
+static CommandCounters* GetCommandCounters(
+	ThreadCounters& local,
+	u32 commandIndex)
+{
+	if (commandIndex == RUN_COMMAND_INDEX) return &local.run;
+
+	const size_t pageIndex = commandIndex / COUNTER_PAGE_SIZE;
+	if (pageIndex >= MAX_COUNTER_PAGES) return nullptr;
+
+	CounterPage* page = local.pages[pageIndex].load(memory_order_relaxed);
+	if (!page)
+	{
+		page = new CounterPage{};
+		local.pages[pageIndex].store(page, memory_order_release);
+	}
+
+	auto& slot = page->commands[commandIndex % COUNTER_PAGE_SIZE];
+
+	CommandCounters* counters = slot.load(memory_order_relaxed);
+	if (!counters)
+	{
+		counters = new CommandCounters{};
+		slot.store(counters, memory_order_release);
+	}
+
+	return counters;
+}
+
+//Adds the counters of one thread to the merged counters of the same command
+static void Merge(
+	const CommandCounters& from,
+	CommandCounters& to)
+{
+	Add(to.invocationCount, from.invocationCount.load(memory_order_relaxed));
+	Add(to.failureCount, from.failureCount.load(memory_order_relaxed));
+	Add(to.totalNS, from.totalNS.load(memory_order_relaxed));
+
+	const u64 maxNS = from.maxNS.load(memory_order_relaxed);
+	if (maxNS > to.maxNS.load(memory_order_relaxed)) to.maxNS.store(maxNS, memory_order_relaxed);
+
+	for (size_t i = 0; i < LATENCY_BUCKET_COUNT; ++i)
+	{
+		Add(to.buckets[i], from.buckets[i].load(memory_order_relaxed));
+	}
+}
+
+//Adds the counters of one thread for the merged.size() commands starting at firstIndex
+static void MergeRange(
+	const ThreadCounters& thread,
+	size_t firstIndex,
+	vector<CommandCounters>& merged)
+{
+	const size_t endIndex = firstIndex + merged.size();
+
+	for (size_t p = firstIndex / COUNTER_PAGE_SIZE; p < MAX_COUNTER_PAGES; ++p)
+	{
+		const size_t first = p * COUNTER_PAGE_SIZE;
+		if (first >= endIndex) break;
+
+		const CounterPage* page = thread.pages[p].load(memory_order_acquire);
+		if (!page) continue;
+
+		for (size_t i = 0; i < COUNTER_PAGE_SIZE; ++i)
+		{
+			const size_t index = first + i;
+			if (index < firstIndex) continue;
+			if (index >= endIndex) break;
+
+			const CommandCounters* counters = page->commands[i].load(memory_order_acquire);
+			if (counters) Merge(*counters, merged[index - firstIndex]);
+		}
+	}
+}
+
+//Returns the upper bound of the bucket holding the value at this fraction of all samples,
+//capped at the largest sample so a single slow call reports itself exactly
+static u64 GetPercentile(
+	const CommandCounters& counters,
+	u64 sampleCount,
+	u64 permille)
+{
+	if (sampleCount == 0) return 0;
+
+	const u64 rank = (sampleCount * permille + 999) / 1000;
+	const u64 maxNS = counters.maxNS.load(memory_order_relaxed);
+
+	u64 seen{};
+	for (size_t i = 0; i < LATENCY_BUCKET_COUNT; ++i)
+	{
+		seen += counters.buckets[i].load(memory_order_relaxed);
+		if (seen >= rank)
+		{
+			const u64 limit = GetBucketLimit(i);
+			return limit < maxNS ? limit : maxNS;
+		}
+	}
+
+	return maxNS;
+}
+
+namespace KalaCLI
+{
+	void CommandStats::Record(
+		u32 commandIndex,
+		bool wasExecuted,
+		bool succeeded,
+		u64 parseNS,
+		u64 lookupNS,
+		u64 executeNS)
+	{
+		ThreadCounters& local = GetLocalCounters();
+
+		Add(local.dispatchCount, 1);
+		Add(local.parseNS, parseNS);
+		Add(local.lookupNS, lookupNS);
+		Add(local.executeNS, executeNS);
+
+		if (commandIndex == UNKNOWN_COMMAND_INDEX)
+		{
+			Add(local.unknownCount, 1);
+			return;
+		}
+
+		CommandCounters* counters = GetCommandCounters(local, commandIndex);
+		if (!counters) return;
+
+		Add(counters->invocationCount, 1);
+		if (!succeeded) Add(counters->failureCount, 1);
+
+		if (!wasExecuted) return;
+
+		Add(counters->totalNS, executeNS);
+		if (executeNS > counters->maxNS.load(memory_order_relaxed))
+		{
+			counters->maxNS.store(executeNS, memory_order_relaxed);
+		}
+		Add(counters->buckets[GetBucket(executeNS)], 1);
+	}
+
+	StatsSnapshot CommandStats::GetSnapshot()
+	{
+		StatsSnapshot snapshot{};
+
+		const size_t commandCount = CommandManager::commands.size() < STATIC_COMMAND_INDEX_BASE
+			? CommandManager::commands.size()
+			: STATIC_COMMAND_INDEX_BASE;
+		const size_t staticCount = CommandManager::GetStaticCommandCount();
+
+		//merged per command, heap allocated because every entry holds a full histogram
+		vector<CommandCounters> merged(commandCount);
+		vector<CommandCounters> mergedStatic(staticCount);
+		CommandCounters mergedRun{};
+
+		{
+			ThreadRegistry& registry = GetRegistry();
+			lock_guard lock(registry.registryMutex);
+
+			for (const ThreadCounters* thread : registry.threads)
+			{
+				snapshot.dispatchCount += thread->dispatchCount.load(memory_order_relaxed);
+				snapshot.unknownCount += thread->unknownCount.load(memory_order_relaxed);
+				snapshot.parseNS += thread->parseNS.load(memory_order_relaxed);
+				snapshot.lookupNS += thread->lookupNS.load(memory_order_relaxed);
+				snapshot.executeNS += thread->executeNS.load(memory_order_relaxed);
+
+				Merge(thread->run, mergedRun);
+
+				MergeRange(*thread, 0, merged);
+				MergeRange(*thread, STATIC_COMMAND_INDEX_BASE, mergedStatic);
+			}
+		}
+
+		auto addTimings = [&snapshot](
+			const string& name,
+			const CommandCounters& counters)
+			{
+				CommandTimings timings{};
+				timings.name = name;
+				timings.invocationCount = counters.invocationCount.load(memory_order_relaxed);
+				timings.failureCount = counters.failureCount.load(memory_order_relaxed);
+				timings.totalNS = counters.totalNS.load(memory_order_relaxed);
+				timings.maxNS = counters.maxNS.load(memory_order_relaxed);
+
+				u64 sampleCount{};
+				for (const auto& bucket : counters.buckets) sampleCount += bucket.load(memory_order_relaxed);
+
+				timings.p50NS = GetPercentile(counters, sampleCount, 500);
+				timings.p99NS = GetPercentile(counters, sampleCount, 990);
+
+				snapshot.commands.push_back(timings);
+			};
+
+		for (size_t i = 0; i < staticCount; ++i)
+		{
+			if (mergedStatic[i].invocationCount.load(memory_order_relaxed) == 0) continue;
+
+			addTimings(string(CommandManager::GetStaticCommand(i).primary[0]), mergedStatic[i]);
+		}
+
+		for (size_t i = 0; i < commandCount; ++i)
+		{
+			if (merged[i].invocationCount.load(memory_order_relaxed) == 0) continue;
+
+			const Command& command = CommandManager::commands[i];
+			addTimings(command.primary.empty() ? string{} : command.primary[0], merged[i]);
+		}
+
+		if (mergedRun.invocationCount.load(memory_order_relaxed) > 0) addTimings("run", mergedRun);
+
+		return snapshot;
+	}
+}
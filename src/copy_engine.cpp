@@ -0,0 +1,784 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include <future>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+#include <system_error>
+#include <cstring>
+#include <cerrno>
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <unistd.h>
+	#include <fcntl.h>
+	#include <sys/stat.h>
+#endif
+
+#include "KalaHeaders/thread_utils.hpp"
+
+#include "copy_engine.hpp"
+
+using KalaHeaders::KalaThread::ThreadPool;
+
+using KalaCLI::CopyEngine;
+using KalaCLI::CopyOptions;
+using KalaCLI::CopyProgress;
+using KalaCLI::CopyStats;
+using KalaCLI::COPY_PROGRESS_INTERVAL_MS;
+
+using std::string;
+using std::vector;
+using std::to_string;
+using std::future;
+using std::atomic;
+using std::mutex;
+using std::lock_guard;
+using std::mismatch;
+using std::move;
+using std::error_code;
+using std::errc;
+using std::memory_order_relaxed;
+using std::chrono::steady_clock;
+using std::chrono::duration_cast;
+using std::chrono::milliseconds;
+using std::filesystem::path;
+using std::filesystem::directory_entry;
+using std::filesystem::recursive_directory_iterator;
+using std::filesystem::directory_options;
+using std::filesystem::weakly_canonical;
+using std::filesystem::exists;
+using std::filesystem::symlink_status;
+using std::filesystem::is_directory;
+using std::filesystem::is_regular_file;
+using std::filesystem::is_symlink;
+using std::filesystem::file_size;
+using std::filesystem::last_write_time;
+using std::filesystem::create_directory;
+using std::filesystem::create_directories;
+using std::filesystem::copy_symlink;
+using std::filesystem::remove;
+using std::filesystem::remove_all;
+using std::filesystem::rename;
+using std::filesystem::equivalent;
+
+//A pool task copies files until it has this many
+constexpr size_t COPY_BATCH_FILE_COUNT = 64;
+//or until it has this many bytes, so small files share tasks and large files get their own
+constexpr uintmax_t COPY_BATCH_SIZE = 16ULL * 1024 * 1024;
+
+#ifdef _WIN32
+//Files atleast this large are copied without going through the system file cache
+constexpr uintmax_t COPY_UNBUFFERED_SIZE = 256ULL * 1024 * 1024;
+#else
+//Bytes read and written at once when the kernel can't copy the file by itself
+constexpr size_t COPY_BUFFER_SIZE = 1ULL * 1024 * 1024;
+#endif
+
+//One file found by the walk
+struct CopyJob
+{
+	path origin{};
+	path target{};
+	uintmax_t size{};
+};
+
+//Counters shared by every copy task of one CopyPath call
+struct CopyState
+{
+	atomic<u64> doneFileCount{};
+	atomic<uintmax_t> doneSize{};
+	atomic<u64> copiedCount{};
+	atomic<uintmax_t> copiedSize{};
+	atomic<u64> skippedCount{};
+	atomic<i64> lastReport{};  //steady clock milliseconds of the last progress call
+
+	u64 totalFileCount{};
+	uintmax_t totalSize{};
+
+	mutex failuresMutex{};
+	vector<string> failures{};
+};
+
+static i64 GetSteadyMS()
+{
+	return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static void AddFailure(
+	CopyState& state,
+	string reason)
+{
+	lock_guard<mutex> lock(state.failuresMutex);
+	state.failures.push_back(move(reason));
+}
+
+#ifdef _WIN32
+//Returns the message of the last Win32 error
+static string GetLastErrorString()
+{
+	DWORD err = GetLastError();
+
+	char* buffer{};
+	DWORD length = FormatMessageA(
+		FORMAT_MESSAGE_ALLOCATE_BUFFER
+		| FORMAT_MESSAGE_FROM_SYSTEM
+		| FORMAT_MESSAGE_IGNORE_INSERTS,
+		nullptr,
+		err,
+		0,
+		rcast<LPSTR>(&buffer),
+		0,
+		nullptr);
+
+	string result = "(error " + to_string(err) + ")";
+	if (length > 0)
+	{
+		result += ": ";
+		result.append(buffer, length);
+		while (!result.empty()
+			&& (result.back() == '\n'
+			|| result.back() == '\r'))
+		{
+			result.pop_back();
+		}
+	}
+	if (buffer) LocalFree(buffer);
+
+	return result;
+}
+
+//Copies the file contents, attributes and timestamps with CopyFileEx,
+//which lets the OS offload the copy to the file system or the storage where it can
+static string CopyFileData(
+	const path& origin,
+	const path& target,
+	uintmax_t size)
+{
+	DWORD flags = size >= COPY_UNBUFFERED_SIZE
+		? COPY_FILE_NO_BUFFERING
+		: 0;
+
+	if (!CopyFileExW(
+		origin.c_str(),
+		target.c_str(),
+		nullptr,
+		nullptr,
+		nullptr,
+		flags))
+	{
+		return "Failed to copy file '" + origin.string() + "' to '" + target.string() + "'! Reason: " + GetLastErrorString();
+	}
+
+	return{};
+}
+#else
+static string GetErrnoString()
+{
+	return "(errno " + to_string(errno) + "): " + strerror(errno);
+}
+
+//Copies the file contents with copy_file_range on Linux, which stays inside the kernel and
+//lets file systems share or offload the blocks, or with a read and write loop everywhere else.
+//The origin permissions and last write time are applied to target after the copy
+static string CopyFileData(
+	const path& origin,
+	const path& target,
+	uintmax_t size)
+{
+	int in = open(origin.c_str(), O_RDONLY | O_CLOEXEC);
+	if (in == -1)
+	{
+		return "Failed to open file '" + origin.string() + "' for copying! Reason: " + GetErrnoString();
+	}
+
+	struct stat info{};
+	if (fstat(in, &info) == -1)
+	{
+		string reason = GetErrnoString();
+		close(in);
+
+		return "Failed to read file '" + origin.string() + "' info for copying! Reason: " + reason;
+	}
+
+	int out = open(
+		target.c_str(),
+		O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+		info.st_mode & 07777);
+	if (out == -1)
+	{
+		string reason = GetErrnoString();
+		close(in);
+
+		return "Failed to create file '" + target.string() + "'! Reason: " + reason;
+	}
+
+	string result{};
+	bool useBuffer = true;
+
+#ifdef __linux__
+	posix_fadvise(in, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+	useBuffer = false;
+	uintmax_t remaining = size;
+	while (remaining > 0)
+	{
+		ssize_t copied = copy_file_range(
+			in,
+			nullptr,
+			out,
+			nullptr,
+			remaining,
+			0);
+
+		if (copied > 0)
+		{
+			remaining -= scast<uintmax_t>(copied);
+			continue;
+		}
+
+		//origin got shorter while it was copied
+		if (copied == 0) break;
+		if (errno == EINTR) continue;
+
+		//not supported between these file systems, both offsets have already
+		//moved past what was copied so the loop below continues from there
+		if (errno == EXDEV
+			|| errno == ENOSYS
+			|| errno == EINVAL
+			|| errno == EOPNOTSUPP)
+		{
+			useBuffer = true;
+			break;
+		}
+
+		result = "Failed to copy file '" + origin.string() + "' to '" + target.string() + "'! Reason: " + GetErrnoString();
+		break;
+	}
+#else
+	(void)size;
+#endif
+
+	if (useBuffer
+		&& result.empty())
+	{
+		//one buffer per worker, reused by every file the worker copies
+		thread_local vector<u8> buffer{};
+		if (buffer.empty()) buffer.resize(COPY_BUFFER_SIZE);
+
+		while (result.empty())
+		{
+			ssize_t readCount = read(in, buffer.data(), buffer.size());
+			if (readCount == 0) break;
+			if (readCount < 0)
+			{
+				if (errno == EINTR) continue;
+
+				result = "Failed to read file '" + origin.string() + "'! Reason: " + GetErrnoString();
+				break;
+			}
+
+			ssize_t written{};
+			while (written < readCount)
+			{
+				ssize_t w = write(out, buffer.data() + written, scast<size_t>(readCount - written));
+				if (w < 0)
+				{
+					if (errno == EINTR) continue;
+
+					result = "Failed to write file '" + target.string() + "'! Reason: " + GetErrnoString();
+					break;
+				}
+				written += w;
+			}
+		}
+	}
+
+	close(in);
+	if (close(out) == -1
+		&& result.empty())
+	{
+		result = "Failed to write file '" + target.string() + "'! Reason: " + GetErrnoString();
+	}
+
+	error_code ec{};
+	if (!result.empty())
+	{
+		//never leave a partial file behind that an incremental copy could mistake for a finished one
+		remove(target, ec);
+
+		return result;
+	}
+
+	//keep the origin time so that incremental copies can tell unchanged files apart
+	auto lastWrite = last_write_time(origin, ec);
+	if (!ec) last_write_time(target, lastWrite, ec);
+
+	return{};
+}
+#endif
+
+//Calls onProgress if nobody else has called it during the current interval
+static void ReportProgress(
+	const CopyOptions& options,
+	CopyState& state)
+{
+	if (!options.onProgress) return;
+
+	const i64 now = GetSteadyMS();
+	i64 last = state.lastReport.load(memory_order_relaxed);
+
+	if (now - last < scast<i64>(COPY_PROGRESS_INTERVAL_MS)) return;
+
+	//only the thread that wins the exchange reports this interval
+	if (!state.lastReport.compare_exchange_strong(last, now)) return;
+
+	CopyProgress progress{};
+	progress.doneFileCount = state.doneFileCount.load(memory_order_relaxed);
+	progress.totalFileCount = state.totalFileCount;
+	progress.doneSize = state.doneSize.load(memory_order_relaxed);
+	progress.totalSize = state.totalSize;
+
+	options.onProgress(progress);
+}
+
+//Copies one file unless options say the existing target should be kept
+static void CopyOneFile(
+	const CopyJob& job,
+	const CopyOptions& options,
+	CopyState& state)
+{
+	error_code ec{};
+	directory_entry existing(job.target, ec);
+
+	bool skip{};
+	if (!ec
+		&& existing.exists(ec))
+	{
+		if (options.incremental)
+		{
+			error_code sizeEC{};
+			error_code timeEC{};
+			error_code originEC{};
+
+			skip = existing.is_regular_file(ec)
+				&& existing.file_size(sizeEC) == job.size
+				&& !sizeEC
+				&& existing.last_write_time(timeEC) == last_write_time(job.origin, originEC)
+				&& !timeEC
+				&& !originEC;
+		}
+		else skip = !options.overwrite;
+	}
+
+	if (skip) state.skippedCount.fetch_add(1, memory_order_relaxed);
+	else
+	{
+		string result = CopyFileData(job.origin, job.target, job.size);
+
+		if (result.empty())
+		{
+			state.copiedCount.fetch_add(1, memory_order_relaxed);
+			state.copiedSize.fetch_add(job.size, memory_order_relaxed);
+		}
+		else AddFailure(state, move(result));
+	}
+
+	state.doneFileCount.fetch_add(1, memory_order_relaxed);
+	state.doneSize.fetch_add(job.size, memory_order_relaxed);
+
+	ReportProgress(options, state);
+}
+
+//Recreates the link itself at target, links are never followed
+static void CopyLink(
+	const path& origin,
+	const path& target,
+	const CopyOptions& options,
+	CopyState& state,
+	CopyStats& stats)
+{
+	error_code ec{};
+
+	if (exists(symlink_status(target, ec)))
+	{
+		if (!options.overwrite) return;
+
+		remove(target, ec);
+	}
+
+	copy_symlink(origin, target, ec);
+	if (ec)
+	{
+		AddFailure(state, "Failed to copy link '" + origin.string() + "' to '" + target.string() + "'! Reason: " + ec.message());
+
+		return;
+	}
+
+	++stats.linkCount;
+}
+
+//Returns a path next to target that doesn't exist yet, named after target and suffix,
+//so renaming between the two never crosses volumes
+static path GetFreeSiblingPath(
+	const path& target,
+	const string& suffix)
+{
+	const string name = target.filename().string() + suffix;
+
+	error_code ec{};
+	path sibling = target.parent_path() / name;
+	for (u32 i = 1; exists(symlink_status(sibling, ec)); ++i)
+	{
+		sibling = target.parent_path() / (name + to_string(i));
+	}
+
+	return sibling;
+}
+
+namespace KalaCLI
+{
+	string CopyEngine::CopyPath(
+		const path& origin,
+		const path& target,
+		const CopyOptions& options,
+		CopyStats& outStats)
+	{
+		const i64 startTime = GetSteadyMS();
+
+		outStats = {};
+
+		error_code ec{};
+
+		if (!exists(symlink_status(origin, ec)))
+		{
+			return "Failed to copy origin '" + origin.string() + "' because it does not exist!";
+		}
+		if (target.empty())
+		{
+			return "Failed to copy origin '" + origin.string() + "' because target is empty!";
+		}
+
+		const bool isFolder = !is_symlink(symlink_status(origin, ec)) && is_directory(origin, ec);
+
+		if (isFolder)
+		{
+			//a target inside origin would be walked into while it is being filled
+			const path canonicalOrigin = weakly_canonical(origin, ec);
+			const path canonicalTarget = weakly_canonical(target, ec);
+
+			auto [o, t] = mismatch(
+				canonicalOrigin.begin(),
+				canonicalOrigin.end(),
+				canonicalTarget.begin(),
+				canonicalTarget.end());
+
+			if (o == canonicalOrigin.end())
+			{
+				return "Failed to copy origin '" + origin.string() + "' to target '" + target.string() + "' because target is inside origin!";
+			}
+		}
+
+		CopyState state{};
+		vector<CopyJob> jobs{};
+
+		//the first progress call comes one interval after the start
+		state.lastReport = startTime;
+
+		if (target.has_parent_path()
+			&& !exists(target.parent_path(), ec))
+		{
+			create_directories(target.parent_path(), ec);
+			if (ec)
+			{
+				return "Failed to copy origin '" + origin.string() + "' because target folder '" + target.parent_path().string() + "' couldn't be created! Reason: " + ec.message();
+			}
+		}
+
+		if (is_symlink(symlink_status(origin, ec)))
+		{
+			CopyLink(origin, target, options, state, outStats);
+		}
+		else if (is_regular_file(origin, ec))
+		{
+			jobs.push_back({ origin, target, file_size(origin, ec) });
+		}
+		else if (isFolder)
+		{
+			if (!is_directory(target, ec))
+			{
+				create_directory(target, ec);
+				if (ec)
+				{
+					return "Failed to copy origin '" + origin.string() + "' because target '" + target.string() + "' couldn't be created! Reason: " + ec.message();
+				}
+			}
+
+			recursive_directory_iterator it(origin, directory_options::skip_permission_denied, ec);
+			if (ec)
+			{
+				return "Failed to copy origin '" + origin.string() + "' because it couldn't be opened! Reason: " + ec.message();
+			}
+
+			//folders are created here in walk order so every file task finds its folder already made
+			for (const recursive_directory_iterator end{}; it != end; it.increment(ec))
+			{
+				if (ec) break;
+
+				const directory_entry& entry = *it;
+				const path entryTarget = target / entry.path().lexically_relative(origin);
+
+				error_code entryEC{};
+				if (entry.is_symlink(entryEC))
+				{
+					CopyLink(entry.path(), entryTarget, options, state, outStats);
+				}
+				else if (entry.is_directory(entryEC))
+				{
+					if (!is_directory(entryTarget, entryEC))
+					{
+						create_directory(entryTarget, entryEC);
+						if (entryEC)
+						{
+							AddFailure(state, "Failed to create folder '" + entryTarget.string() + "'! Reason: " + entryEC.message());
+
+							//nothing inside it could be copied either
+							it.disable_recursion_pending();
+							continue;
+						}
+					}
+
+					++outStats.directoryCount;
+				}
+				else if (entry.is_regular_file(entryEC))
+				{
+					uintmax_t size = entry.file_size(entryEC);
+					if (entryEC)
+					{
+						AddFailure(state, "Failed to read file '" + entry.path().string() + "' size! Reason: " + entryEC.message());
+						continue;
+					}
+
+					jobs.push_back({ entry.path(), entryTarget, size });
+				}
+			}
+
+			if (ec)
+			{
+				AddFailure(state, "Failed to walk origin '" + origin.string() + "' to the end! Reason: " + ec.message());
+			}
+		}
+		else
+		{
+			return "Failed to copy origin '" + origin.string() + "' because it is not a regular file, folder or link!";
+		}
+
+		state.totalFileCount = jobs.size();
+		for (const auto& job : jobs) state.totalSize += job.size;
+
+		ThreadPool& pool = ThreadPool::GetShared();
+		vector<future<void>> tasks{};
+
+		size_t batchStart{};
+		while (batchStart < jobs.size())
+		{
+			size_t batchEnd = batchStart;
+			uintmax_t batchSize{};
+
+			while (batchEnd < jobs.size()
+				&& batchEnd - batchStart < COPY_BATCH_FILE_COUNT
+				&& batchSize < COPY_BATCH_SIZE)
+			{
+				batchSize += jobs[batchEnd].size;
+				++batchEnd;
+			}
+
+			tasks.push_back(pool.Submit([&jobs, &options, &state, batchStart, batchEnd]()
+				{
+					for (size_t i = batchStart; i < batchEnd; ++i)
+					{
+						CopyOneFile(jobs[i], options, state);
+					}
+				}));
+
+			batchStart = batchEnd;
+		}
+
+		//waiting runs queued batches on this thread too
+		for (auto& task : tasks) pool.Await(task);
+
+		outStats.fileCount = state.totalFileCount;
+		outStats.copiedCount = state.copiedCount.load();
+		outStats.copiedSize = state.copiedSize.load();
+		outStats.skippedCount = state.skippedCount.load();
+		outStats.failures = move(state.failures);
+		outStats.elapsedMS = scast<u64>(GetSteadyMS() - startTime);
+
+		if (!outStats.failures.empty())
+		{
+			return "Failed to copy " + to_string(outStats.failures.size())
+				+ " files or folders from origin '" + origin.string() + "' to target '" + target.string() + "'!";
+		}
+
+		return{};
+	}
+
+	string CopyEngine::MovePath(
+		const path& origin,
+		const path& target,
+		const CopyOptions& options,
+		CopyStats& outStats)
+	{
+		const i64 startTime = GetSteadyMS();
+
+		outStats = {};
+
+		error_code ec{};
+
+		if (!exists(symlink_status(origin, ec)))
+		{
+			return "Failed to move origin '" + origin.string() + "' because it does not exist!";
+		}
+		if (target.empty())
+		{
+			return "Failed to move origin '" + origin.string() + "' because target is empty!";
+		}
+
+		const bool hasTarget = exists(symlink_status(target, ec));
+		if (hasTarget)
+		{
+			if (equivalent(origin, target, ec))
+			{
+				return "Failed to move origin '" + origin.string() + "' because it is the same as target '" + target.string() + "'!";
+			}
+			if (!options.overwrite)
+			{
+				return "Failed to move origin '" + origin.string() + "' because target '" + target.string() + "' already exists!";
+			}
+		}
+		else if (target.has_parent_path()
+			&& !exists(target.parent_path(), ec))
+		{
+			create_directories(target.parent_path(), ec);
+			if (ec)
+			{
+				return "Failed to move origin '" + origin.string() + "' because target folder '" + target.parent_path().string() + "' couldn't be created! Reason: " + ec.message();
+			}
+		}
+
+		//an existing target is moved aside instead of deleted
+		//and only deleted once origin has fully taken its place
+		const path backup = hasTarget
+			? GetFreeSiblingPath(target, ".old")
+			: path{};
+
+		if (hasTarget)
+		{
+			rename(target, backup, ec);
+			if (ec)
+			{
+				return "Failed to move origin '" + origin.string() + "' because existing target '" + target.string() + "' couldn't be moved aside! Reason: " + ec.message();
+			}
+		}
+
+		rename(origin, target, ec);
+		if (!ec)
+		{
+			outStats.wasRenamed = true;
+			outStats.elapsedMS = scast<u64>(GetSteadyMS() - startTime);
+
+			if (hasTarget)
+			{
+				remove_all(backup, ec);
+				if (ec)
+				{
+					return "Moved origin '" + origin.string() + "' to target '" + target.string() + "' but the replaced target left at '" + backup.string() + "' couldn't be deleted! Reason: " + ec.message();
+				}
+			}
+
+			return{};
+		}
+
+		const error_code renameEC = ec;
+
+		if (hasTarget)
+		{
+			rename(backup, target, ec);
+			if (ec)
+			{
+				return "Failed to move origin '" + origin.string() + "' and the replaced target couldn't be put back from '" + backup.string() + "'! Reason: " + ec.message();
+			}
+		}
+
+		if (renameEC != errc::cross_device_link)
+		{
+			return "Failed to move origin '" + origin.string() + "' to target '" + target.string() + "'! Reason: " + renameEC.message();
+		}
+
+		//another volume, copy everything next to target first
+		//so that an existing target is only replaced by a complete copy
+		const path staging = GetFreeSiblingPath(target, ".partial");
+
+		CopyOptions copyOptions = options;
+		copyOptions.overwrite = true;
+		copyOptions.incremental = false;
+
+		string result = CopyPath(
+			origin,
+			staging,
+			copyOptions,
+			outStats);
+
+		if (!result.empty())
+		{
+			remove_all(staging, ec);
+			return "Failed to move origin '" + origin.string() + "' so it and target were kept! Reason: " + result;
+		}
+
+		if (hasTarget)
+		{
+			rename(target, backup, ec);
+			if (ec)
+			{
+				string reason = ec.message();
+				remove_all(staging, ec);
+
+				return "Failed to move origin '" + origin.string() + "' because existing target '" + target.string() + "' couldn't be moved aside! Reason: " + reason;
+			}
+		}
+
+		rename(staging, target, ec);
+		if (ec)
+		{
+			string reason = ec.message();
+			if (hasTarget) rename(backup, target, ec);
+			remove_all(staging, ec);
+
+			return "Failed to move origin '" + origin.string() + "' so it and target were kept! Reason: " + reason;
+		}
+
+		if (hasTarget)
+		{
+			remove_all(backup, ec);
+			if (ec)
+			{
+				return "Copied origin '" + origin.string() + "' to target '" + target.string() + "' but the replaced target left at '" + backup.string() + "' couldn't be deleted! Reason: " + ec.message();
+			}
+		}
+
+		remove_all(origin, ec);
+		if (ec)
+		{
+			return "Failed to move origin '" + origin.string() + "' because it was copied to target but couldn't be deleted! Reason: " + ec.message();
+		}
+
+		outStats.elapsedMS = scast<u64>(GetSteadyMS() - startTime);
+
+		return{};
+	}
+}
@@ -7,53 +7,243 @@
 #include <string>
 #include <vector>
 #include <filesystem>
+#include <fstream>
+#include <chrono>
+#include <cstdio>
+#include <charconv>
+#include <future>
+#include <algorithm>
+#include <mutex>
 
 #include "KalaHeaders/log_utils.hpp"
-#include "KalaHeaders/string_utils.hpp"
 #include "KalaHeaders/file_utils.hpp"
+#include "KalaHeaders/string_utils.hpp"
+#include "KalaHeaders/thread_utils.hpp"
 
 #include "core.hpp"
 #include "command.hpp"
+#include "lexer.hpp"
+#include "process.hpp"
+#include "disk_usage.hpp"
+#include "copy_engine.hpp"
+#include "asset_inspector.hpp"
+#include "command_stats.hpp"
+#include "command_server.hpp"
+#include "output_sink.hpp"
+#include "binary_log.hpp"
+#include "dir_watcher.hpp"
 
 using KalaHeaders::KalaLog::Log;
 using KalaHeaders::KalaLog::LogType;
-using KalaHeaders::KalaString::ContainsString;
-using KalaHeaders::KalaString::SplitString;
-using KalaHeaders::KalaString::TrimString;
-using KalaHeaders::KalaString::TokenizeString;
-using KalaHeaders::KalaFile::ListDirectoryContents;
+using KalaHeaders::KalaFile::VisitDirectoryContents;
+using KalaHeaders::KalaFile::VisitResult;
+using KalaHeaders::KalaFile::GetRangesByValues;
+using KalaHeaders::KalaFile::PatternRange;
+using KalaHeaders::KalaThread::ThreadPool;
+using KalaHeaders::KalaFile::GetFileSize;
+using KalaHeaders::KalaFile::GetBinaryChunkStreamSize;
+using KalaHeaders::KalaFile::CHUNK_64KB;
+using KalaHeaders::KalaFile::CHUNK_1MB;
+using KalaHeaders::KalaString::MatchesGlob;
 
 using KalaCLI::Core;
 using KalaCLI::Command;
+using KalaCLI::StaticCommand;
+using KalaCLI::MakeCommandTable;
+using KalaCLI::ParamSpec;
+using KalaCLI::ParamType;
+using KalaCLI::ParamSchema;
+using KalaCLI::ParamParser;
+using KalaCLI::ParsedArgs;
 using KalaCLI::CommandManager;
+using KalaCLI::Lexer;
+using KalaCLI::LexedLine;
+using KalaCLI::ProcessLauncher;
+using KalaCLI::ProcessJob;
+using KalaCLI::COMMAND_PREFIX;
+using KalaCLI::RUN_ASYNC_FLAG;
+using KalaCLI::RUN_CAPTURE_FLAG;
+using KalaCLI::RUN_SHELL_FLAG;
+using KalaCLI::LIST_RECURSIVE_FLAG;
+using KalaCLI::LIST_LIMIT_FLAG;
+using KalaCLI::LIST_FILTER_FLAG;
+using KalaCLI::DU_NO_CACHE_FLAG;
+using KalaCLI::FIND_BYTES_IN_FLAG;
+using KalaCLI::FIND_BYTES_HEX_PREFIX;
+using KalaCLI::DiskUsage;
+using KalaCLI::DirectorySize;
+using KalaCLI::COPY_OVERWRITE_FLAG;
+using KalaCLI::COPY_INCREMENTAL_FLAG;
+using KalaCLI::CopyEngine;
+using KalaCLI::CopyOptions;
+using KalaCLI::CopyProgress;
+using KalaCLI::CopyStats;
+using KalaCLI::INSPECT_JSON_FLAG;
+using KalaCLI::INSPECT_TABLES_FLAG;
+using KalaCLI::AssetInspector;
+using KalaCLI::AssetType;
+using KalaCLI::AssetTable;
+using KalaCLI::AssetSummary;
+using KalaCLI::InspectStats;
+using KalaCLI::PROFILE_FLAG;
+using KalaCLI::PLAIN_FLAG;
+using KalaCLI::STATS_JSON_FLAG;
+using KalaCLI::CommandStats;
+using KalaCLI::CommandTimings;
+using KalaCLI::StatsSnapshot;
+using KalaCLI::SERVE_FLAG;
+using KalaCLI::CLIENT_FLAG;
+using KalaCLI::CommandServer;
+using KalaCLI::OutputSink;
+using KalaCLI::OutputStyle;
+using KalaCLI::BINARY_LOG_FLAG;
+using KalaCLI::LOGDUMP_TYPE_FLAG;
+using KalaCLI::LOGDUMP_TAG_FLAG;
+using KalaCLI::BinaryLog;
+using KalaCLI::BinaryLogFilter;
+using KalaCLI::BinaryLogRecord;
+using KalaCLI::WATCH_STOP_FLAG;
+using KalaCLI::DirectoryWatcher;
+using KalaCLI::WatchedEntry;
 
 using std::cin;
+using std::istream;
+using std::ifstream;
+using std::ios;
+using std::streamsize;
+using std::chrono::steady_clock;
+using std::chrono::duration_cast;
+using std::chrono::milliseconds;
 using std::getline;
 using std::ostringstream;
 using std::string;
+using std::string_view;
 using std::to_string;
 using std::vector;
+using std::span;
+using std::future;
+using std::function;
+using std::size;
+using std::from_chars;
+using std::errc;
+using std::error_code;
+using std::sort;
+using std::mutex;
+using std::lock_guard;
 using std::filesystem::current_path;
 using std::filesystem::path;
+using std::filesystem::directory_entry;
+
+//Failed line listed in the batch summary
+struct BatchFailure
+{
+	size_t lineNumber{};
+	size_t failedCount{}; //failed commands of the line, more than one if it chains them
+	string line{};
+};
+
+//How many failed lines are listed by name in the batch summary
+constexpr size_t MAX_LISTED_FAILURES = 20;
+
+//How many matches are listed per file by find-bytes
+constexpr size_t MAX_LISTED_MATCHES = 20;
+
+//How many tables are listed per file by inspect unless '--tables' is passed
+constexpr size_t MAX_LISTED_TABLES = 20;
+
+//Set by the '--profile' launch flag
+static bool isProfiling{};
+
+//Formatted help output, rebuilt only after commands were registered
+static string helpCache{};
+static u64 helpCacheVersion = UINT64_MAX;
+static bool helpCacheIsPlain{};
+static mutex helpCacheMutex{};
+
+//Flushes all output and exits with the batch result
+static void ExitBatch(int exitCode);
+
+//Writes the per-command stats as JSON to stderr if '--profile' was passed,
+//must be called after the last Log::Flush because it bypasses the log
+static void PrintProfile();
+
+//Size in the largest unit that keeps the value at or above 1, for example '3.42 GB'
+static string FormatSize(uintmax_t bytes);
+
+//Duration in the largest unit that keeps the value at or above 1, for example '4.56 ms'
+static string FormatDuration(u64 ns);
+
+//Prints the totals and failures of a finished copy or move
+static void PrintCopyStats(
+	string_view action,
+	const path& origin,
+	const path& target,
+	const CopyStats& stats,
+	const string& result);
+
+//Appends text as a quoted JSON string with quotes, backslashes and control characters escaped
+static void AppendJSONString(
+	ostringstream& oss,
+	string_view text);
+
+//Builds one JSON object of the dispatch totals and the timings of every invoked command
+static string StatsToJSON(const StatsSnapshot& snapshot);
 
 static void AddBuiltInCommands();
 
+//Appends every primary variant of a runtime or static command separated by commas
+template<typename T>
+static void AppendPrimaryVariants(
+	string& out,
+	const T& command);
+
+//Appends the primary variants, description, param count and thread-safety of a runtime or static command
+template<typename T>
+static void AppendCommandInfo(
+	OutputSink& out,
+	const T& command);
+
 //Built-in command for listing all commands
-static void Command_Help(const vector<string>& params);
+static void Command_Help(span<const string_view> params);
 //Built-in command for listing info about chosen command
-static void Command_Info(const vector<string>& params);
+static void Command_Info(span<const string_view> params);
+//Built-in command for listing every command that starts with chosen prefix
+static void Command_Complete(span<const string_view> params);
 
 //Built-in command for listing current path
-static void Command_Where(const vector<string>& params);
+static void Command_Where(span<const string_view> params);
 //Built-in command for listing all files and folders in current dir
-static void Command_List(const vector<string>& params);
+static void Command_List(const ParsedArgs& args);
 //Built-in command for going to desired path
-static void Command_Go(const vector<string>& params);
+static void Command_Go(const ParsedArgs& args);
+//Built-in command for measuring the total size of current or chosen directory
+static void Command_DiskUsage(span<const string_view> params);
+//Built-in command for keeping a snapshot of current or chosen directory up to date for list and du
+static void Command_Watch(const ParsedArgs& args);
+//Built-in command for searching several byte patterns in several files at once
+static void Command_FindBytes(span<const string_view> params);
+//Built-in command for copying a file or folder tree in parallel
+static void Command_Copy(span<const string_view> params);
+//Built-in command for moving a file or folder tree
+static void Command_Move(span<const string_view> params);
+//Built-in command for summarizing the headers and tables of kfd and kmd files
+static void Command_Inspect(span<const string_view> params);
+
+//Built-in command for listing the invocation counts and handler latencies of every invoked command
+static void Command_Stats(span<const string_view> params);
+
+//Built-in command for decoding and filtering a binary log written with '--binary-log'
+static void Command_LogDump(const ParsedArgs& args);
+
+//Built-in command for listing all background jobs started with 'run --async'
+static void Command_Jobs(span<const string_view> params);
+//Built-in command for waiting until chosen background job has exited
+static void Command_Wait(const ParsedArgs& args);
 
 //Built-in command for cleaning console commands
-static void Command_Clear(const vector<string>& params);
+static void Command_Clear(span<const string_view> params);
 //Built-in command for closing the cli
-static void Command_Exit(const vector<string>& params);
+static void Command_Exit(span<const string_view> params);
 
 namespace KalaCLI
 {
@@ -62,13 +252,137 @@ namespace KalaCLI
 		char* argv[],
 		function<void()> AddExternalCommands)
 	{
+		//stripped before the other launch flags so they keep their usual positions
+		while (argc > 1
+			&& (argv[1] == PROFILE_FLAG
+			|| argv[1] == PLAIN_FLAG
+			|| argv[1] == BINARY_LOG_FLAG))
+		{
+			//opened before anything prints so that the whole run ends up in one file
+			if (argv[1] == BINARY_LOG_FLAG)
+			{
+				string result = argc > 2
+					? BinaryLog::Open(argv[2])
+					: "Launch flag '" + string(BINARY_LOG_FLAG) + "' needs a target file!";
+
+				if (!result.empty())
+				{
+					Log::Print(
+						result,
+						"LOG",
+						LogType::LOG_ERROR,
+						2);
+
+					ExitBatch(1);
+				}
+
+				argv[2] = argv[0];
+				argv += 2;
+				argc -= 2;
+
+				continue;
+			}
+
+			if (argv[1] == PROFILE_FLAG) isProfiling = true;
+			else OutputSink::SetStyle(OutputStyle::OUTPUT_PLAIN);
+
+			argv[1] = argv[0];
+			++argv;
+			--argc;
+		}
+
+		//forwarded before registration so the client never pays for it
+		if (argc > 3
+			&& argv[1] == CLIENT_FLAG)
+		{
+			vector<string_view> params{};
+			for (int i = 3; i < argc; ++i) params.emplace_back(argv[i]);
+
+			bool succeeded{};
+			if (CommandServer::Forward(argv[2], params, succeeded).empty())
+			{
+				ExitBatch(succeeded ? 0 : 1);
+			}
+
+			//no server is listening, so the forwarded params run here as a one-shot command
+			argv[2] = argv[0];
+			argv += 2;
+			argc -= 2;
+		}
+
+		//set once up front so that thread-safe commands chained with '&&&' only ever read it
+		if (currentDir.empty()) currentDir = current_path().string();
+
 		AddBuiltInCommands();
 		if (AddExternalCommands) AddExternalCommands();
 
+		//run a script file or piped stdin as a batch and exit,
+		//batches never prompt so their output can go through the async log sink
+		if (argc == 3
+			&& argv[1] == SCRIPT_FLAG)
+		{
+			Log::EnableAsyncSink();
+
+			path script = argv[2];
+
+			uintmax_t scriptSize{};
+			string result = GetFileSize(script, scriptSize);
+			if (!result.empty())
+			{
+				Log::Print(
+					"Failed to run script! Reason: " + result,
+					"BATCH",
+					LogType::LOG_ERROR,
+					2);
+
+				ExitBatch(1);
+			}
+
+			ifstream in(script, ios::in | ios::binary);
+			if (!in)
+			{
+				Log::Print(
+					"Failed to run script '" + script.string() + "' because it couldn't be opened!",
+					"BATCH",
+					LogType::LOG_ERROR,
+					2);
+
+				ExitBatch(1);
+			}
+
+			size_t failed = RunBatch(in, GetBinaryChunkStreamSize(scriptSize));
+			ExitBatch(failed == 0 ? 0 : 1);
+		}
+		if (argc == 3
+			&& argv[1] == SERVE_FLAG)
+		{
+			string result = CommandServer::Serve(argv[2]);
+			if (!result.empty())
+			{
+				Log::Print(
+					result,
+					"SERVE",
+					LogType::LOG_ERROR,
+					2);
+
+				ExitBatch(1);
+			}
+
+			ExitBatch(0);
+		}
+		if (argc == 2
+			&& argv[1] == STDIN_BATCH_FLAG)
+		{
+			Log::EnableAsyncSink();
+
+			size_t failed = RunBatch(cin, CHUNK_1MB);
+			ExitBatch(failed == 0 ? 0 : 1);
+		}
+
 		//run the passed command if one was passed
 		if (argc > 1)
 		{
-			vector<string> params{};
+			vector<string_view> params{};
 			for (int i = 1; i < argc; ++i) params.emplace_back(argv[i]);
 
 			if (!params.empty()) CommandManager::ParseCommand(params);
@@ -78,224 +392,606 @@ namespace KalaCLI
 		}
 
 		string line{};
+		LexedLine lexedLine{};
 		while (true)
 		{
 			Log::Print("\nEnter command:");
+			Log::Flush();
 
-			getline(cin, line);
+			//stdin was closed or reached the end of a piped script
+			if (!getline(cin, line)) Command_Exit({});
 
 			//uncomment if you want each new command to clean the console
 			//system("cls");
 
 			if (line.empty()) continue;
 
-			vector<string> splitCommands{};
-			if (ContainsString(line, "&"))
-			{
-				splitCommands = SplitString(line, "&");
-			}
-			else splitCommands.push_back(line);
-			
-			for (const auto& c : splitCommands)
+			Lexer::Tokenize(line, lexedLine);
+			CommandManager::ParseLine(lexedLine);
+		}
+	}
+
+	size_t Core::RunBatch(
+		istream& in,
+		size_t chunkSize)
+	{
+		const auto startTime = steady_clock::now();
+
+		if (chunkSize == 0) chunkSize = CHUNK_64KB;
+
+		//pending holds the unfinished last line of the previous chunk followed by the new chunk
+		string pending{};
+		pending.reserve(chunkSize * 2);
+
+		LexedLine lexedLine{};
+
+		size_t lineNumber{};
+		size_t commandCount{};
+		size_t failedCount{};
+		size_t failedLineCount{};
+		vector<BatchFailure> failures{};
+
+		auto RunLine = [&](string_view line)
 			{
-				string cleanedLine = TrimString(c);
-				
-				vector<string> splitValue{};
-				char token{};
-				if (cleanedLine.find('"') != string::npos) token = '"';
-				if (cleanedLine.find('\'') != string::npos) token = '\'';
-				
-				if (token != 0)
+				++lineNumber;
+
+				if (!line.empty()
+					&& line.back() == '\r')
+				{
+					line.remove_suffix(1);
+				}
+				if (line.empty()) return;
+
+				Lexer::Tokenize(line, lexedLine);
+
+				commandCount += lexedLine.commands.size();
+
+				size_t failedInLine = CommandManager::ParseLine(lexedLine);
+				failedCount += failedInLine;
+
+				if (failedInLine == 0) return;
+
+				++failedLineCount;
+				if (failures.size() < MAX_LISTED_FAILURES)
 				{
-					splitValue = TokenizeString(
-						cleanedLine,
-						token,
-						" ");
+					failures.push_back({ lineNumber, failedInLine, string(line) });
 				}
-				else splitValue = SplitString(cleanedLine, " ");
+			};
 
-				if (splitValue.size() == 0) continue;
+		vector<char> chunk(chunkSize);
+		while (in)
+		{
+			in.read(chunk.data(), scast<streamsize>(chunkSize));
+			size_t bytesRead = scast<size_t>(in.gcount());
+			if (bytesRead == 0) break;
+
+			pending.append(chunk.data(), bytesRead);
+
+			string_view remaining = pending;
+			size_t newLine{};
+			while ((newLine = remaining.find('\n')) != string_view::npos)
+			{
+				RunLine(remaining.substr(0, newLine));
+				remaining.remove_prefix(newLine + 1);
+			}
+
+			pending.erase(0, pending.size() - remaining.size());
+		}
+
+		//last line without a trailing newline
+		if (!pending.empty()) RunLine(pending);
 
-				CommandManager::ParseCommand(splitValue);
+		const auto elapsed = duration_cast<milliseconds>(steady_clock::now() - startTime).count();
+
+		ostringstream oss{};
+
+		oss << "\nBatch finished: " << commandCount << " commands from "
+			<< lineNumber << " lines, " << failedCount << " failed, elapsed "
+			<< elapsed << " ms";
+
+		if (!failures.empty())
+		{
+			oss << "\nFailed lines:";
+			for (const auto& f : failures)
+			{
+				oss << "\n  - line " << f.lineNumber;
+				if (f.failedCount > 1) oss << " (" << f.failedCount << " failed)";
+				oss << ": " << f.line;
+			}
+			if (failedLineCount > failures.size())
+			{
+				oss << "\n  - ...and " << (failedLineCount - failures.size()) << " more lines";
 			}
 		}
+
+		Log::Print(oss.str());
+
+		return failedCount;
 	}
 }
 
-void AddBuiltInCommands()
+void ExitBatch(int exitCode)
+{
+	//quick_exit skips stdio cleanup, so queued and buffered batch output must be pushed out first
+	Log::Flush();
+	BinaryLog::Close();
+	PrintProfile();
+
+	quick_exit(exitCode);
+}
+
+void PrintProfile()
+{
+	if (!isProfiling) return;
+
+	const string json = StatsToJSON(CommandStats::GetSnapshot()) + "\n";
+
+	fwrite(json.data(), 1, json.size(), stderr);
+	fflush(stderr);
+}
+
+//Param schemas of the built-in commands that take typed params,
+//option indexes follow the order of each options array
+static constexpr ParamSpec listOptions[] =
+{
+	{ .name = LIST_RECURSIVE_FLAG, .type = ParamType::PARAM_FLAG },
+	{ .name = LIST_LIMIT_FLAG, .type = ParamType::PARAM_INT, .minValue = 1 },
+	{ .name = LIST_FILTER_FLAG, .type = ParamType::PARAM_STRING }
+};
+static constexpr ParamSchema listSchema{ .options = listOptions };
+constexpr size_t LIST_RECURSIVE_OPTION = 0;
+constexpr size_t LIST_LIMIT_OPTION = 1;
+constexpr size_t LIST_FILTER_OPTION = 2;
+
+static constexpr ParamSpec watchParams[] =
+{
+	{ .name = "target", .type = ParamType::PARAM_PATH }
+};
+static constexpr ParamSpec watchOptions[] =
+{
+	{ .name = WATCH_STOP_FLAG, .type = ParamType::PARAM_FLAG }
+};
+static constexpr ParamSchema watchSchema{ .params = watchParams, .options = watchOptions };
+constexpr size_t WATCH_STOP_OPTION = 0;
+
+static constexpr ParamSpec goParams[] =
 {
-	Command cmd_help
+	{ .name = "target", .type = ParamType::PARAM_PATH }
+};
+static constexpr ParamSchema goSchema{ .params = goParams, .minCount = 1 };
+
+static constexpr ParamSpec waitParams[] =
+{
+	{ .name = "job", .type = ParamType::PARAM_INT, .minValue = 0, .maxValue = UINT32_MAX }
+};
+static constexpr ParamSchema waitSchema{ .params = waitParams, .minCount = 1 };
+
+//Choices follow the order of LogType so that the parsed index is the type
+static constexpr ParamSpec logDumpParams[] =
+{
+	{ .name = "file", .type = ParamType::PARAM_PATH }
+};
+static constexpr ParamSpec logDumpOptions[] =
+{
+	{ .name = LOGDUMP_TYPE_FLAG, .type = ParamType::PARAM_ENUM, .choices = "info|debug|success|warning|error" },
+	{ .name = LOGDUMP_TAG_FLAG, .type = ParamType::PARAM_STRING }
+};
+static constexpr ParamSchema logDumpSchema{ .params = logDumpParams, .options = logDumpOptions, .minCount = 1 };
+constexpr size_t LOGDUMP_TYPE_OPTION = 0;
+constexpr size_t LOGDUMP_TAG_OPTION = 1;
+
+//Built-in commands, compiled into a sorted table so that registering them never allocates
+static constexpr auto builtInCommands = MakeCommandTable(
+	StaticCommand
 	{
 		.primary = { "help" },
 		.description = "Lists all available commands.",
 		.paramCount = 1,
-		.targetFunction = Command_Help
-	};
-	Command cmd_info
+		.targetFunction = Command_Help,
+		.isThreadSafe = true
+	},
+	StaticCommand
 	{
 		.primary = { "info" },
 		.description = "Lists info about chosen command.",
 		.paramCount = 2,
-		.targetFunction = Command_Info
-	};
+		.targetFunction = Command_Info,
+		.isThreadSafe = true
+	},
+
+	StaticCommand
+	{
+		.primary = { "complete" },
+		.description = "Lists up to 64 commands that start with chosen prefix, or every command if no prefix is passed, one per line for shell completion scripts.",
+		.paramCount = 1,
+		.maxParamCount = 2,
+		.targetFunction = Command_Complete,
+		.isThreadSafe = true
+	},
 
-	Command cmd_where
+	StaticCommand
 	{
 		.primary = { "where" },
 		.description = "Displays current path.",
 		.paramCount = 1,
-		.targetFunction = Command_Where
-	};
-	Command cmd_list
+		.targetFunction = Command_Where,
+		.isThreadSafe = true
+	},
+	StaticCommand
 	{
 		.primary = { "list" },
-		.description = "Lists all files and folders in current directory.",
-		.paramCount = 1,
-		.targetFunction = Command_List
-	};
-	Command cmd_go
+		.description = "Lists all files and folders in current directory, with optional '--recursive', '--limit <count>' and '--filter <glob>' options.",
+		.schema = &listSchema,
+		.targetArgsFunction = Command_List,
+		.isThreadSafe = true
+	},
+	StaticCommand
 	{
 		.primary = { "go" },
 		.description = "Goes to chosen directory.",
-		.paramCount = 2,
-		.targetFunction = Command_Go
-	};
+		.schema = &goSchema,
+		.targetArgsFunction = Command_Go
+	},
+	StaticCommand
+	{
+		.primary = { "du" },
+		.description = "Measures the total size of current or chosen directory in parallel, unchanged folders are reused from earlier runs unless '--no-cache' is passed.",
+		.paramCount = 1,
+		.maxParamCount = 3,
+		.targetFunction = Command_DiskUsage,
+		.isThreadSafe = true
+	},
+	StaticCommand
+	{
+		.primary = { "watch" },
+		.description = "Watches current or chosen directory for changes so that 'list' and 'du' answer from a snapshot that is kept up to date instead of walking it again, '--stop' stops watching.",
+		.schema = &watchSchema,
+		.targetArgsFunction = Command_Watch
+	},
+	StaticCommand
+	{
+		.primary = { "find-bytes", "fb" },
+		.description = "Searches every file after '--in' for every pattern before it in a single pass per file, with files searched in parallel. Patterns starting with '0x' are read as hex bytes.",
+		.paramCount = 4,
+		.maxParamCount = 255,
+		.targetFunction = Command_FindBytes,
+		.isThreadSafe = true
+	},
+	StaticCommand
+	{
+		.primary = { "copy", "cp" },
+		.description = "Copies chosen file or folder to chosen target with files copied in parallel. Existing files are kept unless '--overwrite' is passed, '--incremental' only copies files whose size or last write time changed.",
+		.paramCount = 3,
+		.maxParamCount = 5,
+		.targetFunction = Command_Copy
+	},
+	StaticCommand
+	{
+		.primary = { "move", "mv" },
+		.description = "Moves chosen file or folder to chosen target, an existing target is only replaced if '--overwrite' is passed.",
+		.paramCount = 3,
+		.maxParamCount = 4,
+		.targetFunction = Command_Move
+	},
+	StaticCommand
+	{
+		.primary = { "inspect" },
+		.description = "Summarizes the header and tables of chosen kfd or kmd file, or of every kfd and kmd file in current or chosen directory in parallel, without reading their blocks. '--json' prints one JSON object per file and one for the totals, '--tables' lists every table of every file.",
+		.paramCount = 1,
+		.maxParamCount = 4,
+		.targetFunction = Command_Inspect,
+		.isThreadSafe = true
+	},
+
+	StaticCommand
+	{
+		.primary = { "stats" },
+		.description = "Lists how often every command was called, how often it failed and the p50, p99 and max time spent in its handler, with '--json' printing them as one JSON object.",
+		.paramCount = 1,
+		.maxParamCount = 2,
+		.targetFunction = Command_Stats,
+		.isThreadSafe = true
+	},
 
-	Command cmd_clear
+	StaticCommand
+	{
+		.primary = { "logdump" },
+		.description = "Decodes chosen binary log written with '--binary-log', with optional '--type <info|debug|success|warning|error>' and '--tag <tag>' options for only listing matching records.",
+		.schema = &logDumpSchema,
+		.targetArgsFunction = Command_LogDump,
+		.isThreadSafe = true
+	},
+
+	StaticCommand
+	{
+		.primary = { "jobs" },
+		.description = "Lists all background jobs started with 'run --async' and their exit codes.",
+		.paramCount = 1,
+		.targetFunction = Command_Jobs,
+		.isThreadSafe = true
+	},
+	StaticCommand
+	{
+		.primary = { "wait" },
+		.description = "Waits until chosen background job has exited.",
+		.schema = &waitSchema,
+		.targetArgsFunction = Command_Wait,
+		.isThreadSafe = true
+	},
+
+	StaticCommand
 	{
 		.primary = { "clear", "c" },
 		.description = "Clears the console from all messages.",
 		.paramCount = 1,
 		.targetFunction = Command_Clear
-	};
-	Command cmd_exit
+	},
+	StaticCommand
 	{
 		.primary = { "exit", "e" },
 		.description = "Asks for user to press enter to close the cli, good for reading messages before quitting.",
 		.paramCount = 1,
 		.targetFunction = Command_Exit
-	};
-	Command cmd_qe
+	},
+	StaticCommand
 	{
 		.primary = { "quickexit", "qe" },
 		.description = "Quickly exits this cli without any 'Press Enter to quit' confirmation.",
 		.paramCount = 1,
 		.targetFunction = Command_Exit
-	};
+	});
 
-	CommandManager::AddCommand(cmd_help);
-	CommandManager::AddCommand(cmd_info);
+void AddBuiltInCommands()
+{
+	CommandManager::AddStaticCommands(builtInCommands);
+}
 
-	CommandManager::AddCommand(cmd_where);
-	CommandManager::AddCommand(cmd_list);
-	CommandManager::AddCommand(cmd_go);
+template<typename T>
+void AppendPrimaryVariants(
+	string& out,
+	const T& command)
+{
+	bool isFirst = true;
+	for (const auto& p : command.primary)
+	{
+		//static commands leave their unused trailing variants empty
+		if (string_view(p).empty()) continue;
 
-	CommandManager::AddCommand(cmd_clear);
-	CommandManager::AddCommand(cmd_exit);
-	CommandManager::AddCommand(cmd_qe);
+		if (!isFirst) out += ", ";
+		out += p;
+		isFirst = false;
+	}
 }
 
-void Command_Help(const vector<string>& params)
+template<typename T>
+void AppendCommandInfo(
+	OutputSink& out,
+	const T& command)
 {
-	ostringstream result{};
+	string variants{};
+	AppendPrimaryVariants(variants, command);
 
-	result << "\nType 'info' with a command name as the"
-		<< " second parameter to get more info about that command.\n"
-		<< "Use the ampersand (&) symbol to stack commands, for example '--list & --qe' to list and quick exit.\n\n"
-		<< "Listing all commands:\n"
-		<< "  run, r\n";
-	for (const auto& c : CommandManager::commands)
+	out.Format("primary variants: {}\ndescription: {}\n", variants, command.description);
+
+	if (command.schema) out.Format("parameters: {}\n", ParamParser::FormatUsage(*command.schema));
+	else
 	{
-		for (const auto& p : c.primary)
-		{
-			if (p == c.primary[0]) result << "  ";
-			result << p;
-			if (p != c.primary[c.primary.size() - 1])
-			{
-				result << ", ";
-			}
-			else result << "\n";
-		}
+		out.Format("parameter count: {}", command.paramCount);
+		if (command.maxParamCount > command.paramCount) out.Format("-{}", command.maxParamCount);
+		out.Append('\n');
 	}
 
-	Log::Print(result.str());
+	out.Format("thread-safe: {}\n", command.isThreadSafe ? "yes" : "no");
 }
 
-void Command_Info(const vector<string>& params)
+void Command_Help(span<const string_view>)
 {
-	string command = params[1];
+	OutputSink& out = OutputSink::Get();
+	const bool isPlain = OutputSink::IsPlain();
 
-	ostringstream result{};
+	//help runs on worker threads when chained with '&&&', so the cache is only touched under its lock
+	lock_guard lock(helpCacheMutex);
 
-	result << "\n";
-	
-	if (command == "run"
-		|| command == "r")
+	if (helpCacheVersion == CommandManager::GetRegistrationVersion()
+		&& helpCacheIsPlain == isPlain)
 	{
-		result << "Runs selected user command with any amount of parameters.";
-		
-		Log::Print(result.str());
-		
+		out.Append(helpCache);
 		return;
 	}
 
-	Command cmd{};
+	helpCache.clear();
 
+	if (!isPlain)
+	{
+		helpCache += "\nType 'info' with a command name as the"
+			" second parameter to get more info about that command.\n"
+			"Use the ampersand (&) symbol to stack commands, for example '--list & --qe' to list and quick exit.\n"
+			"Use three ampersands (&&&) to run stacked commands at the same time, for example '--r make a &&& --r make b'.\n"
+			"Launch with '--script <file>' or '--stdin-batch' to run every line as a command without prompting.\n"
+			"Launch with '--serve <endpoint>' to keep this cli open and '--client <endpoint> <command>' to run commands in it.\n"
+			"Put '--profile' before any other launch flag to print the per-command stats as JSON to stderr on exit.\n"
+			"Put '--plain' before any other launch flag to print only the data of listings, without headings or bullets.\n"
+			"Put '--binary-log <file>' before any other launch flag to record every log print to file as binary, read it back with 'logdump'.\n\n"
+			"Listing all commands:\n";
+	}
+
+	const string_view indent = isPlain ? "" : "  ";
+
+	helpCache += indent;
+	helpCache += "run, r\n";
+	for (size_t i = 0; i < CommandManager::GetStaticCommandCount(); ++i)
+	{
+		helpCache += indent;
+		AppendPrimaryVariants(helpCache, CommandManager::GetStaticCommand(i));
+		helpCache += '\n';
+	}
 	for (const auto& c : CommandManager::commands)
 	{
-		if (find(c.primary.begin(), c.primary.end(), command) != c.primary.end())
-		{
-			cmd = c;
-			break;
-		}
+		helpCache += indent;
+		AppendPrimaryVariants(helpCache, c);
+		helpCache += '\n';
 	}
-	
-	if (cmd.primary.empty()
-		&& cmd.paramCount == 0
-		&& !cmd.targetFunction)
+
+	helpCacheVersion = CommandManager::GetRegistrationVersion();
+	helpCacheIsPlain = isPlain;
+
+	out.Append(helpCache);
+}
+
+void Command_Complete(span<const string_view> params)
+{
+	string_view prefix = params.size() == 2 ? params[1] : string_view{};
+	if (!COMMAND_PREFIX.empty()
+		&& prefix.starts_with(COMMAND_PREFIX))
 	{
-		Log::Print(
-			"Cannot print info about a command that doesn't exist!",
-			"PARSE",
-			LogType::LOG_ERROR,
-			2);
+		prefix.remove_prefix(COMMAND_PREFIX.size());
+	}
+
+	vector<string> aliases{};
+	CommandManager::CompleteCommand(prefix, aliases);
+
+	//one bare line per command in both styles so shell completion scripts can read it without parsing
+	OutputSink& out = OutputSink::Get();
+	for (const auto& a : aliases) out.Format("{}{}\n", COMMAND_PREFIX, a);
+}
+
+void Command_Info(span<const string_view> params)
+{
+	string_view command = params[1];
+
+	OutputSink& out = OutputSink::Get();
+	const string_view lead = OutputSink::IsPlain() ? "" : "\n";
+
+	if (command == "run"
+		|| command == "r")
+	{
+		out.Append(lead);
+		out.Format(
+			"Runs selected program directly with any amount of parameters.\n"
+			"options (placed before the program):\n"
+			"  {}   - starts the program as a background job and prints its job id\n"
+			"  {} - reads the program output through a pipe and prints it once it exits\n"
+			"  {}   - runs through the system shell for shell built-ins, pipes and redirection,\n"
+			"              a single quoted argument is passed to the shell as the whole command line\n",
+			RUN_ASYNC_FLAG,
+			RUN_CAPTURE_FLAG,
+			RUN_SHELL_FLAG);
 
 		return;
 	}
 
-	result << "primary variants: ";
-	for (const auto& p : cmd.primary)
+	if (const StaticCommand* found = CommandManager::FindStaticCommand(command))
 	{
-		result << p;
-		if (p != cmd.primary[cmd.primary.size() - 1])
-		{
-			result << ", ";
-		}
-		else result << "\n";
+		out.Append(lead);
+		AppendCommandInfo(out, *found);
+		return;
 	}
 
-	result << "description: " << cmd.description << "\n";
-	result << "parameter count: " << to_string(cmd.paramCount);
+	if (const Command* found = CommandManager::FindCommand(command))
+	{
+		out.Append(lead);
+		AppendCommandInfo(out, *found);
+		return;
+	}
 
-	Log::Print(result.str());
+	Log::Print(
+		"Cannot print info about a command that doesn't exist!",
+		"PARSE",
+		LogType::LOG_ERROR,
+		2);
 }
 
-void Command_Where(const vector<string>& params)
+void Command_Where(span<const string_view>)
 {
 	if (Core::currentDir.empty()) Core::currentDir = current_path().string();
-	Log::Print("\nCurrently at: " + Core::currentDir);
+
+	OutputSink& out = OutputSink::Get();
+	if (OutputSink::IsPlain()) out.Format("{}\n", Core::currentDir);
+	else out.Format("\nCurrently at: {}\n", Core::currentDir);
 }
 
-void Command_List(const vector<string>& params)
+void Command_List(const ParsedArgs& args)
 {
 	if (Core::currentDir.empty()) Core::currentDir = current_path().string();
 
-	vector<path> content{};
+	const bool isRecursive = args.options[LIST_RECURSIVE_OPTION].isSet;
+	const size_t limit = scast<size_t>(args.options[LIST_LIMIT_OPTION].intValue);
+	const string_view filter = args.options[LIST_FILTER_OPTION].text;
+
+	OutputSink& out = OutputSink::Get();
+	const bool isPlain = OutputSink::IsPlain();
+	const string_view bullet = isPlain ? "" : "  - ";
+
+	if (!isPlain) out.Format("\nListing all paths at '{}':\n", Core::currentDir);
+
+	//entry paths always start with the walked folder and a separator
+	const size_t prefixLength = (path(Core::currentDir) / "").string().size();
+
+	size_t listedCount{};
+	bool reachedLimit{};
+
+	auto ListEntry = [&](
+		string_view relativePath,
+		bool isDirectory)
+		{
+			if (limit != 0
+				&& listedCount == limit)
+			{
+				reachedLimit = true;
+				return VisitResult::VISIT_STOP;
+			}
+
+			out.Append(bullet);
+			out.Append(relativePath);
+			if (isDirectory) out.Append('/');
+
+			out.Append('\n');
+			++listedCount;
+
+			return VisitResult::VISIT_CONTINUE;
+		};
+
+	//a watched directory is listed from its snapshot without touching the disk
+	const bool isWatched = DirectoryWatcher::VisitDirectory(
+		Core::currentDir,
+		[&](const WatchedEntry& entry)
+		{
+			if (!filter.empty()
+				&& !MatchesGlob(entry.name, filter))
+			{
+				return VisitResult::VISIT_CONTINUE;
+			}
+
+			return ListEntry(entry.relativePath, entry.isDirectory);
+		},
+		isRecursive);
+
+	//the sink writes in pieces so huge folders show up while they are still being walked
+	string result{};
+	if (!isWatched)
+	{
+		result = VisitDirectoryContents(
+			Core::currentDir,
+			[&](const directory_entry& entry)
+			{
+				if (!filter.empty()
+					&& !MatchesGlob(entry.path().filename().string(), filter))
+				{
+					return VisitResult::VISIT_CONTINUE;
+				}
 
-	string result = ListDirectoryContents(Core::currentDir, content);
+				//uses the type cached by the directory walk instead of another stat
+				error_code ec{};
+				return ListEntry(
+					string_view(entry.path().string()).substr(prefixLength),
+					entry.is_directory(ec));
+			},
+			isRecursive);
+	}
 
 	if (!result.empty())
 	{
+		out.Flush();
 		Log::Print(
 			"Failed to list current directory contents! Reason: " + result,
 			"COMMAND",
@@ -305,41 +1001,21 @@ void Command_List(const vector<string>& params)
 		return;
 	}
 
-	ostringstream oss{};
-
-	oss << "\nListing all paths at '" << Core::currentDir << "':\n";
-	if (content.empty()) oss << "  - (empty)";
-	else
-	{
-		for (size_t i = 0; i < content.size(); ++i)
-		{
-			oss << "  - ";
-
-			path rel = content[i].lexically_relative(Core::currentDir);
-			oss << rel.string();
-
-			if (is_directory(content[i])) oss << "/";
+	if (isPlain) return;
 
-			if (i + 1 < content.size()) oss << "\n";
-		}
-	}
-
-	Log::Print(oss.str());
+	if (listedCount == 0) out.Append("  - (empty)\n");
+	else if (reachedLimit) out.Format("  - ...stopped after {} entries\n", limit);
 }
 
-void Command_Go(const vector<string>& params)
+void Command_Go(const ParsedArgs& args)
 {
 	if (Core::currentDir.empty()) Core::currentDir = current_path().string();
-	path correctTarget = weakly_canonical(path(Core::currentDir) / params[1]);
+	path correctTarget = weakly_canonical(path(Core::currentDir) / args.params[0].text);
 
 	if (!exists(correctTarget))
 	{
-		ostringstream oss{};
-		oss << "Cannot go to target path '" << correctTarget
-			<< "' because it does not exist!";
-
 		Log::Print(
-			oss.str(),
+			"Cannot go to target path '" + correctTarget.string() + "' because it does not exist!",
 			"COMMAND",
 			LogType::LOG_ERROR,
 			2);
@@ -349,12 +1025,8 @@ void Command_Go(const vector<string>& params)
 
 	if (!is_directory(correctTarget))
 	{
-		ostringstream oss{};
-		oss << "Cannot go to target path '" << correctTarget
-			<< "' because it is not a directory!";
-
 		Log::Print(
-			oss.str(),
+			"Cannot go to target path '" + correctTarget.string() + "' because it is not a directory!",
 			"COMMAND",
 			LogType::LOG_ERROR,
 			2);
@@ -364,24 +1036,971 @@ void Command_Go(const vector<string>& params)
 
 	Core::currentDir = correctTarget.string();
 
-	Log::Print("\nMoved to new path: " + Core::currentDir);
+	OutputSink& out = OutputSink::Get();
+	if (OutputSink::IsPlain()) out.Format("{}\n", Core::currentDir);
+	else out.Format("\nMoved to new path: {}\n", Core::currentDir);
 }
 
-void Command_Clear(const vector<string>& params) { system("cls"); }
-
-void Command_Exit(const vector<string>& params)
+string FormatSize(uintmax_t bytes)
 {
-	if (params.size() == 1
-		&& (params[0] == "exit"
-			|| params[0] == "e"))
+	constexpr const char* units[] = { "B", "KB", "MB", "GB", "TB", "PB" };
+	double scaled = scast<double>(bytes);
+	size_t unit{};
+	while (scaled >= 1024.0
+		&& unit + 1 < size(units))
 	{
-		ostringstream out{};
-		out << "\n==========================================================================================\n";
-		Log::Print(out.str());
+		scaled /= 1024.0;
+		++unit;
+	}
 
-		Log::Print("Press 'Enter' to exit...");
-		cin.get();
+	char text[32]{};
+	snprintf(text, sizeof(text), "%.2f %s", scaled, units[unit]);
+
+	return text;
+}
+
+string FormatDuration(u64 ns)
+{
+	if (ns < 1000) return to_string(ns) + " ns";
+
+	constexpr const char* units[] = { "us", "ms", "s" };
+	double scaled = scast<double>(ns) / 1000.0;
+	size_t unit{};
+	while (scaled >= 1000.0
+		&& unit + 1 < size(units))
+	{
+		scaled /= 1000.0;
+		++unit;
 	}
 
+	char text[32]{};
+	snprintf(text, sizeof(text), "%.2f %s", scaled, units[unit]);
+
+	return text;
+}
+
+void Command_DiskUsage(span<const string_view> params)
+{
+	if (Core::currentDir.empty()) Core::currentDir = current_path().string();
+
+	bool useCache = true;
+	path target = Core::currentDir;
+
+	for (size_t i = 1; i < params.size(); ++i)
+	{
+		if (params[i] == DU_NO_CACHE_FLAG) useCache = false;
+		else target = weakly_canonical(path(Core::currentDir) / params[i]);
+	}
+
+	const auto startTime = steady_clock::now();
+
+	DirectorySize measured{};
+	string result = DiskUsage::GetDirectorySize(target, measured, useCache);
+
+	if (!result.empty())
+	{
+		Log::Print(
+			result,
+			"COMMAND",
+			LogType::LOG_ERROR,
+			2);
+
+		return;
+	}
+
+	const auto elapsed = duration_cast<milliseconds>(steady_clock::now() - startTime).count();
+
+	ostringstream oss{};
+
+	oss << "\nSize of '" << target.string() << "': " << FormatSize(measured.size)
+		<< " (" << measured.size << " bytes)\n"
+		<< "  - " << measured.fileCount << " files in " << measured.directoryCount << " folders\n"
+		<< "  - " << measured.cachedCount << " folders reused from cache, "
+		<< measured.skippedCount << " folders skipped because they couldn't be opened\n"
+		<< "  - elapsed " << elapsed << " ms";
+
+	Log::Print(oss.str());
+}
+
+void Command_Watch(const ParsedArgs& args)
+{
+	if (Core::currentDir.empty()) Core::currentDir = current_path().string();
+
+	OutputSink& out = OutputSink::Get();
+	const bool isPlain = OutputSink::IsPlain();
+
+	if (args.options[WATCH_STOP_OPTION].isSet)
+	{
+		const string root = DirectoryWatcher::GetRoot();
+		if (root.empty())
+		{
+			Log::Print(
+				"Cannot stop watching because no directory is watched!",
+				"COMMAND",
+				LogType::LOG_ERROR,
+				2);
+
+			return;
+		}
+
+		DirectoryWatcher::Stop();
+
+		if (!isPlain) out.Format("\nStopped watching '{}'\n", root);
+		return;
+	}
+
+	const path target = args.paramCount == 0
+		? path(Core::currentDir)
+		: weakly_canonical(path(Core::currentDir) / args.params[0].text);
+
+	const auto startTime = steady_clock::now();
+
+	//watching the same directory again only lists its totals
+	if (DirectoryWatcher::GetRoot() != target.string())
+	{
+		string result = DirectoryWatcher::Start(target);
+		if (!result.empty())
+		{
+			Log::Print(
+				result,
+				"COMMAND",
+				LogType::LOG_ERROR,
+				2);
+
+			return;
+		}
+	}
+
+	DirectorySize measured{};
+	DirectoryWatcher::GetDirectorySize(target, measured);
+
+	const auto elapsed = duration_cast<milliseconds>(steady_clock::now() - startTime).count();
+
+	if (isPlain)
+	{
+		out.Format("{}\n", DirectoryWatcher::GetRoot());
+		return;
+	}
+
+	out.Format("\nWatching '{}': {} files in {} folders, {}\n", DirectoryWatcher::GetRoot(),
+		measured.fileCount, measured.directoryCount, FormatSize(measured.size));
+	out.Format("  - {} folders skipped because they couldn't be opened\n", measured.skippedCount);
+	out.Format("  - elapsed {} ms\n", elapsed);
+}
+
+void Command_FindBytes(span<const string_view> params)
+{
+	if (Core::currentDir.empty()) Core::currentDir = current_path().string();
+
+	size_t separator{};
+	for (size_t i = 1; i < params.size(); ++i)
+	{
+		if (params[i] == FIND_BYTES_IN_FLAG)
+		{
+			separator = i;
+			break;
+		}
+	}
+
+	if (separator <= 1
+		|| separator + 1 == params.size())
+	{
+		Log::Print(
+			"Failed to find bytes because atleast one pattern must come before '" + string(FIND_BYTES_IN_FLAG) + "' and atleast one file after it!",
+			"COMMAND",
+			LogType::LOG_ERROR,
+			2);
+
+		return;
+	}
+
+	vector<vector<uint8_t>> patterns{};
+	for (size_t i = 1; i < separator; ++i)
+	{
+		string_view pattern = params[i];
+		vector<uint8_t>& bytes = patterns.emplace_back();
+
+		if (!pattern.starts_with(FIND_BYTES_HEX_PREFIX))
+		{
+			bytes.assign(pattern.begin(), pattern.end());
+			continue;
+		}
+
+		pattern.remove_prefix(FIND_BYTES_HEX_PREFIX.size());
+
+		bool isValid = !pattern.empty() && pattern.size() % 2 == 0;
+		for (size_t j = 0; isValid && j < pattern.size(); j += 2)
+		{
+			uint8_t value{};
+			auto [ptr, ec] = from_chars(pattern.data() + j, pattern.data() + j + 2, value, 16);
+
+			isValid = ec == errc{} && ptr == pattern.data() + j + 2;
+			bytes.push_back(value);
+		}
+
+		if (!isValid)
+		{
+			Log::Print(
+				"Failed to find bytes because '" + string(params[i]) + "' is not a valid hex pattern!",
+				"COMMAND",
+				LogType::LOG_ERROR,
+				2);
+
+			return;
+		}
+	}
+
+	struct FileSearch
+	{
+		path target{};
+		string result{};
+		vector<PatternRange> matches{};
+	};
+
+	vector<FileSearch> searches{};
+	for (size_t i = separator + 1; i < params.size(); ++i)
+	{
+		searches.push_back({ weakly_canonical(path(Core::currentDir) / params[i]) });
+	}
+
+	const auto startTime = steady_clock::now();
+
+	//one pool task per file, each file is still read only once for all patterns
+	ThreadPool& pool = ThreadPool::GetShared();
+	vector<future<void>> tasks{};
+	tasks.reserve(searches.size());
+
+	for (auto& search : searches)
+	{
+		tasks.push_back(pool.Submit([&search, &patterns]()
+			{
+				search.result = GetRangesByValues(
+					search.target,
+					patterns,
+					search.matches);
+			}));
+	}
+
+	for (auto& t : tasks) pool.Await(t);
+
+	const auto elapsed = duration_cast<milliseconds>(steady_clock::now() - startTime).count();
+
+	size_t totalMatches{};
+	for (const auto& search : searches)
+	{
+		if (!search.result.empty())
+		{
+			Log::Print(
+				search.result,
+				"COMMAND",
+				LogType::LOG_ERROR,
+				2);
+
+			continue;
+		}
+
+		totalMatches += search.matches.size();
+
+		//one print per file keeps every print below the log message length limit
+		ostringstream oss{};
+
+		oss << "\n" << search.target.string() << ": " << search.matches.size() << " matches";
+
+		const size_t listed = search.matches.size() < MAX_LISTED_MATCHES
+			? search.matches.size()
+			: MAX_LISTED_MATCHES;
+
+		for (size_t i = 0; i < listed; ++i)
+		{
+			const PatternRange& m = search.matches[i];
+			oss << "\n  - offset " << m.range.start << ": " << params[1 + m.patternIndex];
+		}
+		if (search.matches.size() > listed)
+		{
+			oss << "\n  - ...and " << (search.matches.size() - listed) << " more";
+		}
+
+		Log::Print(oss.str());
+	}
+
+	ostringstream summary{};
+	summary << "\nFound " << totalMatches << " matches for " << patterns.size()
+		<< " patterns in " << searches.size() << " files, elapsed " << elapsed << " ms";
+
+	Log::Print(summary.str());
+}
+
+void PrintCopyStats(
+	string_view action,
+	const path& origin,
+	const path& target,
+	const CopyStats& stats,
+	const string& result)
+{
+	const size_t listed = stats.failures.size() < MAX_LISTED_FAILURES
+		? stats.failures.size()
+		: MAX_LISTED_FAILURES;
+
+	for (size_t i = 0; i < listed; ++i)
+	{
+		Log::Print(
+			stats.failures[i],
+			"COMMAND",
+			LogType::LOG_ERROR,
+			2);
+	}
+
+	if (!result.empty())
+	{
+		//failed before anything was copied, there are no totals to show
+		if (stats.fileCount == 0
+			&& stats.failures.empty())
+		{
+			Log::Print(
+				result,
+				"COMMAND",
+				LogType::LOG_ERROR,
+				2);
+
+			return;
+		}
+
+		ostringstream oss{};
+		oss << result;
+		if (stats.failures.size() > listed)
+		{
+			oss << " " << (stats.failures.size() - listed) << " more failures were not listed.";
+		}
+
+		Log::Print(
+			oss.str(),
+			"COMMAND",
+			LogType::LOG_ERROR,
+			2);
+	}
+
+	ostringstream oss{};
+
+	oss << "\n" << action << " '" << origin.string() << "' to '" << target.string() << "'";
+
+	if (stats.wasRenamed)
+	{
+		oss << " with a rename, elapsed " << stats.elapsedMS << " ms";
+		Log::Print(oss.str());
+
+		return;
+	}
+
+	//avoid dividing by zero for copies that finish within a millisecond
+	const double seconds = scast<double>(stats.elapsedMS > 0 ? stats.elapsedMS : 1) / 1000.0;
+
+	oss << "\n  - " << stats.copiedCount << " of " << stats.fileCount << " files copied, "
+		<< FormatSize(stats.copiedSize) << " (" << stats.copiedSize << " bytes)\n"
+		<< "  - " << stats.skippedCount << " files skipped, "
+		<< stats.failures.size() << " failed\n"
+		<< "  - " << stats.directoryCount << " folders, " << stats.linkCount << " links\n"
+		<< "  - elapsed " << stats.elapsedMS << " ms, "
+		<< FormatSize(scast<uintmax_t>(scast<double>(stats.copiedSize) / seconds)) << "/s";
+
+	Log::Print(oss.str());
+}
+
+//Progress reporter shared by copy and move, prints how far the copy is and its current throughput
+static function<void(const CopyProgress&)> MakeCopyProgress()
+{
+	const auto startTime = steady_clock::now();
+
+	return [startTime](const CopyProgress& progress)
+		{
+			const auto elapsed = duration_cast<milliseconds>(steady_clock::now() - startTime).count();
+			const double seconds = scast<double>(elapsed > 0 ? elapsed : 1) / 1000.0;
+
+			ostringstream oss{};
+			oss << "  - " << progress.doneFileCount << " of " << progress.totalFileCount << " files, "
+				<< FormatSize(progress.doneSize) << " of " << FormatSize(progress.totalSize) << ", "
+				<< FormatSize(scast<uintmax_t>(scast<double>(progress.doneSize) / seconds)) << "/s";
+
+			Log::Print(oss.str());
+		};
+}
+
+void Command_Copy(span<const string_view> params)
+{
+	if (Core::currentDir.empty()) Core::currentDir = current_path().string();
+
+	CopyOptions options{};
+	vector<path> targets{};
+
+	for (size_t i = 1; i < params.size(); ++i)
+	{
+		if (params[i] == COPY_OVERWRITE_FLAG) options.overwrite = true;
+		else if (params[i] == COPY_INCREMENTAL_FLAG) options.incremental = true;
+		else targets.push_back(weakly_canonical(path(Core::currentDir) / params[i]));
+	}
+
+	if (targets.size() != 2)
+	{
+		Log::Print(
+			"Failed to copy because exactly one origin and one target must be passed!",
+			"COMMAND",
+			LogType::LOG_ERROR,
+			2);
+
+		return;
+	}
+
+	options.onProgress = MakeCopyProgress();
+
+	CopyStats stats{};
+	string result = CopyEngine::CopyPath(
+		targets[0],
+		targets[1],
+		options,
+		stats);
+
+	PrintCopyStats(
+		"Copied",
+		targets[0],
+		targets[1],
+		stats,
+		result);
+}
+
+void Command_Move(span<const string_view> params)
+{
+	if (Core::currentDir.empty()) Core::currentDir = current_path().string();
+
+	CopyOptions options{};
+	vector<path> targets{};
+
+	for (size_t i = 1; i < params.size(); ++i)
+	{
+		if (params[i] == COPY_OVERWRITE_FLAG) options.overwrite = true;
+		else targets.push_back(weakly_canonical(path(Core::currentDir) / params[i]));
+	}
+
+	if (targets.size() != 2)
+	{
+		Log::Print(
+			"Failed to move because exactly one origin and one target must be passed!",
+			"COMMAND",
+			LogType::LOG_ERROR,
+			2);
+
+		return;
+	}
+
+	options.onProgress = MakeCopyProgress();
+
+	CopyStats stats{};
+	string result = CopyEngine::MovePath(
+		targets[0],
+		targets[1],
+		options,
+		stats);
+
+	PrintCopyStats(
+		"Moved",
+		targets[0],
+		targets[1],
+		stats,
+		result);
+}
+
+void AppendJSONString(
+	ostringstream& oss,
+	string_view text)
+{
+	oss << '"';
+	for (char c : text)
+	{
+		switch (c)
+		{
+		case '"':  oss << "\\\""; break;
+		case '\\': oss << "\\\\"; break;
+		case '\n': oss << "\\n"; break;
+		case '\r': oss << "\\r"; break;
+		case '\t': oss << "\\t"; break;
+		default:
+			if (scast<unsigned char>(c) < 0x20)
+			{
+				char escaped[8]{};
+				snprintf(escaped, sizeof(escaped), "\\u%04x", scast<unsigned int>(c));
+				oss << escaped;
+			}
+			else oss << c;
+			break;
+		}
+	}
+	oss << '"';
+}
+
+void Command_Inspect(span<const string_view> params)
+{
+	if (Core::currentDir.empty()) Core::currentDir = current_path().string();
+
+	bool asJSON{};
+	bool listTables{};
+	path target = Core::currentDir;
+
+	for (size_t i = 1; i < params.size(); ++i)
+	{
+		if (params[i] == INSPECT_JSON_FLAG) asJSON = true;
+		else if (params[i] == INSPECT_TABLES_FLAG) listTables = true;
+		else target = weakly_canonical(path(Core::currentDir) / params[i]);
+	}
+
+	//a single file always keeps its tables, folders only keep them when asked to
+	error_code ec{};
+	const bool keepTables = listTables || !is_directory(target, ec);
+
+	vector<AssetSummary> files{};
+	InspectStats stats{};
+	string result = AssetInspector::InspectPath(
+		target,
+		keepTables,
+		files,
+		stats);
+
+	if (!result.empty())
+	{
+		Log::Print(
+			result,
+			"COMMAND",
+			LogType::LOG_ERROR,
+			2);
+
+		return;
+	}
+
+	const size_t tableLimit = listTables
+		? SIZE_MAX
+		: MAX_LISTED_TABLES;
+
+	//one print per file keeps text prints below the log message length limit,
+	//JSON lines go out raw so a long table list is never trimmed
+	for (const auto& file : files)
+	{
+		const bool isFont = file.type == AssetType::ASSET_KFD;
+
+		ostringstream oss{};
+
+		if (asJSON)
+		{
+			oss << "{\"path\":";
+			AppendJSONString(oss, file.target.string());
+			oss << ",\"type\":\"" << (isFont ? "kfd" : "kmd") << "\""
+				<< ",\"fileSize\":" << file.fileSize;
+
+			if (!file.error.empty())
+			{
+				oss << ",\"error\":";
+				AppendJSONString(oss, file.error);
+				oss << "}\n";
+
+				Log::PrintRaw(oss.str());
+				continue;
+			}
+
+			oss << ",\"version\":" << scast<u32>(file.version)
+				<< ",\"count\":" << file.count
+				<< ",\"tableSize\":" << file.tableSize
+				<< ",\"blockSize\":" << file.blockSize
+				<< ",\"tableCount\":" << file.tableCount
+				<< ",\"outOfRange\":" << file.outOfRangeCount;
+
+			if (isFont)
+			{
+				oss << ",\"fontType\":" << scast<u32>(file.fontType)
+					<< ",\"glyphHeight\":" << file.glyphHeight;
+			}
+			else oss << ",\"scaleFactor\":" << scast<u32>(file.scaleFactor);
+
+			if (keepTables)
+			{
+				oss << ",\"tables\":[";
+				for (size_t i = 0; i < file.tables.size(); ++i)
+				{
+					const AssetTable& t = file.tables[i];
+
+					if (i > 0) oss << ',';
+					oss << '{';
+					if (isFont) oss << "\"charCode\":" << t.charCode;
+					else
+					{
+						oss << "\"nodeName\":";
+						AppendJSONString(oss, t.nodeName);
+					}
+					oss << ",\"blockOffset\":" << t.blockOffset
+						<< ",\"blockSize\":" << t.blockSize << '}';
+				}
+				oss << ']';
+			}
+
+			oss << "}\n";
+
+			Log::PrintRaw(oss.str());
+			continue;
+		}
+
+		if (!file.error.empty())
+		{
+			Log::Print(
+				file.error,
+				"COMMAND",
+				LogType::LOG_ERROR,
+				2);
+
+			continue;
+		}
+
+		oss << "\n" << file.target.string() << ": " << (isFont ? "kfd" : "kmd")
+			<< " version " << scast<u32>(file.version) << ", " << FormatSize(file.fileSize) << "\n";
+
+		if (isFont)
+		{
+			oss << "  - " << file.count << " glyphs, "
+				<< (file.fontType == 2 ? "bitmap" : "per-glyph")
+				<< ", glyph height " << file.glyphHeight << "\n";
+		}
+		else
+		{
+			oss << "  - " << file.count << " models, scale factor " << scast<u32>(file.scaleFactor) << "\n";
+		}
+
+		oss << "  - " << file.tableCount << " tables in " << file.tableSize << " bytes, "
+			<< file.blockSize << " bytes of blocks, "
+			<< file.outOfRangeCount << " tables past the end of the file";
+
+		Log::Print(oss.str());
+
+		if (!keepTables) continue;
+
+		//tables go in their own prints, a full table list can be longer than a single print allows
+		const size_t listed = file.tables.size() < tableLimit
+			? file.tables.size()
+			: tableLimit;
+
+		for (size_t i = 0; i < listed; ++i)
+		{
+			const AssetTable& t = file.tables[i];
+
+			ostringstream line{};
+			if (isFont) line << "    - char " << t.charCode;
+			else line << "    - node '" << t.nodeName << "'";
+			line << ": offset " << t.blockOffset << ", size " << t.blockSize;
+
+			Log::Print(line.str());
+		}
+		if (file.tables.size() > listed)
+		{
+			Log::Print("    - ...and " + to_string(file.tables.size() - listed) + " more");
+		}
+	}
+
+	const double seconds = scast<double>(stats.elapsedMS > 0 ? stats.elapsedMS : 1) / 1000.0;
+
+	ostringstream summary{};
+
+	if (asJSON)
+	{
+		summary << "{\"summary\":{\"path\":";
+		AppendJSONString(summary, target.string());
+		summary << ",\"fileCount\":" << stats.fileCount
+			<< ",\"kfdCount\":" << stats.kfdCount
+			<< ",\"kmdCount\":" << stats.kmdCount
+			<< ",\"failedCount\":" << stats.failedCount
+			<< ",\"glyphCount\":" << stats.glyphCount
+			<< ",\"modelCount\":" << stats.modelCount
+			<< ",\"outOfRange\":" << stats.outOfRangeCount
+			<< ",\"totalSize\":" << stats.totalSize
+			<< ",\"tableSize\":" << stats.tableSize
+			<< ",\"blockSize\":" << stats.blockSize
+			<< ",\"elapsedMS\":" << stats.elapsedMS << "}}\n";
+
+		Log::PrintRaw(summary.str());
+		return;
+	}
+
+	summary << "\nInspected " << stats.fileCount << " files in '" << target.string() << "', "
+		<< FormatSize(stats.totalSize) << " (" << stats.totalSize << " bytes)\n"
+		<< "  - " << stats.kfdCount << " kfd files with " << stats.glyphCount << " glyphs, "
+		<< stats.kmdCount << " kmd files with " << stats.modelCount << " models\n"
+		<< "  - " << FormatSize(stats.tableSize) << " of tables, " << FormatSize(stats.blockSize) << " of blocks\n"
+		<< "  - " << stats.failedCount << " invalid files, " << stats.outOfRangeCount << " tables past the end of their file\n"
+		<< "  - elapsed " << stats.elapsedMS << " ms, "
+		<< scast<u64>(scast<double>(stats.fileCount) / seconds) << " files/s";
+
+	Log::Print(summary.str());
+}
+
+string StatsToJSON(const StatsSnapshot& snapshot)
+{
+	ostringstream oss{};
+
+	oss << "{\"dispatchCount\":" << snapshot.dispatchCount
+		<< ",\"unknownCount\":" << snapshot.unknownCount
+		<< ",\"parseNS\":" << snapshot.parseNS
+		<< ",\"lookupNS\":" << snapshot.lookupNS
+		<< ",\"executeNS\":" << snapshot.executeNS
+		<< ",\"commands\":[";
+
+	for (size_t i = 0; i < snapshot.commands.size(); ++i)
+	{
+		const CommandTimings& c = snapshot.commands[i];
+
+		if (i > 0) oss << ',';
+		oss << "{\"name\":";
+		AppendJSONString(oss, c.name);
+		oss << ",\"invocationCount\":" << c.invocationCount
+			<< ",\"failureCount\":" << c.failureCount
+			<< ",\"totalNS\":" << c.totalNS
+			<< ",\"p50NS\":" << c.p50NS
+			<< ",\"p99NS\":" << c.p99NS
+			<< ",\"maxNS\":" << c.maxNS
+			<< '}';
+	}
+
+	oss << "]}";
+
+	return oss.str();
+}
+
+void Command_Stats(span<const string_view> params)
+{
+	bool printJSON{};
+	if (params.size() == 2)
+	{
+		if (params[1] != STATS_JSON_FLAG)
+		{
+			Log::Print(
+				"Cannot list stats because '" + string(params[1]) + "' is not a valid option!",
+				"COMMAND",
+				LogType::LOG_ERROR,
+				2);
+
+			return;
+		}
+
+		printJSON = true;
+	}
+
+	StatsSnapshot snapshot = CommandStats::GetSnapshot();
+
+	if (printJSON)
+	{
+		Log::PrintRaw(StatsToJSON(snapshot) + "\n");
+		return;
+	}
+
+	//slowest commands first, the snapshot keeps registration order for the JSON
+	sort(snapshot.commands.begin(), snapshot.commands.end(),
+		[](const CommandTimings& a, const CommandTimings& b)
+		{
+			return a.totalNS > b.totalNS;
+		});
+
+	ostringstream oss{};
+
+	oss << "\nDispatched " << snapshot.dispatchCount << " commands, "
+		<< snapshot.unknownCount << " of them unknown\n"
+		<< "  parse: " << FormatDuration(snapshot.parseNS)
+		<< " | lookup: " << FormatDuration(snapshot.lookupNS)
+		<< " | execute: " << FormatDuration(snapshot.executeNS);
+
+	Log::Print(oss.str());
+
+	if (snapshot.commands.empty())
+	{
+		Log::Print("  - (empty)");
+		return;
+	}
+
+	for (const auto& c : snapshot.commands)
+	{
+		ostringstream line{};
+
+		line << "  - " << c.name
+			<< ": " << c.invocationCount << " calls, " << c.failureCount << " failed"
+			<< " | total " << FormatDuration(c.totalNS)
+			<< " | p50 " << FormatDuration(c.p50NS)
+			<< " | p99 " << FormatDuration(c.p99NS)
+			<< " | max " << FormatDuration(c.maxNS);
+
+		Log::Print(line.str());
+	}
+}
+
+void Command_LogDump(const ParsedArgs& args)
+{
+	if (Core::currentDir.empty()) Core::currentDir = current_path().string();
+	const path origin = path(Core::currentDir) / args.params[0].text;
+
+	BinaryLogFilter filter{};
+	if (args.options[LOGDUMP_TYPE_OPTION].isSet)
+	{
+		filter.typeMask = scast<u8>(1u << args.options[LOGDUMP_TYPE_OPTION].intValue);
+	}
+	filter.tag = args.options[LOGDUMP_TAG_OPTION].text;
+
+	//same labels as the console prefix, info has none
+	static constexpr string_view typeNames[] =
+	{
+		"INFO",
+		"DEBUG",
+		"SUCCESS",
+		"WARNING",
+		"ERROR"
+	};
+
+	OutputSink& out = OutputSink::Get();
+	const bool isPlain = OutputSink::IsPlain();
+
+	//records arrive many per second, so the date and time are only rebuilt when the second changes
+	u64 cachedSecond = UINT64_MAX;
+	char stamp[32]{};
+
+	size_t recordCount{};
+
+	string result = BinaryLog::Read(
+		origin,
+		filter,
+		[&](const BinaryLogRecord& record)
+		{
+			++recordCount;
+
+			const size_t typeIndex = scast<size_t>(record.type);
+			const string_view typeName = typeIndex < size(typeNames) ? typeNames[typeIndex] : "UNKNOWN";
+
+			if (isPlain)
+			{
+				out.Format("{}\t{}\t{}\t{}\n", record.timestampUS, typeName, record.tag, record.message);
+				return;
+			}
+
+			const u64 second = record.timestampUS / 1000000;
+			if (second != cachedSecond)
+			{
+				const time_t seconds = scast<time_t>(second);
+				tm parts{};
+#ifdef _WIN32
+				localtime_s(&parts, &seconds);
+#else
+				localtime_r(&seconds, &parts);
+#endif
+				strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &parts);
+
+				cachedSecond = second;
+			}
+
+			const u64 ms = (record.timestampUS / 1000) % 1000;
+
+			out.Format("[ {}.", string_view(stamp));
+			if (ms < 100) out.Append('0');
+			if (ms < 10) out.Append('0');
+			out.Append(ms);
+
+			if (record.type == LogType::LOG_INFO) out.Format(" ] [ {} ] {}\n", record.tag, record.message);
+			else out.Format(" ] [ {} | {} ] {}\n", typeName, record.tag, record.message);
+		});
+
+	if (!result.empty())
+	{
+		out.Flush();
+
+		Log::Print(
+			"Failed to read binary log! Reason: " + result,
+			"COMMAND",
+			LogType::LOG_ERROR,
+			2);
+
+		return;
+	}
+
+	if (!isPlain) out.Format("\nListed {} records from '{}'\n", recordCount, origin.string());
+}
+
+void Command_Jobs(span<const string_view>)
+{
+	vector<ProcessJob> jobs = ProcessLauncher::GetJobs();
+
+	ostringstream oss{};
+
+	oss << "\nListing all jobs:\n";
+	if (jobs.empty()) oss << "  - (empty)";
+	else
+	{
+		for (size_t i = 0; i < jobs.size(); ++i)
+		{
+			const ProcessJob& j = jobs[i];
+
+			oss << "  - " << j.id << ": " << j.commandLine << " | ";
+			if (j.finished) oss << "exited with code " << j.exitCode;
+			else oss << "running";
+
+			if (i + 1 < jobs.size()) oss << "\n";
+		}
+	}
+
+	Log::Print(oss.str());
+}
+
+void Command_Wait(const ParsedArgs& args)
+{
+	const u32 jobID = scast<u32>(args.params[0].intValue);
+
+	int exitCode{};
+	string result = ProcessLauncher::WaitJob(jobID, exitCode);
+
+	if (!result.empty())
+	{
+		Log::Print(
+			result,
+			"COMMAND",
+			LogType::LOG_ERROR,
+			2);
+
+		return;
+	}
+
+	Log::Print("\nJob " + to_string(jobID) + " exited with code " + to_string(exitCode));
+}
+
+void Command_Clear(span<const string_view>)
+{
+#ifdef _WIN32
+	system("cls");
+#else
+	system("clear");
+#endif
+}
+
+void Command_Exit(span<const string_view> params)
+{
+	//served commands only stop the server, the client decides when it exits
+	if (CommandServer::IsServing())
+	{
+		CommandServer::RequestStop();
+		return;
+	}
+
+	if (params.size() == 1
+		&& (params[0] == "exit"
+			|| params[0] == "e"))
+	{
+		ostringstream out{};
+		out << "\n==========================================================================================\n";
+		Log::Print(out.str());
+
+		Log::Print("Press 'Enter' to exit...");
+		Log::Flush();
+		cin.get();
+	}
+
+	//quick_exit skips stdio cleanup, so queued and buffered output must be pushed out first
+	Log::Flush();
+	BinaryLog::Close();
+	PrintProfile();
+
 	quick_exit(0);
 }
\ No newline at end of file
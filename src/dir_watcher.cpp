@@ -0,0 +1,878 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <system_error>
+#include <cstring>
+#include <cerrno>
+#include <utility>
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <unistd.h>
+	#include <sys/inotify.h>
+#endif
+
+#include "KalaHeaders/log_utils.hpp"
+
+#include "dir_watcher.hpp"
+
+using KalaHeaders::KalaLog::Log;
+using KalaHeaders::KalaLog::LogType;
+using KalaHeaders::KalaFile::VisitResult;
+
+using KalaCLI::DirectoryWatcher;
+using KalaCLI::DirectorySize;
+using KalaCLI::WatchedEntry;
+using KalaCLI::WATCH_EVENT_BUFFER_SIZE;
+
+using std::string;
+using std::string_view;
+using std::to_string;
+using std::vector;
+using std::unordered_map;
+using std::move;
+using std::function;
+using std::mutex;
+using std::lock_guard;
+using std::error_code;
+using std::filesystem::path;
+using std::filesystem::directory_iterator;
+using std::filesystem::directory_entry;
+using std::filesystem::directory_options;
+using std::filesystem::file_status;
+using std::filesystem::file_type;
+using std::filesystem::symlink_status;
+using std::filesystem::weakly_canonical;
+using std::filesystem::is_directory;
+using std::filesystem::is_regular_file;
+using std::filesystem::is_symlink;
+using std::filesystem::file_size;
+
+//Everything below a folder, not counting the folder itself
+struct TreeTotals
+{
+	uintmax_t size{};
+	u64 fileCount{};
+	u64 directoryCount{};
+	u64 skippedCount{};
+
+	TreeTotals& operator+=(const TreeTotals& other)
+	{
+		size += other.size;
+		fileCount += other.fileCount;
+		directoryCount += other.directoryCount;
+		skippedCount += other.skippedCount;
+		return *this;
+	}
+	TreeTotals& operator-=(const TreeTotals& other)
+	{
+		size -= other.size;
+		fileCount -= other.fileCount;
+		directoryCount -= other.directoryCount;
+		skippedCount -= other.skippedCount;
+		return *this;
+	}
+};
+
+//One entry of a snapshot folder
+struct SnapshotEntry
+{
+	uintmax_t size{};   //only set for counted files
+	bool isDirectory{}; //true for folders and links to folders
+	bool isWalked{};    //real folder with its own snapshot folder, links are never followed
+	bool isCounted{};   //regular file that counts towards the totals
+};
+
+struct SnapshotDirectory
+{
+	string parent{}; //key of the parent folder, empty for the watched folder
+	unordered_map<string, SnapshotEntry> entries{};
+	TreeTotals totals{};
+	bool isSkipped{}; //couldn't be opened, so it has no entries
+#ifndef _WIN32
+	int descriptor = -1;
+#endif
+};
+
+//A folder entry that the system reported as changed
+struct PendingChange
+{
+	string directory{};
+	string name{};
+	bool isReplaced{}; //created or renamed into place, so a folder of the same name is scanned again
+};
+
+//Everything is only touched under stateMutex
+struct WatcherState
+{
+	mutex stateMutex{};
+	string root{};
+
+	//keyed by the full path of every folder in the watched tree
+	unordered_map<string, SnapshotDirectory> directories{};
+
+#ifdef _WIN32
+	HANDLE handle = INVALID_HANDLE_VALUE;
+	OVERLAPPED overlapped{};
+	bool isReadPending{};
+	vector<DWORD> buffer{}; //change events must be DWORD aligned
+#else
+	int fd = -1;
+	unordered_map<int, string> descriptors{};
+	vector<u8> buffer{};
+#endif
+};
+
+static WatcherState watcher{};
+
+#ifdef _WIN32
+//Returns the message of the last Win32 error
+static string GetLastErrorString()
+{
+	DWORD err = GetLastError();
+
+	char* buffer{};
+	DWORD length = FormatMessageA(
+		FORMAT_MESSAGE_ALLOCATE_BUFFER
+		| FORMAT_MESSAGE_FROM_SYSTEM
+		| FORMAT_MESSAGE_IGNORE_INSERTS,
+		nullptr,
+		err,
+		0,
+		rcast<LPSTR>(&buffer),
+		0,
+		nullptr);
+
+	string result = "(error " + to_string(err) + ")";
+	if (length > 0)
+	{
+		result += ": ";
+		result.append(buffer, length);
+		LocalFree(buffer);
+	}
+	return result;
+}
+
+//Queues the next read of change events, the system keeps collecting changes until it completes
+static bool IssueRead(WatcherState& state)
+{
+	state.isReadPending = ReadDirectoryChangesW(
+		state.handle,
+		state.buffer.data(),
+		scast<DWORD>(state.buffer.size() * sizeof(DWORD)),
+		TRUE,
+		FILE_NOTIFY_CHANGE_FILE_NAME
+		| FILE_NOTIFY_CHANGE_DIR_NAME
+		| FILE_NOTIFY_CHANGE_SIZE
+		| FILE_NOTIFY_CHANGE_LAST_WRITE,
+		nullptr,
+		&state.overlapped,
+		nullptr) != 0;
+
+	return state.isReadPending;
+}
+#else
+//Folders are watched one by one, links are never followed so that the watched tree matches the snapshot
+constexpr u32 WATCH_MASK =
+	IN_CREATE
+	| IN_DELETE
+	| IN_MODIFY
+	| IN_MOVED_FROM
+	| IN_MOVED_TO
+	| IN_DELETE_SELF
+	| IN_MOVE_SELF
+	| IN_ONLYDIR
+	| IN_DONT_FOLLOW
+	| IN_EXCL_UNLINK;
+#endif
+
+//Folder keys never end with a separator, so that 'a/' and 'a' find the same folder
+static string ToKey(const path& target)
+{
+	error_code ec{};
+	path canonical = weakly_canonical(target, ec);
+	if (ec) canonical = target;
+
+	if (!canonical.has_filename()
+		&& canonical.has_relative_path())
+	{
+		canonical = canonical.parent_path();
+	}
+
+	return canonical.string();
+}
+
+//What a walked folder adds to the totals of its parent
+static TreeTotals GetSubtreeTotals(const SnapshotDirectory& directory)
+{
+	TreeTotals result = directory.totals;
+	if (directory.isSkipped) ++result.skippedCount;
+	else ++result.directoryCount;
+
+	return result;
+}
+
+//Applies a change below key to key and every folder above it
+static void ApplyDelta(
+	WatcherState& state,
+	const string& key,
+	const TreeTotals& added,
+	const TreeTotals& removed)
+{
+	const string* current = &key;
+	while (!current->empty())
+	{
+		auto it = state.directories.find(*current);
+		if (it == state.directories.end()) return;
+
+		it->second.totals += added;
+		it->second.totals -= removed;
+
+		current = &it->second.parent;
+	}
+}
+
+//Forgets a folder and everything below it
+static void RemoveDirectory(
+	WatcherState& state,
+	const string& key)
+{
+	auto it = state.directories.find(key);
+	if (it == state.directories.end()) return;
+
+	for (const auto& [name, entry] : it->second.entries)
+	{
+		if (entry.isWalked) RemoveDirectory(state, (path(key) / name).string());
+	}
+
+#ifndef _WIN32
+	//a folder renamed to another key of the tree keeps its watch, so it is only removed while it still belongs to key
+	auto descriptorIt = state.descriptors.find(it->second.descriptor);
+	if (descriptorIt != state.descriptors.end()
+		&& descriptorIt->second == key)
+	{
+		inotify_rm_watch(state.fd, it->second.descriptor);
+		state.descriptors.erase(descriptorIt);
+	}
+#endif
+
+	state.directories.erase(it);
+}
+
+//Reads one folder and every folder below it into the snapshot, its totals are filled from the bottom up.
+//A folder that can't be opened is kept as skipped, returns false only if the system can't watch any more folders
+static bool ScanDirectory(
+	WatcherState& state,
+	const string& key,
+	const string& parent,
+	string& outError)
+{
+	SnapshotDirectory& directory = state.directories[key];
+	directory = SnapshotDirectory{};
+	directory.parent = parent;
+
+#ifndef _WIN32
+	//watched before reading so that nothing created during the scan is missed
+	const int descriptor = inotify_add_watch(state.fd, key.c_str(), WATCH_MASK);
+	if (descriptor == -1)
+	{
+		if (errno == ENOSPC)
+		{
+			outError = "Failed to watch '" + key + "' because the system limit of watched folders was reached! Raise 'fs.inotify.max_user_watches' to watch larger trees.";
+			return false;
+		}
+
+		directory.isSkipped = true;
+		return true;
+	}
+
+	//watching a folder that is already watched under its old name returns the same descriptor,
+	//which then belongs to key and must not be removed with the old name
+	auto descriptorIt = state.descriptors.find(descriptor);
+	if (descriptorIt != state.descriptors.end()
+		&& descriptorIt->second != key)
+	{
+		auto previousIt = state.directories.find(descriptorIt->second);
+		if (previousIt != state.directories.end()) previousIt->second.descriptor = -1;
+	}
+
+	directory.descriptor = descriptor;
+	state.descriptors[descriptor] = key;
+#endif
+
+	error_code ec{};
+	directory_iterator it(key, directory_options::skip_permission_denied, ec);
+	if (ec)
+	{
+		directory.isSkipped = true;
+		return true;
+	}
+
+	vector<string> subdirectories{};
+
+	for (const directory_iterator end{}; it != end; it.increment(ec))
+	{
+		if (ec) break;
+
+		const directory_entry& entry = *it;
+
+		//types and, where the platform provides them, sizes come from the cached entry data
+		error_code entryEC{};
+		const bool isLink = entry.is_symlink(entryEC);
+
+		SnapshotEntry added{};
+		added.isDirectory = entry.is_directory(entryEC);
+		added.isWalked = added.isDirectory && !isLink;
+
+		if (!isLink
+			&& entry.is_regular_file(entryEC))
+		{
+			added.size = entry.file_size(entryEC);
+			added.isCounted = !entryEC;
+			if (entryEC) added.size = 0;
+		}
+
+		string name = entry.path().filename().string();
+		if (added.isWalked) subdirectories.push_back(name);
+
+		directory.entries.emplace(move(name), added);
+	}
+
+	TreeTotals totals{};
+	for (const auto& [name, entry] : directory.entries)
+	{
+		if (!entry.isCounted) continue;
+
+		totals.size += entry.size;
+		++totals.fileCount;
+	}
+
+	for (const auto& name : subdirectories)
+	{
+		const string childKey = (path(key) / name).string();
+		if (!ScanDirectory(state, childKey, key, outError)) return false;
+
+		totals += GetSubtreeTotals(state.directories[childKey]);
+	}
+
+	//the map may have grown, but its elements never move
+	directory.totals = totals;
+
+	return true;
+}
+
+//Compares one reported entry to what is on disk now and updates the snapshot and the totals above it
+static bool RefreshEntry(
+	WatcherState& state,
+	const PendingChange& change,
+	string& outError)
+{
+	auto dirIt = state.directories.find(change.directory);
+
+	//below a folder that was removed or replaced earlier in the same batch
+	if (dirIt == state.directories.end()) return true;
+
+	SnapshotDirectory& directory = dirIt->second;
+
+	const path child = path(change.directory) / change.name;
+	const string childKey = child.string();
+
+	error_code ec{};
+	const file_status linkStatus = symlink_status(child, ec);
+	const bool isExisting = !ec
+		&& linkStatus.type() != file_type::not_found;
+
+	SnapshotEntry next{};
+	if (isExisting)
+	{
+		const bool isLink = is_symlink(linkStatus);
+
+		error_code typeEC{};
+		next.isDirectory = isLink
+			? is_directory(child, typeEC)
+			: is_directory(linkStatus);
+		next.isWalked = !isLink && is_directory(linkStatus);
+
+		if (is_regular_file(linkStatus))
+		{
+			error_code sizeEC{};
+			next.size = file_size(child, sizeEC);
+			next.isCounted = !sizeEC;
+			if (sizeEC) next.size = 0;
+		}
+	}
+
+	TreeTotals added{};
+	TreeTotals removed{};
+
+	auto entryIt = directory.entries.find(change.name);
+	if (entryIt != directory.entries.end())
+	{
+		const SnapshotEntry previous = entryIt->second;
+
+		//a folder that stays reports its own changes through its own events
+		if (isExisting
+			&& previous.isWalked
+			&& next.isWalked
+			&& !change.isReplaced)
+		{
+			return true;
+		}
+
+		if (previous.isWalked)
+		{
+			auto childIt = state.directories.find(childKey);
+			if (childIt != state.directories.end()) removed = GetSubtreeTotals(childIt->second);
+
+			RemoveDirectory(state, childKey);
+		}
+		else if (previous.isCounted)
+		{
+			removed.size = previous.size;
+			removed.fileCount = 1;
+		}
+
+		directory.entries.erase(entryIt);
+	}
+
+	if (isExisting)
+	{
+		directory.entries[change.name] = next;
+
+		if (next.isWalked)
+		{
+			if (!ScanDirectory(state, childKey, change.directory, outError)) return false;
+			added = GetSubtreeTotals(state.directories[childKey]);
+		}
+		else if (next.isCounted)
+		{
+			added.size = next.size;
+			added.fileCount = 1;
+		}
+	}
+
+	ApplyDelta(state, change.directory, added, removed);
+
+	return true;
+}
+
+//Must be called under stateMutex
+static void StopWatching(WatcherState& state)
+{
+#ifdef _WIN32
+	if (state.handle != INVALID_HANDLE_VALUE)
+	{
+		//the pending read writes into buffer, so it must be cancelled before the buffer is freed
+		if (state.isReadPending)
+		{
+			CancelIoEx(state.handle, &state.overlapped);
+
+			DWORD bytes{};
+			GetOverlappedResult(state.handle, &state.overlapped, &bytes, TRUE);
+			state.isReadPending = false;
+		}
+
+		CloseHandle(state.handle);
+		state.handle = INVALID_HANDLE_VALUE;
+	}
+	if (state.overlapped.hEvent)
+	{
+		CloseHandle(state.overlapped.hEvent);
+		state.overlapped = {};
+	}
+#else
+	//closing the descriptor removes every watch at once
+	if (state.fd != -1)
+	{
+		close(state.fd);
+		state.fd = -1;
+	}
+	state.descriptors.clear();
+#endif
+
+	state.directories.clear();
+	state.root.clear();
+	state.buffer = {};
+}
+
+//Collects every change reported since the last call without waiting for new ones.
+//Sets outIsOverflowed if the system dropped events and the tree has to be scanned again
+static string ReadChanges(
+	WatcherState& state,
+	vector<PendingChange>& outChanges,
+	bool& outIsOverflowed)
+{
+#ifdef _WIN32
+	while (true)
+	{
+		DWORD bytes{};
+		if (!GetOverlappedResult(state.handle, &state.overlapped, &bytes, FALSE))
+		{
+			if (GetLastError() == ERROR_IO_INCOMPLETE) break;
+
+			state.isReadPending = false;
+			return "Failed to read changes of '" + state.root + "'! Reason: " + GetLastErrorString();
+		}
+		state.isReadPending = false;
+
+		//an empty completion means the system buffer overflowed
+		if (bytes == 0) outIsOverflowed = true;
+		else
+		{
+			const u8* data = rcast<const u8*>(state.buffer.data());
+			size_t offset{};
+			while (true)
+			{
+				const FILE_NOTIFY_INFORMATION* info = rcast<const FILE_NOTIFY_INFORMATION*>(data + offset);
+
+				const path changed = path(state.root) / std::wstring_view(
+					info->FileName,
+					info->FileNameLength / sizeof(WCHAR));
+
+				PendingChange change{};
+				change.directory = changed.parent_path().string();
+				change.name = changed.filename().string();
+				change.isReplaced = info->Action == FILE_ACTION_ADDED
+					|| info->Action == FILE_ACTION_RENAMED_NEW_NAME;
+
+				outChanges.push_back(move(change));
+
+				if (info->NextEntryOffset == 0) break;
+				offset += info->NextEntryOffset;
+			}
+		}
+
+		if (!IssueRead(state))
+		{
+			return "Failed to keep watching '" + state.root + "'! Reason: " + GetLastErrorString();
+		}
+	}
+#else
+	while (true)
+	{
+		const ssize_t bytes = read(state.fd, state.buffer.data(), state.buffer.size());
+		if (bytes < 0)
+		{
+			if (errno == EINTR) continue;
+			if (errno == EAGAIN) break;
+
+			return "Failed to read changes of '" + state.root + "'! Reason: " + strerror(errno);
+		}
+		if (bytes == 0) break;
+
+		size_t offset{};
+		while (offset < scast<size_t>(bytes))
+		{
+			const inotify_event* event = rcast<const inotify_event*>(state.buffer.data() + offset);
+			offset += sizeof(inotify_event) + event->len;
+
+			if (event->mask & IN_Q_OVERFLOW)
+			{
+				outIsOverflowed = true;
+				continue;
+			}
+
+			auto it = state.descriptors.find(event->wd);
+			if (it == state.descriptors.end()) continue;
+
+			if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF))
+			{
+				if (it->second == state.root)
+				{
+					return "Stopped watching '" + state.root + "' because it was removed or renamed!";
+				}
+
+				//the parent reports the same change by name
+				continue;
+			}
+			if (event->len == 0) continue;
+
+			PendingChange change{};
+			change.directory = it->second;
+			change.name = event->name;
+			change.isReplaced = (event->mask & (IN_CREATE | IN_MOVED_TO)) != 0;
+
+			outChanges.push_back(move(change));
+		}
+	}
+#endif
+
+	return{};
+}
+
+//Applies every pending change to the snapshot, must be called under stateMutex.
+//Stops watching and returns false if the snapshot can't be kept up to date anymore
+static bool SyncSnapshot(WatcherState& state)
+{
+	if (state.root.empty()) return false;
+
+	vector<PendingChange> changes{};
+	bool isOverflowed{};
+
+	string result = ReadChanges(state, changes, isOverflowed);
+
+	if (result.empty()
+		&& isOverflowed)
+	{
+		//dropped events can't be recovered, so the whole tree is read again
+		const string root = state.root;
+		RemoveDirectory(state, root);
+		ScanDirectory(state, root, {}, result);
+	}
+	else if (result.empty())
+	{
+		//a file written in many steps reports many changes, but it only has to be read once
+		unordered_map<string, size_t> seen{};
+		seen.reserve(changes.size());
+
+		vector<PendingChange> unique{};
+		unique.reserve(changes.size());
+
+		for (auto& c : changes)
+		{
+			const string key = (path(c.directory) / c.name).string();
+
+			auto [it, isNew] = seen.try_emplace(key, unique.size());
+			if (isNew) unique.push_back(move(c));
+			else if (c.isReplaced)
+			{
+				//renamed away and back again, so its place in order follows the later change
+				unique[it->second].isReplaced = true;
+			}
+		}
+
+		for (const auto& c : unique)
+		{
+			if (!RefreshEntry(state, c, result)) break;
+		}
+	}
+
+	if (!result.empty())
+	{
+		StopWatching(state);
+
+		Log::Print(
+			result,
+			"WATCH",
+			LogType::LOG_WARNING);
+
+		return false;
+	}
+
+	return true;
+}
+
+//Visits one snapshot folder, relativePath is the path of key from the visited folder with a trailing separator
+static bool VisitSnapshot(
+	WatcherState& state,
+	const string& key,
+	string& relativePath,
+	const function<VisitResult(const WatchedEntry&)>& visitor,
+	bool recursive)
+{
+	auto it = state.directories.find(key);
+	if (it == state.directories.end()) return true;
+
+	const size_t prefixLength = relativePath.size();
+
+	for (const auto& [name, entry] : it->second.entries)
+	{
+		relativePath.resize(prefixLength);
+		relativePath += name;
+
+		WatchedEntry visited{};
+		visited.relativePath = relativePath;
+		visited.name = name;
+		visited.isDirectory = entry.isDirectory;
+
+		VisitResult result = visitor(visited);
+
+		if (result == VisitResult::VISIT_STOP) return false;
+
+		if (recursive
+			&& entry.isWalked
+			&& result != VisitResult::VISIT_SKIP_DIRECTORY)
+		{
+			relativePath += scast<char>(path::preferred_separator);
+
+			if (!VisitSnapshot(
+				state,
+				(path(key) / name).string(),
+				relativePath,
+				visitor,
+				recursive))
+			{
+				return false;
+			}
+		}
+	}
+
+	relativePath.resize(prefixLength);
+
+	return true;
+}
+
+//Returns the snapshot folder of target or null if it isn't inside the watched tree, must be called under stateMutex
+static const string* FindDirectory(
+	WatcherState& state,
+	const path& target)
+{
+	if (!SyncSnapshot(state)) return nullptr;
+
+	string key = target.string();
+
+	auto it = state.directories.find(key);
+	if (it == state.directories.end())
+	{
+		key = ToKey(target);
+		it = state.directories.find(key);
+	}
+
+	if (it == state.directories.end()
+		|| it->second.isSkipped)
+	{
+		return nullptr;
+	}
+
+	return &it->first;
+}
+
+namespace KalaCLI
+{
+	string DirectoryWatcher::Start(const path& target)
+	{
+		const string root = ToKey(target);
+
+		error_code ec{};
+		if (!is_directory(root, ec))
+		{
+			return "Failed to watch '" + root + "' because it is not a directory!";
+		}
+
+		lock_guard lock(watcher.stateMutex);
+
+		StopWatching(watcher);
+
+#ifdef _WIN32
+		watcher.handle = CreateFileW(
+			path(root).wstring().c_str(),
+			FILE_LIST_DIRECTORY,
+			FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+			nullptr,
+			OPEN_EXISTING,
+			FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+			nullptr);
+
+		if (watcher.handle == INVALID_HANDLE_VALUE)
+		{
+			return "Failed to watch '" + root + "'! Reason: " + GetLastErrorString();
+		}
+
+		watcher.overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+		watcher.buffer.resize(WATCH_EVENT_BUFFER_SIZE / sizeof(DWORD));
+
+		//queued before the scan so that nothing changed during the scan is missed
+		if (!watcher.overlapped.hEvent
+			|| !IssueRead(watcher))
+		{
+			string reason = GetLastErrorString();
+			StopWatching(watcher);
+
+			return "Failed to watch '" + root + "'! Reason: " + reason;
+		}
+#else
+		watcher.fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (watcher.fd == -1)
+		{
+			return "Failed to watch '" + root + "'! Reason: " + strerror(errno);
+		}
+
+		watcher.buffer.resize(WATCH_EVENT_BUFFER_SIZE);
+#endif
+
+		watcher.root = root;
+
+		string result{};
+		if (!ScanDirectory(watcher, root, {}, result))
+		{
+			StopWatching(watcher);
+			return result;
+		}
+
+		if (watcher.directories[root].isSkipped)
+		{
+			StopWatching(watcher);
+			return "Failed to watch '" + root + "' because it couldn't be opened!";
+		}
+
+		return{};
+	}
+
+	void DirectoryWatcher::Stop()
+	{
+		lock_guard lock(watcher.stateMutex);
+		StopWatching(watcher);
+	}
+
+	bool DirectoryWatcher::IsWatching()
+	{
+		lock_guard lock(watcher.stateMutex);
+		return !watcher.root.empty();
+	}
+
+	string DirectoryWatcher::GetRoot()
+	{
+		lock_guard lock(watcher.stateMutex);
+		return watcher.root;
+	}
+
+	bool DirectoryWatcher::VisitDirectory(
+		const path& target,
+		const function<VisitResult(const WatchedEntry&)>& visitor,
+		bool recursive)
+	{
+		lock_guard lock(watcher.stateMutex);
+
+		const string* key = FindDirectory(watcher, target);
+		if (!key) return false;
+
+		string relativePath{};
+		VisitSnapshot(
+			watcher,
+			*key,
+			relativePath,
+			visitor,
+			recursive);
+
+		return true;
+	}
+
+	bool DirectoryWatcher::GetDirectorySize(
+		const path& target,
+		DirectorySize& outSize)
+	{
+		lock_guard lock(watcher.stateMutex);
+
+		const string* key = FindDirectory(watcher, target);
+		if (!key) return false;
+
+		const TreeTotals& totals = watcher.directories[*key].totals;
+
+		outSize = DirectorySize{};
+		outSize.size = totals.size;
+		outSize.fileCount = totals.fileCount;
+		outSize.directoryCount = totals.directoryCount;
+		outSize.skippedCount = totals.skippedCount;
+
+		//like a fully cached walk, every folder including the target itself came from the snapshot
+		outSize.cachedCount = totals.directoryCount + 1;
+
+		return true;
+	}
+}
@@ -0,0 +1,201 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include <future>
+#include <system_error>
+
+#include "KalaHeaders/thread_utils.hpp"
+
+#include "disk_usage.hpp"
+#include "dir_watcher.hpp"
+
+using KalaHeaders::KalaThread::ThreadPool;
+
+using KalaCLI::DiskUsage;
+using KalaCLI::DirectorySize;
+using KalaCLI::CachedDirectory;
+using KalaCLI::DirectoryWatcher;
+
+using std::string;
+using std::vector;
+using std::unordered_map;
+using std::future;
+using std::mutex;
+using std::lock_guard;
+using std::error_code;
+using std::filesystem::path;
+using std::filesystem::directory_iterator;
+using std::filesystem::directory_entry;
+using std::filesystem::directory_options;
+using std::filesystem::file_time_type;
+using std::filesystem::last_write_time;
+using std::filesystem::exists;
+using std::filesystem::is_directory;
+
+//Measures one folder and waits for its subfolders, which are queued as their own pool tasks.
+//The result counts the folder itself in directoryCount, or in skippedCount if it couldn't be opened
+static DirectorySize MeasureDirectory(
+	const path& target,
+	bool useCache,
+	ThreadPool& pool,
+	unordered_map<string, CachedDirectory>& cache,
+	mutex& cacheMutex)
+{
+	DirectorySize result{};
+
+	error_code ec{};
+	file_time_type lastWrite = last_write_time(target, ec);
+	const bool canCache = useCache && !ec;
+
+	CachedDirectory own{};
+	bool isCached{};
+
+	if (canCache)
+	{
+		lock_guard<mutex> lock(cacheMutex);
+
+		auto it = cache.find(target.string());
+		if (it != cache.end()
+			&& it->second.lastWrite == lastWrite)
+		{
+			own = it->second;
+			isCached = true;
+		}
+	}
+
+	if (!isCached)
+	{
+		directory_iterator it(target, directory_options::skip_permission_denied, ec);
+		if (ec)
+		{
+			result.skippedCount = 1;
+			return result;
+		}
+
+		for (const directory_iterator end{}; it != end; it.increment(ec))
+		{
+			if (ec) break;
+
+			const directory_entry& entry = *it;
+
+			//types and, where the platform provides them, sizes come from the cached entry data
+			error_code entryEC{};
+			if (entry.is_symlink(entryEC))
+			{
+				//links are never followed, folder links can point back up the tree
+				//and file links would count their target twice
+				continue;
+			}
+			if (entry.is_directory(entryEC))
+			{
+				own.subdirectories.push_back(entry.path());
+				continue;
+			}
+			if (entry.is_regular_file(entryEC))
+			{
+				uintmax_t size = entry.file_size(entryEC);
+				if (entryEC) continue;
+
+				own.ownSize += size;
+				++own.ownFileCount;
+			}
+		}
+
+		own.lastWrite = lastWrite;
+
+		if (canCache)
+		{
+			lock_guard<mutex> lock(cacheMutex);
+			cache[target.string()] = own;
+		}
+	}
+
+	result.size = own.ownSize;
+	result.fileCount = own.ownFileCount;
+	result.directoryCount = 1;
+	result.cachedCount = isCached ? 1 : 0;
+
+	vector<future<DirectorySize>> children{};
+	children.reserve(own.subdirectories.size());
+
+	for (const auto& sub : own.subdirectories)
+	{
+		children.push_back(pool.Submit([&sub, useCache, &pool, &cache, &cacheMutex]()
+			{
+				return MeasureDirectory(
+					sub,
+					useCache,
+					pool,
+					cache,
+					cacheMutex);
+			}));
+	}
+
+	//waiting runs other queued folders on this thread, so deep trees can't starve the pool
+	for (auto& child : children)
+	{
+		DirectorySize c = pool.Await(child);
+
+		result.size += c.size;
+		result.fileCount += c.fileCount;
+		result.directoryCount += c.directoryCount;
+		result.skippedCount += c.skippedCount;
+		result.cachedCount += c.cachedCount;
+	}
+
+	return result;
+}
+
+namespace KalaCLI
+{
+	string DiskUsage::GetDirectorySize(
+		const path& target,
+		DirectorySize& outSize,
+		bool useCache)
+	{
+		error_code ec{};
+
+		if (!exists(target, ec))
+		{
+			return "Failed to get target directory '" + target.string() + "' size because it does not exist!";
+		}
+		if (!is_directory(target, ec))
+		{
+			return "Failed to get target directory '" + target.string() + "' size because it is not a directory!";
+		}
+
+		//a watched tree already knows its totals and costs nothing to ask
+		if (useCache
+			&& DirectoryWatcher::GetDirectorySize(target, outSize))
+		{
+			return{};
+		}
+
+		DirectorySize result = MeasureDirectory(
+			target,
+			useCache,
+			ThreadPool::GetShared(),
+			cache,
+			cacheMutex);
+
+		if (result.directoryCount == 0)
+		{
+			return "Failed to get target directory '" + target.string() + "' size because it couldn't be opened!";
+		}
+
+		//the target itself is not one of its subfolders
+		--result.directoryCount;
+
+		outSize = result;
+
+		return{};
+	}
+
+	void DiskUsage::ClearCache()
+	{
+		lock_guard<mutex> lock(cacheMutex);
+		cache.clear();
+	}
+}
@@ -0,0 +1,106 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include "lexer.hpp"
+
+static bool IsWhiteSpace(char c)
+{
+	return c == ' '
+		|| c == '\t'
+		|| c == '\n'
+		|| c == '\r'
+		|| c == '\f'
+		|| c == '\v';
+}
+
+namespace KalaCLI
+{
+	void Lexer::Tokenize(
+		string_view line,
+		LexedLine& outLine)
+	{
+		//reuses existing capacity, so the views below stay valid until the next call
+		outLine.buffer.assign(line);
+		outLine.tokens.clear();
+		outLine.commands.clear();
+
+		char* data = outLine.buffer.data();
+		const size_t size = outLine.buffer.size();
+
+		//quotes are removed by compacting the buffer, write never passes read
+		size_t read{};
+		size_t write{};
+
+		size_t tokenStart{};
+		bool inToken{};
+		char quote{};
+
+		u32 commandFirst{};
+
+		auto EndToken = [&]()
+			{
+				if (!inToken) return;
+
+				outLine.tokens.emplace_back(data + tokenStart, write - tokenStart);
+				inToken = false;
+			};
+		auto EndCommand = [&](bool isParallel)
+			{
+				EndToken();
+
+				u32 count = scast<u32>(outLine.tokens.size()) - commandFirst;
+				if (count > 0) outLine.commands.push_back({ commandFirst, count, isParallel });
+
+				commandFirst = scast<u32>(outLine.tokens.size());
+			};
+
+		while (read < size)
+		{
+			char c = data[read++];
+
+			if (quote != 0)
+			{
+				if (c == quote) quote = 0;
+				else data[write++] = c;
+
+				continue;
+			}
+
+			if (IsWhiteSpace(c))
+			{
+				EndToken();
+				continue;
+			}
+
+			if (c == CHAIN_SEPARATOR)
+			{
+				//read already points past the first separator
+				bool isParallel = line.substr(read - 1).starts_with(PARALLEL_SEPARATOR);
+				if (isParallel) read += PARALLEL_SEPARATOR.size() - 1;
+
+				EndCommand(isParallel);
+				continue;
+			}
+
+			if (!inToken)
+			{
+				//a new token starts at the compacted write position
+				inToken = true;
+				tokenStart = write;
+			}
+
+			if (c == '"'
+				|| c == '\'')
+			{
+				quote = c;
+				continue;
+			}
+
+			data[write++] = c;
+		}
+
+		EndCommand(false);
+	}
+}
@@ -0,0 +1,151 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include <new>
+#include <cstdint>
+
+#include "line_arena.hpp"
+
+using KalaCLI::ARENA_FIRST_BLOCK_SIZE;
+using KalaCLI::MAX_ARENA_BLOCKS;
+
+using std::lock_guard;
+using std::bad_alloc;
+using std::memory_order_relaxed;
+using std::memory_order_acquire;
+using std::memory_order_release;
+using std::memory_order_acq_rel;
+
+//Low bits of LineArena::state that hold the used bytes of the current block
+constexpr u64 OFFSET_BITS = 48;
+constexpr u64 OFFSET_MASK = (1ULL << OFFSET_BITS) - 1;
+
+namespace KalaCLI
+{
+	LineArena::~LineArena()
+	{
+		FreeBlocks();
+	}
+
+	void LineArena::Reset()
+	{
+		const size_t count = blockCount.load(memory_order_relaxed);
+		if (count > 1)
+		{
+			size_t total{};
+			for (size_t i = 0; i < count; ++i) total += blocks[i].size;
+
+			FreeBlocks();
+
+			blocks[0] = { new char[total], total };
+			blockCount.store(1, memory_order_release);
+		}
+
+		state.store(0, memory_order_release);
+	}
+
+	size_t LineArena::GetUsedSize() const
+	{
+		const u64 observed = state.load(memory_order_acquire);
+		const size_t index = scast<size_t>(observed >> OFFSET_BITS);
+		const size_t count = blockCount.load(memory_order_acquire);
+
+		size_t used = scast<size_t>(observed & OFFSET_MASK);
+		for (size_t i = 0; i < index && i < count; ++i) used += blocks[i].size;
+
+		return used;
+	}
+
+	size_t LineArena::GetCapacity() const
+	{
+		const size_t count = blockCount.load(memory_order_acquire);
+
+		size_t capacity{};
+		for (size_t i = 0; i < count; ++i) capacity += blocks[i].size;
+
+		return capacity;
+	}
+
+	void* LineArena::do_allocate(
+		size_t bytes,
+		size_t alignment)
+	{
+		u64 observed = state.load(memory_order_acquire);
+
+		while (true)
+		{
+			const size_t index = scast<size_t>(observed >> OFFSET_BITS);
+
+			//the block count is published after the block, so a counted block is always complete
+			if (index < blockCount.load(memory_order_acquire))
+			{
+				const Block& block = blocks[index];
+
+				const uintptr_t base = rcast<uintptr_t>(block.data);
+				const uintptr_t first = base + scast<uintptr_t>(observed & OFFSET_MASK);
+				const uintptr_t aligned = (first + alignment - 1) & ~(scast<uintptr_t>(alignment) - 1);
+				const size_t end = scast<size_t>(aligned - base) + bytes;
+
+				if (end <= block.size)
+				{
+					const u64 desired = (scast<u64>(index) << OFFSET_BITS) | scast<u64>(end);
+					if (state.compare_exchange_weak(
+						observed,
+						desired,
+						memory_order_acq_rel,
+						memory_order_acquire))
+					{
+						return rcast<void*>(aligned);
+					}
+
+					//another thread bumped first, observed now holds its state
+					continue;
+				}
+			}
+
+			//the current block is full or there is no block yet
+			{
+				lock_guard lock(growMutex);
+
+				const size_t count = blockCount.load(memory_order_relaxed);
+				const size_t next = index < count ? index + 1 : index;
+
+				if (next == count)
+				{
+					if (count == MAX_ARENA_BLOCKS) throw bad_alloc();
+
+					size_t size = count == 0
+						? ARENA_FIRST_BLOCK_SIZE
+						: blocks[count - 1].size * 2;
+					while (size < bytes + alignment) size *= 2;
+
+					blocks[count] = { new char[size], size };
+					blockCount.store(count + 1, memory_order_release);
+				}
+
+				//fails if another thread bumped or moved on meanwhile, observed then holds its state
+				state.compare_exchange_strong(
+					observed,
+					scast<u64>(next) << OFFSET_BITS,
+					memory_order_acq_rel,
+					memory_order_acquire);
+			}
+
+			observed = state.load(memory_order_acquire);
+		}
+	}
+
+	void LineArena::FreeBlocks()
+	{
+		const size_t count = blockCount.load(memory_order_relaxed);
+		for (size_t i = 0; i < count; ++i)
+		{
+			delete[] blocks[i].data;
+			blocks[i] = {};
+		}
+
+		blockCount.store(0, memory_order_release);
+	}
+}
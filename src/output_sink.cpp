@@ -0,0 +1,73 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include <cstdio>
+
+#ifdef _WIN32
+	#include <io.h>
+#else
+	#include <unistd.h>
+#endif
+
+#include "KalaHeaders/log_utils.hpp"
+
+#include "output_sink.hpp"
+
+using KalaHeaders::KalaLog::Log;
+
+using KalaCLI::CONSOLE_FLUSH_SIZE;
+using KalaCLI::REDIRECTED_FLUSH_SIZE;
+
+using std::string_view;
+
+namespace KalaCLI
+{
+	OutputSink& OutputSink::Get()
+	{
+		static thread_local OutputSink sink = []()
+			{
+				OutputSink newSink{};
+				newSink.flushSize = IsRedirected()
+					? REDIRECTED_FLUSH_SIZE
+					: CONSOLE_FLUSH_SIZE;
+
+				//headroom past the flush size so the append that crosses it rarely reallocates
+				newSink.buffer.reserve(newSink.flushSize + 1024);
+
+				return newSink;
+			}();
+
+		return sink;
+	}
+
+	bool OutputSink::IsRedirected()
+	{
+#ifdef _WIN32
+		static const bool isRedirected = _isatty(_fileno(stdout)) == 0;
+#else
+		static const bool isRedirected = isatty(fileno(stdout)) == 0;
+#endif
+		return isRedirected;
+	}
+
+	void OutputSink::Flush()
+	{
+		if (buffer.empty()) return;
+
+		Log::PrintRaw(buffer);
+		buffer.clear();
+	}
+
+	bool OutputSink::AppendUntilField(string_view& pattern)
+	{
+		const size_t field = pattern.find("{}");
+		if (field == string_view::npos) return false;
+
+		buffer.append(pattern.substr(0, field));
+		pattern.remove_prefix(field + 2);
+
+		return true;
+	}
+}
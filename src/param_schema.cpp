@@ -0,0 +1,261 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include <charconv>
+#include <system_error>
+
+#include "param_schema.hpp"
+#include "command.hpp"
+
+using KalaCLI::ParamSpec;
+using KalaCLI::ParamType;
+using KalaCLI::ParsedArg;
+using KalaCLI::COMMAND_PREFIX;
+using KalaCLI::PARAM_CHOICE_SEPARATOR;
+using KalaCLI::MAX_PARSED_PARAMS;
+
+using std::string;
+using std::string_view;
+using std::to_string;
+using std::from_chars;
+using std::errc;
+
+static const char* GetTypeName(ParamType type)
+{
+	switch (type)
+	{
+	case ParamType::PARAM_INT:   return "int";
+	case ParamType::PARAM_FLOAT: return "float";
+	case ParamType::PARAM_PATH:  return "path";
+	case ParamType::PARAM_ENUM:  return "enum";
+	case ParamType::PARAM_FLAG:  return "flag";
+	default:                     return "string";
+	}
+}
+
+//Converts text into arg as spec describes, returns an error if it doesn't fit
+static string Convert(
+	const ParamSpec& spec,
+	string_view text,
+	ParsedArg& outArg)
+{
+	outArg.text = text;
+	outArg.isSet = true;
+
+	const char* first = text.data();
+	const char* last = text.data() + text.size();
+
+	switch (spec.type)
+	{
+	case ParamType::PARAM_INT:
+	{
+		auto [ptr, ec] = from_chars(first, last, outArg.intValue);
+		if (ec != errc{}
+			|| ptr != last
+			|| outArg.intValue < spec.minValue
+			|| outArg.intValue > spec.maxValue)
+		{
+			const bool hasMin = spec.minValue != INT64_MIN;
+			const bool hasMax = spec.maxValue != INT64_MAX;
+
+			string result = "'" + string(spec.name) + "' must be an integer";
+			if (hasMin && hasMax) result += " from " + to_string(spec.minValue) + " to " + to_string(spec.maxValue);
+			else if (hasMin) result += " of at least " + to_string(spec.minValue);
+			else if (hasMax) result += " of at most " + to_string(spec.maxValue);
+
+			return result + ", got '" + string(text) + "'!";
+		}
+		outArg.floatValue = scast<f64>(outArg.intValue);
+		break;
+	}
+	case ParamType::PARAM_FLOAT:
+	{
+		auto [ptr, ec] = from_chars(first, last, outArg.floatValue);
+		if (ec != errc{}
+			|| ptr != last)
+		{
+			return "'" + string(spec.name) + "' must be a number, got '" + string(text) + "'!";
+		}
+		break;
+	}
+	case ParamType::PARAM_PATH:
+	{
+		if (text.empty()) return "'" + string(spec.name) + "' must not be an empty path!";
+		break;
+	}
+	case ParamType::PARAM_ENUM:
+	{
+		string_view choices = spec.choices;
+		i64 index{};
+		while (true)
+		{
+			const size_t end = choices.find(PARAM_CHOICE_SEPARATOR);
+			if (choices.substr(0, end) == text)
+			{
+				outArg.intValue = index;
+				return{};
+			}
+			if (end == string_view::npos) break;
+
+			choices.remove_prefix(end + 1);
+			++index;
+		}
+
+		string result = "'" + string(spec.name) + "' must be one of '";
+		for (char c : spec.choices)
+		{
+			if (c == PARAM_CHOICE_SEPARATOR) result += "', '";
+			else result += c;
+		}
+		return result + "', got '" + string(text) + "'!";
+	}
+	default:
+		break;
+	}
+
+	return{};
+}
+
+//Appends '<name:type>' or '<name:a|b>' for one spec, or only '<type>' without a name
+static void AppendValue(
+	string& out,
+	const ParamSpec& spec,
+	string_view name)
+{
+	out += '<';
+	if (!name.empty())
+	{
+		out += name;
+		out += ':';
+	}
+	if (spec.type == ParamType::PARAM_ENUM) out += spec.choices;
+	else out += GetTypeName(spec.type);
+	out += '>';
+}
+
+namespace KalaCLI
+{
+	string ParamParser::Parse(
+		const ParamSchema& schema,
+		string_view name,
+		span<const string_view> params,
+		ParsedArgs& outArgs)
+	{
+		outArgs.name = name;
+
+		const size_t maxCount = schema.isVariadic
+			? MAX_PARSED_PARAMS
+			: schema.params.size();
+
+		for (size_t i = 0; i < params.size(); ++i)
+		{
+			string_view param = params[i];
+
+			//anything with the command prefix is an option, so typos are reported instead of taken as values
+			if (!COMMAND_PREFIX.empty()
+				&& param.starts_with(COMMAND_PREFIX)
+				&& param.size() > COMMAND_PREFIX.size())
+			{
+				const size_t equals = param.find('=');
+				string_view optionName = param.substr(0, equals);
+
+				size_t o = 0;
+				while (o < schema.options.size()
+					&& schema.options[o].name != optionName)
+				{
+					++o;
+				}
+
+				if (o == schema.options.size())
+				{
+					return "'" + string(optionName) + "' is not a valid option!";
+				}
+
+				const ParamSpec& spec = schema.options[o];
+				ParsedArg& arg = outArgs.options[o];
+
+				if (spec.type == ParamType::PARAM_FLAG)
+				{
+					if (equals != string_view::npos) return "Option '" + string(optionName) + "' does not take a value!";
+
+					arg.text = optionName;
+					arg.intValue = 1;
+					arg.isSet = true;
+					continue;
+				}
+
+				string_view value{};
+				if (equals != string_view::npos) value = param.substr(equals + 1);
+				else if (i + 1 < params.size()) value = params[++i];
+				else return "Option '" + string(optionName) + "' needs a value!";
+
+				string result = Convert(spec, value, arg);
+				if (!result.empty()) return result;
+
+				continue;
+			}
+
+			if (outArgs.paramCount == maxCount)
+			{
+				return "Too many parameters were passed, expected at most " + to_string(maxCount) + "!";
+			}
+
+			const size_t specIndex = outArgs.paramCount < schema.params.size()
+				? outArgs.paramCount
+				: schema.params.size() - 1;
+
+			string result = Convert(
+				schema.params[specIndex],
+				param,
+				outArgs.params[outArgs.paramCount]);
+			if (!result.empty()) return result;
+
+			++outArgs.paramCount;
+		}
+
+		if (outArgs.paramCount < schema.minCount)
+		{
+			return "Missing parameter '" + string(schema.params[outArgs.paramCount].name) + "'!";
+		}
+
+		return{};
+	}
+
+	string ParamParser::FormatUsage(const ParamSchema& schema)
+	{
+		string result{};
+
+		for (size_t i = 0; i < schema.params.size(); ++i)
+		{
+			const ParamSpec& spec = schema.params[i];
+			const bool isOptional = i >= schema.minCount;
+
+			if (!result.empty()) result += ' ';
+			if (isOptional) result += '[';
+			AppendValue(result, spec, spec.name);
+			if (schema.isVariadic
+				&& i + 1 == schema.params.size())
+			{
+				result += "...";
+			}
+			if (isOptional) result += ']';
+		}
+
+		for (const auto& o : schema.options)
+		{
+			if (!result.empty()) result += ' ';
+			result += '[';
+			result += o.name;
+			if (o.type != ParamType::PARAM_FLAG)
+			{
+				result += ' ';
+				AppendValue(result, o, {});
+			}
+			result += ']';
+		}
+
+		return result;
+	}
+}
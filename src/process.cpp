@@ -0,0 +1,576 @@
+//Copyright(C) 2025 Lost Empire Entertainment
+//This program comes with ABSOLUTELY NO WARRANTY.
+//This is free software, and you are welcome to redistribute it under certain conditions.
+//Read LICENSE.md for more information.
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <spawn.h>
+	#include <unistd.h>
+	#include <fcntl.h>
+	#include <sys/wait.h>
+
+	extern char** environ;
+#endif
+
+#include "KalaHeaders/log_utils.hpp"
+
+#include "process.hpp"
+
+using KalaCLI::ProcessLauncher;
+using KalaCLI::ProcessJob;
+
+using KalaHeaders::KalaLog::Log;
+
+using KalaHeaders::KalaCore::ToVar;
+using KalaHeaders::KalaCore::FromVar;
+
+using std::string;
+using std::string_view;
+using std::vector;
+using std::span;
+using std::mutex;
+using std::lock_guard;
+using std::system;
+using std::to_string;
+
+//How many bytes are read from the capture pipe at once
+constexpr size_t CAPTURE_CHUNK_SIZE = 64ULL * 1024;
+
+//Joins all args with spaces, only used for displaying jobs
+static string JoinForDisplay(span<const string_view> args)
+{
+	string result{};
+	for (size_t i = 0; i < args.size(); ++i)
+	{
+		result += args[i];
+		if (i + 1 < args.size()) result += ' ';
+	}
+	return result;
+}
+
+#ifdef _WIN32
+//Returns the message of the last Win32 error
+static string GetLastErrorString()
+{
+	DWORD err = GetLastError();
+
+	char* buffer{};
+	DWORD length = FormatMessageA(
+		FORMAT_MESSAGE_ALLOCATE_BUFFER
+		| FORMAT_MESSAGE_FROM_SYSTEM
+		| FORMAT_MESSAGE_IGNORE_INSERTS,
+		nullptr,
+		err,
+		0,
+		rcast<LPSTR>(&buffer),
+		0,
+		nullptr);
+
+	string result = "(error " + to_string(err) + ")";
+	if (length > 0)
+	{
+		result += ": ";
+		result.append(buffer, length);
+		LocalFree(buffer);
+	}
+	return result;
+}
+
+//Converts an utf-8 string to the utf-16 string Win32 expects
+static std::wstring ToWide(const string& value)
+{
+	if (value.empty()) return{};
+
+	int length = MultiByteToWideChar(
+		CP_UTF8,
+		0,
+		value.data(),
+		scast<int>(value.size()),
+		nullptr,
+		0);
+
+	std::wstring result(scast<size_t>(length), L'\0');
+	MultiByteToWideChar(
+		CP_UTF8,
+		0,
+		value.data(),
+		scast<int>(value.size()),
+		result.data(),
+		length);
+
+	return result;
+}
+
+//Windows only accepts a single command line, so quote each argument
+//the way CommandLineToArgvW splits it back so the child still sees the same argv
+static void AppendQuotedArgument(
+	string& out,
+	string_view arg)
+{
+	if (!arg.empty()
+		&& arg.find_first_of(" \t\n\v\"") == string_view::npos)
+	{
+		out += arg;
+		return;
+	}
+
+	out += '"';
+
+	size_t backslashes{};
+	for (char c : arg)
+	{
+		if (c == '\\')
+		{
+			++backslashes;
+			continue;
+		}
+
+		if (c == '"') out.append(backslashes * 2 + 1, '\\');
+		else out.append(backslashes, '\\');
+
+		backslashes = 0;
+		out += c;
+	}
+
+	//backslashes before the closing quote must be doubled
+	out.append(backslashes * 2, '\\');
+	out += '"';
+}
+
+//Starts the process and returns its handle, optionally with the read end of its stdout pipe
+static string SpawnProcess(
+	span<const string_view> args,
+	HANDLE& outProcess,
+	HANDLE* outReadPipe)
+{
+	string commandLine{};
+	for (size_t i = 0; i < args.size(); ++i)
+	{
+		AppendQuotedArgument(commandLine, args[i]);
+		if (i + 1 < args.size()) commandLine += ' ';
+	}
+
+	std::wstring wideCommandLine = ToWide(commandLine);
+
+	STARTUPINFOW si{};
+	si.cb = sizeof(si);
+
+	HANDLE readPipe{};
+	HANDLE writePipe{};
+
+	//the inheritable write end would leak into any process started by another thread
+	//before it is closed here, so pipe creation and process creation are serialized
+	static mutex spawnMutex{};
+	lock_guard<mutex> spawnLock(spawnMutex);
+
+	if (outReadPipe)
+	{
+		SECURITY_ATTRIBUTES sa{};
+		sa.nLength = sizeof(sa);
+		sa.bInheritHandle = TRUE;
+
+		if (!CreatePipe(&readPipe, &writePipe, &sa, 0))
+		{
+			return "Failed to create stdout pipe! Reason: " + GetLastErrorString();
+		}
+
+		//only the write end may be inherited by the child
+		SetHandleInformation(readPipe, HANDLE_FLAG_INHERIT, 0);
+
+		si.dwFlags = STARTF_USESTDHANDLES;
+		si.hStdInput = GetStdHandle(STD_INPUT_HANDLE);
+		si.hStdOutput = writePipe;
+		si.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+	}
+
+	PROCESS_INFORMATION pi{};
+
+	BOOL created = CreateProcessW(
+		nullptr,
+		wideCommandLine.data(),
+		nullptr,
+		nullptr,
+		outReadPipe ? TRUE : FALSE,
+		0,
+		nullptr,
+		nullptr,
+		&si,
+		&pi);
+
+	if (outReadPipe) CloseHandle(writePipe);
+
+	if (!created)
+	{
+		string reason = GetLastErrorString();
+		if (outReadPipe) CloseHandle(readPipe);
+
+		return "Failed to start '" + string(args[0]) + "'! Reason: " + reason;
+	}
+
+	CloseHandle(pi.hThread);
+
+	outProcess = pi.hProcess;
+	if (outReadPipe) *outReadPipe = readPipe;
+
+	return{};
+}
+
+//Waits for the process to exit, closes its handle and returns its exit code
+static int WaitProcess(HANDLE process)
+{
+	WaitForSingleObject(process, INFINITE);
+
+	DWORD exitCode{};
+	GetExitCodeProcess(process, &exitCode);
+	CloseHandle(process);
+
+	return scast<int>(exitCode);
+}
+
+//Returns true and the exit code if the process has already exited
+static bool TryReapProcess(
+	HANDLE process,
+	int& outExitCode)
+{
+	if (WaitForSingleObject(process, 0) != WAIT_OBJECT_0) return false;
+
+	outExitCode = WaitProcess(process);
+	return true;
+}
+
+static void ReadPipe(
+	HANDLE readPipe,
+	string& outCapture)
+{
+	vector<char> chunk(CAPTURE_CHUNK_SIZE);
+	DWORD bytesRead{};
+
+	while (ReadFile(
+		readPipe,
+		chunk.data(),
+		scast<DWORD>(chunk.size()),
+		&bytesRead,
+		nullptr)
+		&& bytesRead > 0)
+	{
+		outCapture.append(chunk.data(), bytesRead);
+	}
+
+	CloseHandle(readPipe);
+}
+#else
+//Converts a wait status to a shell-style exit code
+static int ToExitCode(int status)
+{
+	if (WIFEXITED(status)) return WEXITSTATUS(status);
+	if (WIFSIGNALED(status)) return 128 + WTERMSIG(status);
+	return status;
+}
+
+//Starts the process and returns its pid, optionally with the read end of its stdout pipe
+static string SpawnProcess(
+	span<const string_view> args,
+	pid_t& outProcess,
+	int* outReadPipe)
+{
+	//argv must be null-terminated strings that outlive posix_spawnp
+	vector<string> ownedArgs(args.begin(), args.end());
+	vector<char*> argv{};
+	argv.reserve(ownedArgs.size() + 1);
+	for (auto& a : ownedArgs) argv.push_back(a.data());
+	argv.push_back(nullptr);
+
+	posix_spawn_file_actions_t actions{};
+	posix_spawn_file_actions_init(&actions);
+
+#ifndef __linux__
+	//without pipe2 the pipe is inheritable until fcntl marks it, a process started by another
+	//thread in between would keep the write end open, so pipe creation and process creation are serialized
+	static mutex spawnMutex{};
+	lock_guard<mutex> spawnLock(spawnMutex);
+#endif
+
+	int pipeFDs[2]{ -1, -1 };
+	if (outReadPipe)
+	{
+		//neither end may leak into the child or children started by other threads,
+		//dup2 clears the flag on the child stdout so only that copy is inherited
+#ifdef __linux__
+		const int pipeResult = pipe2(pipeFDs, O_CLOEXEC);
+#else
+		const int pipeResult = pipe(pipeFDs);
+#endif
+		if (pipeResult != 0)
+		{
+			posix_spawn_file_actions_destroy(&actions);
+			return "Failed to create stdout pipe! Reason: " + string(strerror(errno));
+		}
+
+#ifndef __linux__
+		fcntl(pipeFDs[0], F_SETFD, FD_CLOEXEC);
+		fcntl(pipeFDs[1], F_SETFD, FD_CLOEXEC);
+#endif
+
+		posix_spawn_file_actions_adddup2(&actions, pipeFDs[1], STDOUT_FILENO);
+		posix_spawn_file_actions_addclose(&actions, pipeFDs[1]);
+	}
+
+	pid_t pid{};
+	int result = posix_spawnp(
+		&pid,
+		argv[0],
+		&actions,
+		nullptr,
+		argv.data(),
+		environ);
+
+	posix_spawn_file_actions_destroy(&actions);
+	if (outReadPipe) close(pipeFDs[1]);
+
+	if (result != 0)
+	{
+		if (outReadPipe) close(pipeFDs[0]);
+
+		return "Failed to start '" + ownedArgs[0] + "'! Reason: " + string(strerror(result));
+	}
+
+	outProcess = pid;
+	if (outReadPipe) *outReadPipe = pipeFDs[0];
+
+	return{};
+}
+
+//Waits for the process to exit and returns its exit code
+static int WaitProcess(pid_t process)
+{
+	int status{};
+	while (waitpid(process, &status, 0) == -1)
+	{
+		if (errno != EINTR) return -1;
+	}
+	return ToExitCode(status);
+}
+
+//Returns true and the exit code if the process has already exited
+static bool TryReapProcess(
+	pid_t process,
+	int& outExitCode)
+{
+	int status{};
+	pid_t result = waitpid(process, &status, WNOHANG);
+
+	if (result == 0) return false;
+
+	outExitCode = result == process
+		? ToExitCode(status)
+		: -1;
+	return true;
+}
+
+static void ReadPipe(
+	int readPipe,
+	string& outCapture)
+{
+	vector<char> chunk(CAPTURE_CHUNK_SIZE);
+
+	while (true)
+	{
+		ssize_t bytesRead = read(readPipe, chunk.data(), chunk.size());
+
+		if (bytesRead > 0)
+		{
+			outCapture.append(chunk.data(), scast<size_t>(bytesRead));
+			continue;
+		}
+		if (bytesRead == -1
+			&& errno == EINTR)
+		{
+			continue;
+		}
+
+		break;
+	}
+
+	close(readPipe);
+}
+#endif
+
+namespace KalaCLI
+{
+#ifdef _WIN32
+	using ProcessHandle = HANDLE;
+	using PipeHandle = HANDLE;
+#else
+	using ProcessHandle = pid_t;
+	using PipeHandle = int;
+#endif
+
+	string ProcessLauncher::Run(
+		span<const string_view> args,
+		int& outExitCode,
+		string* outCapture)
+	{
+		if (args.empty()) return "Failed to run process because no arguments were passed!";
+
+		//anything still queued or buffered must reach the console before the child starts writing to it
+		Log::Flush();
+
+		ProcessHandle process{};
+		PipeHandle readPipe{};
+
+		string result = SpawnProcess(
+			args,
+			process,
+			outCapture ? &readPipe : nullptr);
+
+		if (!result.empty()) return result;
+
+		//drain the pipe before waiting so a chatty child can't block on a full pipe
+		if (outCapture) ReadPipe(readPipe, *outCapture);
+
+		outExitCode = WaitProcess(process);
+
+		return{};
+	}
+
+	string ProcessLauncher::RunShell(
+		string_view commandLine,
+		int& outExitCode)
+	{
+		if (commandLine.empty()) return "Failed to run shell command because it was empty!";
+
+		Log::Flush();
+
+		int status = system(string(commandLine).c_str());
+
+#ifdef _WIN32
+		outExitCode = status;
+#else
+		outExitCode = status == -1
+			? -1
+			: ToExitCode(status);
+#endif
+
+		return{};
+	}
+
+	string ProcessLauncher::StartJob(
+		span<const string_view> args,
+		u32& outJobID)
+	{
+		if (args.empty()) return "Failed to start job because no arguments were passed!";
+
+		Log::Flush();
+
+		ProcessHandle process{};
+
+		string result = SpawnProcess(
+			args,
+			process,
+			nullptr);
+
+		if (!result.empty()) return result;
+
+		lock_guard<mutex> lock(jobsMutex);
+
+		ProcessJob job{};
+		job.id = nextJobID++;
+		job.commandLine = JoinForDisplay(args);
+#ifdef _WIN32
+		job.handle = FromVar(process);
+#else
+		job.handle = scast<u64>(process);
+#endif
+
+		jobs.push_back(job);
+		outJobID = job.id;
+
+		return{};
+	}
+
+	string ProcessLauncher::WaitJob(
+		u32 jobID,
+		int& outExitCode)
+	{
+		ProcessHandle process{};
+		{
+			lock_guard<mutex> lock(jobsMutex);
+
+			ProcessJob* job{};
+			for (auto& j : jobs)
+			{
+				if (j.id == jobID) job = &j;
+			}
+
+			if (!job) return "Failed to wait for job '" + to_string(jobID) + "' because it does not exist!";
+
+			if (job->finished)
+			{
+				outExitCode = job->exitCode;
+				return{};
+			}
+			if (job->waiting) return "Failed to wait for job '" + to_string(jobID) + "' because it is already being waited on!";
+
+			job->waiting = true;
+
+#ifdef _WIN32
+			process = ToVar<HANDLE>(job->handle);
+#else
+			process = scast<pid_t>(job->handle);
+#endif
+		}
+
+		//wait outside the lock so other jobs can still be started and listed
+		int exitCode = WaitProcess(process);
+
+		lock_guard<mutex> lock(jobsMutex);
+		for (auto& j : jobs)
+		{
+			if (j.id != jobID) continue;
+
+			j.waiting = false;
+			j.finished = true;
+			j.exitCode = exitCode;
+		}
+
+		outExitCode = exitCode;
+
+		return{};
+	}
+
+	vector<ProcessJob> ProcessLauncher::GetJobs()
+	{
+		lock_guard<mutex> lock(jobsMutex);
+
+		for (auto& j : jobs)
+		{
+			//jobs with a blocked WaitJob are reaped by that call instead
+			if (j.finished
+				|| j.waiting)
+			{
+				continue;
+			}
+
+#ifdef _WIN32
+			ProcessHandle process = ToVar<HANDLE>(j.handle);
+#else
+			ProcessHandle process = scast<pid_t>(j.handle);
+#endif
+			int exitCode{};
+			if (TryReapProcess(process, exitCode))
+			{
+				j.finished = true;
+				j.exitCode = exitCode;
+			}
+		}
+
+		return jobs;
+	}
+}